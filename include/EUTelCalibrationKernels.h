@@ -0,0 +1,221 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELCALIBRATIONKERNELS_H
+#define EUTELCALIBRATIONKERNELS_H
+
+// system includes <>
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Pixel loops shared by the calibration and clustering processors
+  /*! The kernels work on the contiguous per sensor arrays of raw
+   *  signals, pedestal, noise and status, as stored in the LCIO
+   *  vectors. The loop bodies have no data dependent branches, the
+   *  hit rejection is turned into a 0/1 selection, so the compiler
+   *  can vectorise them for whatever instruction set the build
+   *  targets.
+   *
+   *  Sums are kept in kLanes independent single precision partial
+   *  sums, which are only added at the end. Without this, the
+   *  compiler is not allowed to reorder a floating point reduction
+   *  and the loop stays scalar. The signals summed for the common
+   *  mode are of the order of the noise, so the single precision
+   *  lanes do not limit the accuracy.
+   *
+   *  All loops run over blocks of kLanes pixels with a scalar tail,
+   *  and the kernels writing arrays take __restrict pointers. At -O2, the
+   *  optimisation level of the default build, GCC only vectorises a
+   *  loop that needs neither a run time alias check nor a scalar
+   *  epilogue, which the fixed length inner loops satisfy. Callers
+   *  must not pass overlapping arrays.
+   */
+  namespace CalibrationKernels {
+
+    //! Number of partial sums in the reductions
+    static const size_t kLanes = 8;
+
+    //! Number of pixels flagged at once in the seed search
+    static const size_t kSeedBlock = 256;
+
+    //! Masked sum of the pedestal subtracted signals for the common mode
+    /*! A pixel is a hit candidate when its pedestal subtracted signal
+     *  is above hitRejectionCut times its noise. Pixels which are no
+     *  hit candidate and have status goodStatus enter the sum.
+     *
+     *  @param adc The raw signals.
+     *  @param pedestal The pedestal of each pixel.
+     *  @param noise The noise of each pixel.
+     *  @param status The status of each pixel.
+     *  @param n The number of pixels.
+     *  @param hitRejectionCut The hit rejection cut in units of noise.
+     *  @param goodStatus The status of pixels used in the sum.
+     *  @param goodPixel Returns the number of pixels in the sum.
+     *  @param skippedPixel Returns the number of hit candidates.
+     *
+     *  @return The sum of the selected pixel signals.
+     */
+    inline double commonModeSum( const short * adc, const float * pedestal, const float * noise,
+                                 const short * status, size_t n, float hitRejectionCut, short goodStatus,
+                                 int & goodPixel, int & skippedPixel ) {
+
+      float sum[kLanes];
+      for ( size_t iLane = 0; iLane < kLanes; ++iLane ) sum[iLane] = 0.f;
+      int good = 0;
+      int hit  = 0;
+
+      const size_t nBlock = n - n % kLanes;
+      for ( size_t iPixel = 0; iPixel < nBlock; iPixel += kLanes ) {
+        float signal[kLanes];
+        int   isHit[kLanes];
+        int   isUsed[kLanes];
+        for ( size_t iLane = 0; iLane < kLanes; ++iLane ) {
+          signal[iLane] = adc[iPixel + iLane] - pedestal[iPixel + iLane];
+          isHit[iLane]  = signal[iLane] > hitRejectionCut * noise[iPixel + iLane];
+          isUsed[iLane] = ( status[iPixel + iLane] == goodStatus ) & ( isHit[iLane] ^ 1 );
+        }
+        for ( size_t iLane = 0; iLane < kLanes; ++iLane ) {
+          sum[iLane] += isUsed[iLane] ? signal[iLane] : 0.f;
+          good       += isUsed[iLane];
+          hit        += isHit[iLane];
+        }
+      }
+
+      double total = 0.;
+      for ( size_t iLane = 0; iLane < kLanes; ++iLane ) total += sum[iLane];
+      for ( size_t iPixel = nBlock; iPixel < n; ++iPixel ) {
+        const float signal = adc[iPixel] - pedestal[iPixel];
+        const int   isHit  = signal > hitRejectionCut * noise[iPixel];
+        const int   isUsed = ( status[iPixel] == goodStatus ) & ( isHit ^ 1 );
+        total += isUsed ? signal : 0.f;
+        good  += isUsed;
+        hit   += isHit;
+      }
+
+      goodPixel    = good;
+      skippedPixel = hit;
+      return total;
+    }
+
+    //! Pedestal and common mode subtraction with a single correction
+    /*! @param adc The raw signals.
+     *  @param pedestal The pedestal of each pixel.
+     *  @param commonMode The correction subtracted from all pixels.
+     *  @param n The number of pixels.
+     *  @param corrected Returns the corrected signals, n entries.
+     */
+    inline void subtractPedestal( const short * __restrict adc, const float * __restrict pedestal, float commonMode,
+                                  size_t n, float * __restrict corrected ) {
+      const size_t nBlock = n - n % kLanes;
+      for ( size_t iPixel = 0; iPixel < nBlock; iPixel += kLanes ) {
+        for ( size_t iLane = 0; iLane < kLanes; ++iLane ) {
+          corrected[iPixel + iLane] = adc[iPixel + iLane] - pedestal[iPixel + iLane] - commonMode;
+        }
+      }
+      for ( size_t iPixel = nBlock; iPixel < n; ++iPixel ) {
+        corrected[iPixel] = adc[iPixel] - pedestal[iPixel] - commonMode;
+      }
+    }
+
+    //! Pedestal and common mode subtraction with a correction per pixel
+    /*! @param adc The raw signals.
+     *  @param pedestal The pedestal of each pixel.
+     *  @param commonMode The correction of each pixel.
+     *  @param n The number of pixels.
+     *  @param corrected Returns the corrected signals, n entries.
+     */
+    inline void subtractPedestal( const short * __restrict adc, const float * __restrict pedestal,
+                                  const float * __restrict commonMode, size_t n, float * __restrict corrected ) {
+      const size_t nBlock = n - n % kLanes;
+      for ( size_t iPixel = 0; iPixel < nBlock; iPixel += kLanes ) {
+        for ( size_t iLane = 0; iLane < kLanes; ++iLane ) {
+          corrected[iPixel + iLane] = adc[iPixel + iLane] - pedestal[iPixel + iLane] - commonMode[iPixel + iLane];
+        }
+      }
+      for ( size_t iPixel = nBlock; iPixel < n; ++iPixel ) {
+        corrected[iPixel] = adc[iPixel] - pedestal[iPixel] - commonMode[iPixel];
+      }
+    }
+
+    //! Counts the good pixels above a noise normalised threshold
+    /*! counter[i] is incremented for each pixel with status goodStatus
+     *  whose pedestal subtracted signal is above nSigma times its noise.
+     *  Counter is the integer type of the caller's counter array.
+     *
+     *  @return The number of pixels above threshold.
+     */
+    template < typename Counter >
+    inline int countAboveThreshold( const short * __restrict adc, const float * __restrict pedestal,
+                                    const float * __restrict noise, const short * __restrict status, size_t n,
+                                    float nSigma, short goodStatus, Counter * __restrict counter ) {
+      int noOfFiring = 0;
+      const size_t nBlock = n - n % kLanes;
+      for ( size_t iPixel = 0; iPixel < nBlock; iPixel += kLanes ) {
+        for ( size_t iLane = 0; iLane < kLanes; ++iLane ) {
+          const float signal   = adc[iPixel + iLane] - pedestal[iPixel + iLane];
+          const int   isFiring = ( status[iPixel + iLane] == goodStatus ) & ( signal > nSigma * noise[iPixel + iLane] );
+          counter[iPixel + iLane] += static_cast< Counter >( isFiring );
+          noOfFiring              += isFiring;
+        }
+      }
+      for ( size_t iPixel = nBlock; iPixel < n; ++iPixel ) {
+        const float signal   = adc[iPixel] - pedestal[iPixel];
+        const int   isFiring = ( status[iPixel] == goodStatus ) & ( signal > nSigma * noise[iPixel] );
+        counter[iPixel] += static_cast< Counter >( isFiring );
+        noOfFiring      += isFiring;
+      }
+      return noOfFiring;
+    }
+
+    //! Indices of the seed candidates of a calibrated frame
+    /*! A pixel is a seed candidate when it has status goodStatus and
+     *  its signal is above seedCut times its noise. The frame is
+     *  flagged in blocks of kSeedBlock pixels, only blocks with at
+     *  least one candidate are scanned again for the indices. Seeds
+     *  are rare, so nearly all of the work is in the flagging.
+     *
+     *  @param signal The calibrated signal of each pixel.
+     *  @param noise The noise of each pixel.
+     *  @param status The status of each pixel.
+     *  @param n The number of pixels.
+     *  @param seedCut The seed cut in units of noise.
+     *  @param goodStatus The status of pixels which can be seeds.
+     *  @param candidates Returns the candidate indices in increasing order.
+     */
+    inline void findSeedCandidates( const float * signal, const float * noise, const short * status, size_t n,
+                                    float seedCut, short goodStatus, std::vector< unsigned int > & candidates ) {
+      candidates.clear();
+      unsigned char isSeed[kSeedBlock];
+      const size_t nBlock = n - n % kSeedBlock;
+      for ( size_t blockBegin = 0; blockBegin < nBlock; blockBegin += kSeedBlock ) {
+        const float * blockSignal = signal + blockBegin;
+        const float * blockNoise  = noise  + blockBegin;
+        const short * blockStatus = status + blockBegin;
+        unsigned char anySeed = 0;
+        for ( size_t iPixel = 0; iPixel < kSeedBlock; ++iPixel ) {
+          isSeed[iPixel] = ( blockStatus[iPixel] == goodStatus ) & ( blockSignal[iPixel] > seedCut * blockNoise[iPixel] );
+          anySeed       |= isSeed[iPixel];
+        }
+        if ( anySeed == 0 ) continue;
+        for ( size_t iPixel = 0; iPixel < kSeedBlock; ++iPixel ) {
+          if ( isSeed[iPixel] ) candidates.push_back( static_cast< unsigned int >( blockBegin + iPixel ) );
+        }
+      }
+      for ( size_t iPixel = nBlock; iPixel < n; ++iPixel ) {
+        if ( ( status[iPixel] == goodStatus ) && ( signal[iPixel] > seedCut * noise[iPixel] ) ) {
+          candidates.push_back( static_cast< unsigned int >( iPixel ) );
+        }
+      }
+    }
+
+  }
+}
+#endif
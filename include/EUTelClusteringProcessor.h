@@ -441,16 +441,16 @@ namespace eutelescope {
      *  template element is the (float) pixel charge and the second is
      *  the pixel index.
      *
-     *  \li This is the sorted using the std::algorithm library by the first element of the pair
-     *  i.e. the pixel signal. In this way, at the end of
-     *  the matrix crossing, the last element of the map is the pixel
-     *  seed candidate with the highest signal. The seed candidate map has to be compulsory sorted,
-     *  because the cluster building procedure has to start from a
-     *  seed pixel.
-     *
-     *  \li Starting from the last entry of the seed candidate map
-     *  (i.e. the pixel with the highest signal in the matrix), a
-     *  candidate cluster is built around this seed. The clustering is
+     *  \li The seed candidate map is then arranged as a heap on the
+     *  first element of the pair, i.e. the pixel signal. The
+     *  candidates have to be taken in order of decreasing signal,
+     *  because the cluster building procedure has to start from the
+     *  highest seed pixel, but a heap gives this order without
+     *  sorting the full map.
+     *
+     *  \li Starting from the top of the heap (i.e. the pixel with the
+     *  highest signal in the matrix), a candidate cluster is built
+     *  around this seed. The clustering is
      *  done with two nested loops in way that the seed pixel is the
      *  center of the resulting cluster. Only pixels with a good
      *  status, effectively belonging to the matrix (1) and not yet
@@ -747,6 +747,12 @@ namespace eutelescope {
      */
     std::vector< std::pair<float,unsigned int> > _seedCandidateMap;
 
+    //! The pixel indices of the seed candidates
+    /*! Filled by the seed search of the NZS clustering algorithms,
+     *  kept as data member to reuse its memory from event to event.
+     */
+    std::vector< unsigned int > _seedCandidateIndexVec;
+
     //! Total cluster found
     /*! This is a map correlating the sensorID number and the
      *  total number of clusters found on that sensor.
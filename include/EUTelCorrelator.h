@@ -11,6 +11,7 @@
 #if defined(USE_GEAR)
 
 // eutelescope includes ".h"
+#include "EUTelHistogramBuffer.h"
 
 //ROOT includes
 #include "TVector3.h"
@@ -137,6 +138,11 @@ namespace eutelescope {
      */
     void bookHistos();
 
+#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+    //! Move the buffered correlation entries into the histograms
+    void flushHistogramBuffers();
+#endif
+
     //! internal functtion: return the ID of a plane selected as a reference plane for correlation plots
 
     virtual int getFixedPlaneID(){return _fixedPlaneID;} 
@@ -184,6 +190,22 @@ namespace eutelescope {
      */
     int _events;
 
+    //! Fill the correlation histograms through buffers
+    /*! If false (default) the correlation histograms are filled
+     *  directly. If true they are filled through dense buffers, which
+     *  are copied into the AIDA histograms every
+     *  _histogramFlushInterval events and in end(). The saved
+     *  histograms then have the same bin heights as with direct
+     *  fills, but their entries count the filled bins of each flush
+     *  and their mean and RMS come from the bin centers.
+     */
+    bool _useHistogramBuffers;
+
+    //! Number of events between two flushes of the histogram buffers
+    /*! Only used with _useHistogramBuffers, 0 flushes only in end().
+     */
+    int _histogramFlushInterval;
+
     //! Cluster collection list (EVENT::StringVec) 
     /*!
      */
@@ -370,6 +392,20 @@ namespace eutelescope {
     std::map< unsigned int , AIDA::IHistogram1D*  > _hitXCorrShiftProjection;
     std::map< unsigned int , AIDA::IHistogram1D*  > _hitYCorrShiftProjection;
 
+    //! Fill buffers of the correlation histograms
+    /*! Same keys as the matrices above, processEvent() only fills
+     *  these. Without _useHistogramBuffers they pass the fills on to
+     *  the histograms, otherwise they are flushed into the histograms
+     *  every _histogramFlushInterval events and in end().
+     */
+    typedef std::map< unsigned int , std::map< unsigned int , EUTelHistogramBuffer2D< AIDA::IHistogram2D > > > HistogramBufferMatrix;
+    HistogramBufferMatrix _clusterXCorrelationBuffer;
+    HistogramBufferMatrix _clusterYCorrelationBuffer;
+    HistogramBufferMatrix _hitXCorrelationBuffer;
+    HistogramBufferMatrix _hitYCorrelationBuffer;
+    HistogramBufferMatrix _hitXCorrShiftBuffer;
+    HistogramBufferMatrix _hitYCorrShiftBuffer;
+
 
     //! Base name of the correlation histogram
     static std::string _clusterXCorrelationHistoName;
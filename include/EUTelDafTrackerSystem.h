@@ -9,7 +9,6 @@
 
 #include <marlin/AIDAProcessor.h>
 #include "marlin/Processor.h"
-#include <list>
 #include <vector>
 #include <cmath>
 #include <iostream>
@@ -155,7 +154,7 @@ namespace daffitter{
   public:
   PlaneHit(float x, float y, int plane, int index): plane(plane), index(index){ xy(0) = x; xy(1) = y; }
   PlaneHit(Eigen::Vector2f xy, int plane, int index) : xy(xy), plane(plane), index(index) {}
-    const Eigen::Vector2f& getM() { return(xy); }
+    const Eigen::Vector2f& getM() const { return(xy); }
     int getPlane() const {return(plane); }
     int getIndex() const{return(index); };
     void print() {
@@ -165,7 +164,7 @@ namespace daffitter{
 
   class EigenFitter{
     //Eigen recommends fixed size matrixes up to 4x4
-    Eigen::Matrix4f transM, transMtranspose, tmp4x4, tmp4x4_2, tmp4x4_3;
+    Eigen::Matrix4f tmp4x4;
     Eigen::Matrix2f tmp2x2, tmp2x2_2;
     Eigen::Matrix<float, 4, 2> tmp4x2, kalmanGain;
     Eigen::Matrix<float, 2, 4> tmp2x4, H;
@@ -208,7 +207,8 @@ namespace daffitter{
     void getChi2Daf(daffitter::TrackCandidate *candidate);
     void getChi2Kf(daffitter::TrackCandidate *candidate);
 
-    int addNeighbors(std::vector<PlaneHit> &candidate, std::list<PlaneHit> &hits);
+    //Index of the cluster finder grid cell containing pos
+    static int getClusterCell(float pos, float cellSize);
 
     float runTweight(float t);
     float fitPlanesInfoDafInner();
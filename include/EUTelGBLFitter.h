@@ -61,7 +61,7 @@ namespace eutelescope {
 			//SET
 			void setMomentsAndStartEndScattering(EUTelState& state);
 			void setInformationForGBLPointList(EUTelTrack& track, std::vector< gbl::GblPoint >& pointList);
-			void setMeasurementGBL(gbl::GblPoint& point, const double *hitPos, double statePos[3], double combinedCov[4], TMatrixD projection);
+			void setMeasurementGBL(gbl::GblPoint& point, const double *hitPos, double statePos[3], double combinedCov[4], const Eigen::Matrix2d& projection);
 			void getKinkInformationToTrack(gbl::GblTrajectory* traj, std::vector< gbl::GblPoint >& pointList,EUTelTrack &track);
             TMatrixD getFullJacobian(TVector3 momStart, TVector3 momEnd, int locationStart, int locationEnd, double distance, double min );
 			void setPointVec( std::vector< gbl::GblPoint >& pointList, gbl::GblPoint& point);
@@ -8,6 +8,8 @@
 // C++
 #include <map>
 #include <string>
+#include <vector>
+#include <pthread.h>
 
 // MARLIN
 #include "marlin/Global.h"
@@ -43,6 +45,9 @@
 // built only if GEAR is available
 #ifdef USE_GEAR
 
+/** Plane ID of the scattering planes between the sensors, which have no rotation of their own */
+#define  SCATTER_IDENTIFIER 314
+
 /** @class EUTelGeometryTelescopeGeoDescription
  * This class is supposed to keep globally accesible 
  * telescope geometry description.
@@ -169,6 +174,48 @@ class EUTelGeometryTelescopeGeoDescription
 	/** Map containing plane path (string) and corresponding planeID */
 	std::map<int, std::string> _planePath;
 
+	/** Cached local-to-global transformations, 12 doubles per plane (row-major rotation, translation) */
+	std::vector<double> _planeTransforms;
+
+	/** Position of a plane's transformation in _planeTransforms indexed by sensorID, -1 if not cached */
+	std::vector<int> _planeTransformSlot;
+
+	/** Compute plane intersections analytically instead of stepping through TGeo */
+	bool _useAnalyticNavigation;
+
+	/** Radiation length split of one material budget grid point */
+	struct MaterialBudgetNode
+	{
+		MaterialBudgetNode(): total(0), sensor(), air() {}
+		float total;
+		std::map<const int, double> sensor;
+		std::map<const int, double> air;
+	};
+
+	/** Material budget grid point: (planeID, (ix, iy)) */
+	typedef std::pair<int, std::pair<int, int> > MaterialBudgetKey;
+
+	/** Interpolate the material budget from a grid instead of tracing every track */
+	bool _useMaterialBudgetCache;
+
+	/** Grid spacing of the material budget cache [mm] */
+	double _materialBudgetBinSize;
+
+	/** Material budget grid points traced so far */
+	std::map<MaterialBudgetKey, MaterialBudgetNode> _materialBudgetCache;
+
+	/** Implementation of getRadiationLengthsToEnd, called with _tgeoMutex held */
+	float getRadiationLengthsToEndLocked( int planeID, const double start[3], const double end[3], std::map<const int,double>& mapSensor, std::map<const int,double>& mapAir );
+
+	/** Exact material budget at a grid point, traced on first request */
+	const MaterialBudgetNode& getMaterialBudgetNode( int planeID, int ix, int iy );
+
+	/** Serialises access to the TGeo navigator, which keeps global state */
+	pthread_mutex_t _tgeoMutex;
+
+	/** Compare the plane IDs of two material budget entries */
+	static bool sameMaterialBudgetKey( const std::pair<const int, double>& a, const std::pair<const int, double>& b ) { return a.first == b.first; };
+
 	/** */
 	static unsigned _counter;
 
@@ -182,7 +229,7 @@ class EUTelGeometryTelescopeGeoDescription
 	/** */
 	void updateGearManager();  
 
-	/** */
+	/** Counts the initialisations, only called by the first getInstance() */
 	unsigned counter() { return _counter++; }
 
 	void setInitialDisplacementToFirstPlane(float initialDisplacement){_initialDisplacement = initialDisplacement; };
@@ -378,6 +425,24 @@ class EUTelGeometryTelescopeGeoDescription
 
 	void master2LocalVec( int, const double[], double[] );
 
+	/** Transform nPoints consecutive (x,y,z) triplets from the local frame of one sensor to the global frame */
+	void local2MasterBatch( int sensorID, const double* localPos, double* globalPos, size_t nPoints );
+
+	/** Transform nPoints consecutive (x,y,z) triplets from the global frame to the local frame of one sensor */
+	void master2LocalBatch( int sensorID, const double* globalPos, double* localPos, size_t nPoints );
+
+	/** Cached 3x4 local-to-global transformation of a sensor: row-major rotation followed by translation */
+	const double* getPlaneTransform( int sensorID );
+
+	/** Drop the cached plane transformations, e.g. after the plane positions changed */
+	void invalidatePlaneTransforms();
+
+	/** Read the transformations of all planes into the cache.
+	 * Afterwards the coordinate transformations and the analytic navigation
+	 * only read from the cache and can be used from several threads.
+	 */
+	void cacheAllPlaneTransforms();
+
 	bool findIntersectionWithCertainID(	float x0, float y0, float z0, 
 						float px, float py, float pz, 
 						float beamQ, int nextPlaneID, float outputPosition[],
@@ -391,6 +456,17 @@ class EUTelGeometryTelescopeGeoDescription
 	void mapWeightsToSensor(std::map<const int,double> sensor,std::map<const int,double> air,  std::map< const  int, double > & mapSen,std::map< const  int, double > & mapAir  );
 	double addKapton(std::map<const int, double> & mapSensor);
 
+	/** Radiation length from a point on a plane to the end of the telescope, from the material budget cache if switched on.
+	 * Calls from several threads are serialised since the tracing goes through TGeo.
+	 */
+	float getRadiationLengthsToEnd( int planeID, const double start[3], const double end[3], std::map<const int,double>& mapSensor, std::map<const int,double>& mapAir );
+
+	/** Switch the material budget cache on or off and set its grid spacing [mm] */
+	void setMaterialBudgetCache( bool useCache, double binSize );
+
+	/** Drop all cached material budget grid points */
+	void clearMaterialBudgetCache();
+
 
 	float getInitialDisplacementToFirstPlane() const { return _initialDisplacement; };
 
@@ -415,10 +491,30 @@ class EUTelGeometryTelescopeGeoDescription
 	/** Geometry manager global object */
 	TGeoManager* _geoManager;
 
+	/** Entrance point of a straight line into the given sensor.
+	 * For geometries built from GEAR this is solved in closed form
+	 * against the sensor box, otherwise TGeo is stepped.
+	 */
 	bool findNextPlaneEntrance(  TVector3 ,  TVector3, int, float*  );
 
+	/** Next sensor hit by a straight line and its entrance point.
+	 * For geometries built from GEAR this is solved in closed form
+	 * against the sensor boxes, otherwise TGeo is stepped.
+	 */
 	int findNextPlane(  double* lpoint,  double* ldir,  float* newpoint );
 
+	/** Line parameters where a straight line enters and leaves the box of a sensor, false if it misses */
+	bool intersectPlaneBox( int sensorID, const double globalPos[], const double globalDir[], double& tEnter, double& tExit );
+
+	/** Check if a global point is inside the box of a sensor */
+	bool isPointInsidePlane( int sensorID, const double globalPos[] );
+
+	/** Switch between closed form plane intersections and TGeo stepping */
+	void setAnalyticNavigation( bool value ) { _useAnalyticNavigation = value; };
+
+	/** Closed form plane intersections are used */
+	bool useAnalyticNavigation() const { return _useAnalyticNavigation; };
+
 private:
 	/** reading initial info from gear: part of contructor */
 	void readSiPlanesLayout();
@@ -438,6 +534,12 @@ private:
 	void readGear();
 
 	void translateSiPlane2TGeo(TGeoVolume*,int );
+
+	/** TGeo stepping implementation of findNextPlaneEntrance */
+	bool findNextPlaneEntranceTGeo(  TVector3 ,  TVector3, int, float*  );
+
+	/** TGeo stepping implementation of findNextPlane */
+	int findNextPlaneTGeo(  double* lpoint,  double* ldir,  float* newpoint );
 };
         
 inline EUTelGeometryTelescopeGeoDescription& gGeometry( gear::GearMgr* _g = marlin::Global::GEAR )
@@ -0,0 +1,153 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELHISTOGRAMBUFFER_H
+#define EUTELHISTOGRAMBUFFER_H
+
+// system includes <>
+#include <cstddef>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Dense bin counter in front of a booked 2D histogram
+  /*! Every fill of an AIDA histogram is a virtual call, which for
+   *  correlation plots with all pairs of clusters of two planes is
+   *  the main cost of the processor. The buffer has the binning of
+   *  the booked histogram, including under- and overflow, and fill()
+   *  only increments a counter in a plain array.
+   *
+   *  flush() moves the counts into the histogram, one weighted fill
+   *  per non empty bin at the bin center, and clears the buffer. It
+   *  has to be called before the histogram is read, at the latest in
+   *  end(). After a flush only the bin heights (and so the sum of
+   *  weights) are the same as with direct fills. The histogram counts
+   *  every weighted fill as one entry: its bin entries and entries()
+   *  count the non empty bins of each flush, not the fills, and the
+   *  mean and RMS are computed from the bin centers. Readers of a
+   *  buffered histogram have to use the bin heights, the number of
+   *  fills is getNumberOfEntries() before the flush.
+   *
+   *  A buffer bound with buffered = false passes every fill on to the
+   *  histogram, which then is exactly the same as without the buffer.
+   *
+   *  Histo has to provide xAxis() and yAxis() with bins(),
+   *  lowerEdge() and upperEdge(), and fill(x, y) and fill(x, y,
+   *  weight), as AIDA::IHistogram2D does.
+   */
+  template < class Histo >
+  class EUTelHistogramBuffer2D {
+
+  public:
+    EUTelHistogramBuffer2D() :
+      _histo(NULL), _buffered(true), _nBinsX(0), _nBinsY(0), _xMin(0.), _yMin(0.),
+      _xBinWidth(1.), _yBinWidth(1.), _nEntries(0), _counts() {}
+
+    //! Take the binning of histo and buffer the fills for it
+    explicit EUTelHistogramBuffer2D( Histo * histo, bool buffered = true ) :
+      _histo(NULL), _buffered(true), _nBinsX(0), _nBinsY(0), _xMin(0.), _yMin(0.),
+      _xBinWidth(1.), _yBinWidth(1.), _nEntries(0), _counts() {
+      bind( histo, buffered );
+    }
+
+    //! Take the binning of histo and buffer the fills for it
+    /*! A NULL histogram gives a buffer which ignores all fills. If
+     *  buffered is false, fill() fills the histogram directly.
+     */
+    void bind( Histo * histo, bool buffered = true ) {
+      _histo    = histo;
+      _buffered = buffered;
+      _nEntries = 0;
+      if ( histo == NULL || !buffered ) {
+        _nBinsX = _nBinsY = 0;
+        _counts.clear();
+        return;
+      }
+      _nBinsX    = histo->xAxis().bins();
+      _nBinsY    = histo->yAxis().bins();
+      _xMin      = histo->xAxis().lowerEdge();
+      _yMin      = histo->yAxis().lowerEdge();
+      _xBinWidth = ( histo->xAxis().upperEdge() - _xMin ) / _nBinsX;
+      _yBinWidth = ( histo->yAxis().upperEdge() - _yMin ) / _nBinsY;
+      _counts.assign( static_cast< size_t >( _nBinsX + 2 ) * ( _nBinsY + 2 ), 0 );
+    }
+
+    //! Count an entry at (x, y)
+    void fill( double x, double y ) {
+      if ( _histo == NULL ) return;
+      if ( !_buffered ) {
+        _histo->fill( x, y );
+        return;
+      }
+      ++_counts[ static_cast< size_t >( binIndex( x, _xMin, _xBinWidth, _nBinsX ) ) * ( _nBinsY + 2 )
+                 + binIndex( y, _yMin, _yBinWidth, _nBinsY ) ];
+      ++_nEntries;
+    }
+
+    //! Add the counts of a buffer with the same binning, e.g. of another thread
+    void merge( const EUTelHistogramBuffer2D & other ) {
+      if ( other._counts.size() != _counts.size() ) return;
+      for ( size_t iBin = 0; iBin < _counts.size(); ++iBin ) _counts[iBin] += other._counts[iBin];
+      _nEntries += other._nEntries;
+    }
+
+    //! Move the counts into the histogram and clear the buffer
+    void flush() {
+      if ( _histo == NULL || _nEntries == 0 ) return;
+      for ( int ix = 0; ix < _nBinsX + 2; ++ix ) {
+        const double x = _xMin + ( ix - 0.5 ) * _xBinWidth;
+        for ( int iy = 0; iy < _nBinsY + 2; ++iy ) {
+          unsigned int & count = _counts[ static_cast< size_t >( ix ) * ( _nBinsY + 2 ) + iy ];
+          if ( count == 0 ) continue;
+          _histo->fill( x, _yMin + ( iy - 0.5 ) * _yBinWidth, static_cast< double >( count ) );
+          count = 0;
+        }
+      }
+      _nEntries = 0;
+    }
+
+    //! The histogram the buffer is flushed into
+    Histo * getHistogram() const { return _histo; }
+
+    //! Number of fills since the last flush
+    unsigned long getNumberOfEntries() const { return _nEntries; }
+
+  private:
+    //! Index in the buffer, 0 is the underflow and nBins+1 the overflow bin
+    static int binIndex( double value, double min, double binWidth, int nBins ) {
+      const double position = ( value - min ) / binWidth;
+      if ( !( position >= 0. ) ) return 0;
+      if ( position >= nBins ) return nBins + 1;
+      return static_cast< int >( position ) + 1;
+    }
+
+    Histo * _histo;
+
+    //! false if the fills go directly into _histo
+    bool _buffered;
+
+    int _nBinsX;
+
+    int _nBinsY;
+
+    double _xMin;
+
+    double _yMin;
+
+    double _xBinWidth;
+
+    double _yBinWidth;
+
+    unsigned long _nEntries;
+
+    //! Counts of the (nBinsX + 2) x (nBinsY + 2) bins, row major in x
+    std::vector< unsigned int > _counts;
+  };
+
+}
+#endif
@@ -0,0 +1,89 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELHISTOGRAMTABLE_H
+#define EUTELHISTOGRAMTABLE_H
+
+// system includes <>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Dense table of typed histogram pointers
+  /*! The processors keep their histograms in maps keyed by name, like
+   *  the _aidaHistoMap of the AIDA based processors or the
+   *  _rootObjectMap of the Alibava ones. Looking a histogram up there
+   *  for every entry means building the key string, a map search and
+   *  a dynamic_cast.
+   *
+   *  A table is filled once, when the histograms are booked, and then
+   *  gives the histogram of a row (usually a sensor or chip index)
+   *  and a column (usually a channel or a variable) by plain
+   *  indexing. The maps stay the owners of the histograms, the table
+   *  only keeps pointers.
+   *
+   *  @code
+   *  _residualHistos.reset( _nPlanes, 3 );
+   *  _residualHistos.setFromMap( iPlane, 0, _aidaHistoMap, name );
+   *  ...
+   *  if ( AIDA::IHistogram1D * histo = _residualHistos.get( iPlane, 0 ) ) histo->fill( residual );
+   *  @endcode
+   */
+  template < class Histo >
+  class EUTelHistogramTable {
+
+  public:
+    EUTelHistogramTable() : _nRows(0), _nColumns(0), _histos() {}
+
+    //! Remove all entries and make room for nRows x nColumns missing histograms
+    void reset( size_t nRows, size_t nColumns = 1 ) {
+      _nRows    = nRows;
+      _nColumns = nColumns;
+      _histos.assign( nRows * nColumns, static_cast< Histo * >( NULL ) );
+    }
+
+    //! Store the histogram of a cell, NULL marks a missing histogram
+    void set( size_t row, size_t column, Histo * histo ) {
+      _histos.at( row * _nColumns + column ) = histo;
+    }
+
+    //! Store the histogram booked as name in a map of base class pointers
+    /*! @return false if there is no histogram of type Histo with this
+     *  name, the cell is NULL in this case.
+     */
+    template < class Map >
+    bool setFromMap( size_t row, size_t column, const Map & histoMap, const std::string & name ) {
+      typename Map::const_iterator iter = histoMap.find( name );
+      Histo * histo = ( iter == histoMap.end() ) ? NULL : dynamic_cast< Histo * >( iter->second );
+      set( row, column, histo );
+      return histo != NULL;
+    }
+
+    //! The histogram of a cell, NULL if it is missing or outside the table
+    Histo * get( size_t row, size_t column = 0 ) const {
+      if ( row >= _nRows || column >= _nColumns ) return NULL;
+      return _histos[ row * _nColumns + column ];
+    }
+
+    size_t getNumberOfRows() const { return _nRows; }
+
+    size_t getNumberOfColumns() const { return _nColumns; }
+
+  private:
+    size_t _nRows;
+
+    size_t _nColumns;
+
+    //! Row major histogram pointers
+    std::vector< Histo * > _histos;
+  };
+
+}
+#endif
@@ -0,0 +1,92 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELHOTPIXELMASK_H
+#define EUTELHOTPIXELMASK_H
+
+// lcio includes <.h>
+#include <EVENT/LCEvent.h>
+#include <IMPL/TrackerHitImpl.h>
+
+// system includes <>
+#include <string>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Hot pixel mask of all sensors, shared by the processors
+  /*! The mask of a sensor is a dense bitset over its pixel index
+   *  range, which is taken from the pixel geometry description and
+   *  widened to include every masked pixel. Sensors are indexed
+   *  directly by their ID, so isMasked() is a constant time lookup.
+   *
+   *  The mask is filled from the hot pixel collection, as written by
+   *  EUTelProcessorHotPixelFinder or EUTelProcessorNoisyPixelFinder,
+   *  once per run and then queried for every pixel or cluster.
+   */
+  class EUTelHotPixelMask {
+
+  public:
+    EUTelHotPixelMask();
+
+    //! Replace the mask by the pixels in the hot pixel collection of the event
+    /*! @return false if the collection is not in the event, the mask is
+     *  empty in this case
+     */
+    bool load( EVENT::LCEvent* event, const std::string& hotPixelCollectionName );
+
+    //! Remove all pixels from the mask
+    void clear();
+
+    //! Add a single pixel to the mask
+    void maskPixel( int sensorID, int x, int y );
+
+    //! True if the pixel (x,y) of the sensor is masked
+    inline bool isMasked( int sensorID, int x, int y ) const {
+      if( sensorID < 0 || static_cast<size_t>( sensorID ) >= _sensorMasks.size() ) return false;
+      const SensorMask& sensorMask = _sensorMasks[sensorID];
+      const int ix = x - sensorMask.minX;
+      const int iy = y - sensorMask.minY;
+      if( ix < 0 || ix >= sensorMask.nX || iy < 0 || iy >= sensorMask.nY ) return false;
+      return sensorMask.bits[ static_cast<size_t>( iy ) * sensorMask.nX + ix ];
+    }
+
+    //! True if any pixel of the cluster behind the hit is masked
+    /*! Only sparse clusters carry their pixels, hits from other
+     *  cluster types are never masked.
+     */
+    bool hitContainsMaskedPixel( const IMPL::TrackerHitImpl* hit ) const;
+
+    //! True if no pixel is masked
+    bool empty() const { return _nMaskedPixels == 0; }
+
+    //! Number of masked pixels over all sensors
+    size_t getNumberOfMaskedPixels() const { return _nMaskedPixels; }
+
+  private:
+    //! Bitset over the pixel index range [minX,minX+nX) x [minY,minY+nY) of one sensor
+    struct SensorMask {
+      SensorMask() : minX(0), minY(0), nX(0), nY(0), bits() {}
+      int minX;
+      int minY;
+      int nX;
+      int nY;
+      std::vector<bool> bits;
+    };
+
+    //! Resize the mask of a sensor to cover the given range, keeping the masked pixels
+    void reserveRange( int sensorID, int minX, int maxX, int minY, int maxY );
+
+    //! Sensor masks indexed by sensor ID
+    std::vector<SensorMask> _sensorMasks;
+
+    size_t _nMaskedPixels;
+  };
+
+}
+#endif
@@ -14,6 +14,8 @@
 #ifdef USE_GEAR
 // eutelescope includes ".h"
 #include "EUTelUtility.h"
+#include "EUTelHotPixelMask.h"
+#include "EUTelHistogramTable.h"
 
 //#include "TrackerHitImpl2.h"
 #include "IMPL/TrackerHitImpl.h"
@@ -224,6 +226,11 @@ namespace eutelescope {
       {
         return (measuredZ < b.measuredZ);
       }
+      //! Order of the hits of a plane for the track search
+      static bool lessMeasuredX(const HitsInPlane& a, const HitsInPlane& b)
+      {
+        return (a.measuredX < b.measuredX);
+      }
       double measuredX;
       double measuredY;
       double measuredZ;
@@ -244,15 +251,19 @@ namespace eutelescope {
 
 
     //recursive method which searches for track candidates - with omits!
+    //the hits of each plane must be sorted with HitsInPlane::lessMeasuredX
     virtual void findtracks2(
                             int missinghits,
                             std::vector<IntVec > &indexarray, //resulting vector of hit indizes
-                            IntVec vec, //for internal use
+                            IntVec &vec, //for internal use, the partial candidate, restored on return
                             std::vector<std::vector<EUTelMille::HitsInPlane> > &_hitsArray, //contains all hits for each plane
                             unsigned int i, //plane number
                             int y //hit index number
                             );
 
+    //true if the hit residuals to the previous plane pass the cuts of plane e
+    bool isInResidualWindow(double residualX, double residualY, int e) const;
+
 
     //recursive method which searches for track candidates
     virtual void findtracks(
@@ -385,16 +396,8 @@ namespace eutelescope {
      */
     std::string _hotPixelCollectionName;
 
-    //! Vector of map arrays, keeps record of hit pixels 
-    /*! The vector elements are sorted by Detector ID
-     *  For each Detector unique ID element a map of pixels is created. 
-     *  first level key   sensor unique 
-     *              value sensor map
-     *  sensor map key    unique row number
-     *             value  vector of column numbers.
-     */
-    
-    std::map<std::string, bool > _hotPixelMap;
+    //! Hot pixels of all sensors, loaded from the first event
+    EUTelHotPixelMask _hotPixelMask;
 
     //! Sensor ID vector
     IntVec _sensorIDVec;
@@ -529,7 +532,16 @@ namespace eutelescope {
     static std::string _residualYvsYLocalname;
     static std::string _residualZvsXLocalname;
     static std::string _residualZvsYLocalname;
- 
+
+    //! Chi2 histograms, columns X and Y
+    EUTelHistogramTable< AIDA::IHistogram1D > _chi2Histos;
+
+    //! Residual histograms, one row per plane and columns X, Y and Z
+    EUTelHistogramTable< AIDA::IHistogram1D > _residualHistos;
+
+    //! Residual profiles, one row per plane and columns XvsX, XvsY, YvsX, YvsY, ZvsX and ZvsY
+    EUTelHistogramTable< AIDA::IProfile1D > _residualProfiles;
+
 #endif
 
     size_t _nPlanes;
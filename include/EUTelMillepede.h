@@ -79,7 +79,21 @@ public:
 	gbl::MilleBinary * _milleGBL;
 	void CreateBinary();
 
+	///////In process alignment
+	//Keep the measurements of a track in memory instead of writing them to the binary. The states must have a hit and their covariance set.
+	void storeTrack(std::vector<EUTelState>& measurementStates);
+	//Iterate the alignment on the stored tracks, at most maxIterations (>= 1) times. Returns true if too many tracks are rejected, as runPede() does.
+	bool solveInProcess(int maxIterations, double chi2NdfCut);
+	//Write the result of solveInProcess() in the format of the pede results file
+	void writeResultsFile();
+	size_t getNumberOfStoredTracks() const { return _storedTrackBegin.size(); }
+
 protected:
+	//The alignment jacobian of computeAlignmentToMeasurementJacobian, in the order of the labels of setGlobalLabels
+	static void alignmentDerivatives(float x, float y, float slopeXvsZ, float slopeYvsZ, double derivatives[2][6]);
+	//True if the parameter of this sensor is in the list of fixed planes
+	static bool isFixed(const std::vector<int>& fixedPlaneIds, int sensorId);
+
 	TMatrixD _jacobian; //Remember you need to create the object before you point ot it
 	std::vector<int> _globalLabels;
 	std::map<int, int> _xShiftsMap;
@@ -118,6 +132,33 @@ protected:
 
         /** Alignment plane ids of planes that are excluded*/
 	std::vector<int> _alignmentPlaneIdsExclude;
+
+	/** Measurement of a stored track for the in process alignment */
+	struct StoredMeasurement {
+		int sensorID;
+		/** Local x and y residuals, hit minus state */
+		float residual[2];
+		float precision[2];
+		/** Derivatives of the residuals to the straight line x0, slope x, y0, slope y */
+		float localDerivatives[2][4];
+		/** State position and slopes in the local frame, to compute the alignment jacobian */
+		float x;
+		float y;
+		float slopeXvsZ;
+		float slopeYvsZ;
+	};
+
+	/** Measurements of all stored tracks, one track after the other */
+	std::vector<StoredMeasurement> _storedMeasurements;
+
+	/** Index of the first measurement of each stored track */
+	std::vector<size_t> _storedTrackBegin;
+
+	/** Alignment corrections found in process, by label-1 */
+	std::vector<double> _inProcessCorrections;
+
+	/** Errors of the corrections, 0 for fixed parameters */
+	std::vector<double> _inProcessErrors;
     };
 }
 #endif	/* EUTelMillepede_H */
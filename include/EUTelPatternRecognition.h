@@ -28,6 +28,7 @@
 #include "EUTelGeometryTelescopeGeoDescription.h"
 #include "EUTelTrack.h"
 #include "EUTelState.h"
+#include "EUTelThreadPool.h"
 
 //LCIO
 #include "lcio.h"
@@ -105,6 +106,9 @@ namespace eutelescope {
 		inline void setBeamCharge(double q) {
 			this->_beamQ = q;
 		}
+
+		/** Propagate the seeds of an event on this many threads, 1 keeps everything on the calling thread */
+		void setNumberOfThreads(int numberOfThreads);
         std::vector<EUTelTrack> getSeedTracks();
         bool seedTrackOuterHits(EUTelTrack track, EUTelTrack & trackOut);
 
@@ -126,7 +130,7 @@ namespace eutelescope {
 		
 		//OTHER
 		void printTrackCandidates();
-		void propagateForwardFromSeedState(EUTelState&, EUTelTrack& );
+		int propagateForwardFromSeedState(EUTelState&, EUTelTrack& );
 		void testPlaneDimensions();
 		void testHitsVecPerPlane();
 		void testPositionEstimation(float position1[], float position2[]);
@@ -194,9 +198,37 @@ double getXYPredictionPrecision(EUTelState& ts ) const;
 		/** Get residual vector */
 		TVectorD computeResidual(  EUTelState &, const EVENT::TrackerHit* ) const;
 		
-		/** Find hit closest to the track */
-		const EVENT::TrackerHit* findClosestHit(EUTelState&);
+		/** Find hit closest to the track within the search window, NULL if there is none */
+		const EVENT::TrackerHit* findClosestHit(EUTelState&, double& distance);
 		std::map<int ,EVENT::TrackerHitVec> _mapHitsVecPerPlane;
+
+		/** Hit of a plane with its local position, sorted along x */
+		struct IndexedHit {
+			double x;
+			double y;
+			/** Position of the hit in _mapHitsVecPerPlane */
+			size_t index;
+			EVENT::TrackerHit* hit;
+			bool operator<(const IndexedHit& other) const { return x < other.x; }
+		};
+
+		/** Per plane hits sorted by local x, built once per event in setHitsVecPerPlane */
+		std::map<int, std::vector<IndexedHit> > _mapHitIndexPerPlane;
+
+		/** Propagation of each seed into its own track slot, see findTrackCandidates */
+		struct SeedPropagationJob : public EUTelThreadPool::Job {
+			SeedPropagationJob(EUTelPatternRecognition& recognition, std::vector<EUTelState*>& seedStates):
+			patternRecognition(recognition), seeds(seedStates), tracks(seedStates.size()), numberOfHitsAdded(seedStates.size(), 0) {}
+			void process(size_t item, int) {
+				numberOfHitsAdded[item] = patternRecognition.propagateForwardFromSeedState(*seeds[item], tracks[item]);
+			}
+			EUTelPatternRecognition& patternRecognition;
+			std::vector<EUTelState*>& seeds;
+			std::vector<EUTelTrack> tracks;
+			std::vector<int> numberOfHitsAdded;
+		private:
+			DISALLOW_COPY_AND_ASSIGN(SeedPropagationJob)
+		};
 	protected:
 		EVENT::TrackerHitVec _allHitsVec;//This is all the hits for a single event. 
 private:       
@@ -226,6 +258,9 @@ private:
 		/** Signed beam charge [e] */
 		double _beamQ;
 
+		/** Worker threads for the seed propagation, NULL if running on a single thread */
+		EUTelThreadPool* _threadPool;
+
 		/** Beam energy spread [%] */
 		double _beamEnergyUncertainty;
 		
@@ -99,6 +99,18 @@ namespace eutelescope {
    *  event. This is done only in the otherLoop because a first
    *  estimation of the noise is required.
    *
+   *  <h4>Single pass calculation</h4>
+   *  Each loop described above re-reads the full input file. With
+   *  SinglePassCalculation switched on, the input is read only
+   *  once: the first StreamingReservoirSize events are kept in
+   *  memory and all the loops are performed on them to obtain a
+   *  first estimation of pedestal, noise and status. All following
+   *  events are common mode corrected and added to running
+   *  (Welford) mean and variance estimators of each pixel, rejecting
+   *  hit candidates against the current estimation. The additional
+   *  masking loop is performed on the events in memory. Only the
+   *  MeanRMS algorithm is available in this mode.
+   *
    *
    *  @since Since version v00-00-09 the geometrical information
    *  (namely the number of detectors and the min and max along X and
@@ -166,6 +178,10 @@ namespace eutelescope {
    *  @param HitRejectionPreLoop Switch to activate / deactivate an
    *  additional loop to better identify hit candidate; to be
    *  performed when calculating pedestal from beam runs.
+   *  @param SinglePassCalculation Switch to calculate everything
+   *  reading the input only once.
+   *  @param StreamingReservoirSize Number of events kept in memory
+   *  when SinglePassCalculation is active.
    *
    *  <h2>Other controls</h2>
    *  @param FirstEvent First event to be used for pedestal calculation
@@ -485,6 +501,92 @@ namespace eutelescope {
     //! Performs a pre loop
     virtual void preLoop( LCEvent * event );
 
+    //! Event processing in the single pass calculation
+    /*! The events are stored into the reservoir until this is full,
+     *  then the reservoir is processed with bootstrapFromReservoir()
+     *  and all further events are streamed into the running
+     *  estimators.
+     *
+     *  @param event The current LCEvent.
+     *
+     *  @throw StopProcessingException when the last event has been
+     *  processed.
+     */
+    void singlePassLoop( LCEvent * event );
+
+    //! All the loops on the events kept in memory
+    /*! The first loop calculates mean and RMS of each pixel, excluding
+     *  its maximum and minimum value if HitRejectionPreLoop is
+     *  active. The other _noOfCMIterations loops are common mode
+     *  corrected. Pixels are masked after each loop, except after the
+     *  last one, whose running estimators are continued by the
+     *  following events.
+     */
+    void bootstrapFromReservoir();
+
+    //! Adds a detector frame to the running estimators
+    /*! The frame is common mode corrected from the second loop on and
+     *  only good pixels compatible with the current pedestal within
+     *  HitRejectionCut times the noise are used.
+     *
+     *  @param iDetector The detector index.
+     *  @param adcValues The raw signals of the detector.
+     *  @param updateEstimates If true, _pedestal and _noise follow
+     *  the running estimators after each entry.
+     *
+     *  @return false if the frame was rejected by the common mode
+     *  calculation.
+     */
+    bool streamFrame( size_t iDetector, const ShortVec & adcValues, bool updateEstimates );
+
+    //! Adds one entry to the running (Welford) mean and squared deviations
+    static inline void addToRunningEstimate( int & entries, double & mean, double & m2, double value ) {
+      ++entries;
+      const double delta = value - mean;
+      mean += delta / entries;
+      m2   += delta * ( value - mean );
+    }
+
+    //! Copies the running estimators into _pedestal and _noise
+    void copyRunningEstimates();
+
+    //! Resets the running estimators to one entry at the current estimates
+    /*! This is the same seed used by otherLoop() for _tempPede,
+     *  _tempNoise and _tempEntries.
+     */
+    void seedRunningEstimates();
+
+    //! Final masking and output of the single pass calculation
+    /*! Also performs the additional masking loop on the events kept
+     *  in memory.
+     */
+    void finalizeSinglePass();
+
+    //! Calculates the common mode correction of a detector frame
+    /*! The correction is calculated against the current pedestal and
+     *  noise estimation, following the selected common mode
+     *  algorithm.
+     *
+     *  @param iDetector The detector index.
+     *  @param adcValues The raw signals of the detector.
+     *  @param commonModeCorVec The correction for each pixel.
+     *  @param skippedPixel The number of hit candidates.
+     *  @param skippedRow The number of rows without common mode.
+     *
+     *  @return false if the frame has to be rejected.
+     */
+    bool calculateCommonMode( size_t iDetector, const ShortVec & adcValues, FloatVec & commonModeCorVec,
+                              int & skippedPixel, int & skippedRow );
+
+    //! Counts the pixels above 3 sigma for the additional masking loop
+    void countFiringPixels( size_t iDetector, const ShortVec & adcValues );
+
+    //! Fills the status map of the current loop
+    void fillStatusMapHistos();
+
+    //! Saves pedestal, noise and status into the output condition file
+    void writeOutputFile();
+
     //! Simple rewind
     virtual void simpleRewind();
 
@@ -787,6 +889,15 @@ namespace eutelescope {
      */
     bool _preLoopSwitch;
 
+    //! Boolean to activate the single pass calculation
+    /*! The input is read only once and all the loops are replaced by
+     *  running estimators. @see singlePassLoop(LCEvent*)
+     */
+    bool _singlePassSwitch;
+
+    //! Number of events kept in memory in the single pass calculation
+    int _reservoirSize;
+
   private:
 
     //! Detector name
@@ -897,6 +1008,23 @@ namespace eutelescope {
     //! Preloop minimum value
     std::vector < ShortVec > _minValue;
 
+    //! Events kept in memory in the single pass calculation
+    /*! For each event, the raw signals of all detectors.
+     */
+    std::vector< std::vector < ShortVec > > _reservoir;
+
+    //! Reservoir events rejected by the common mode in the last loop
+    std::vector< bool > _reservoirSkipped;
+
+    //! Running mean of each pixel
+    std::vector < std::vector< double > > _runningMean;
+
+    //! Running sum of squared deviations of each pixel
+    std::vector < std::vector< double > > _runningM2;
+
+    //! Number of entries of the running estimators
+    std::vector < IntVec > _runningEntries;
+
     //! Event loop counter
     /*! This is a counter for the number of loops. The processor will
      * loop the first time (_iLoop == 0) for pedestal and noise
@@ -92,6 +92,15 @@ namespace eutelescope {
 				double _eBeam;
 
 				bool _createBinary;
+
+				/** Keep the tracks in memory and align in process instead of running pede on the binary. _mEstimatorType and _pedeSteerAddCmds are then not used */
+				bool _inProcessAlignment;
+
+				/** Maximum number of iterations of the in process alignment, at least 1 */
+				int _inProcessIterations;
+
+				/** Tracks above this chi2/ndf are rejected in the in process alignment, 0 keeps all */
+				double _inProcessChi2NdfCut;
         /** Outlier downweighting option */
         std::string _mEstimatorType;
 
@@ -43,6 +43,7 @@
 #include "EUTelEventImpl.h"
 #include "EUTelHistogramManager.h"
 #include "EUTelReaderGenericLCIO.h"
+#include "EUTelThreadPool.h"
 
 namespace eutelescope {
 
@@ -76,6 +77,45 @@ namespace eutelescope {
 
 			virtual void end();
 
+			/** Outcome of the fit of one track candidate. It is filled by a
+			 * worker and merged into histograms and output in track order.
+			 */
+			struct TrackFitResult {
+				TrackFitResult(): track(), chi2(0), ndf(0), ierr(0), sensorResidual(), sensorResidualError(), planes(), error() {}
+				EUTelTrack track;
+				double chi2;
+				int ndf;
+				int ierr;
+				std::map< int, std::map< float, float > > sensorResidual;
+				std::map< int, std::map< float, float > > sensorResidualError;
+				std::map< int, int > planes;
+				/** Message of a std::string exception thrown during the fit */
+				std::string error;
+			};
+
+			/** Fit result.track with the given fitter. Only the fitter and the result are modified. */
+			static void fitTrack(EUTelGBLFitter& fitter, TrackFitResult& result);
+
+			/** Fits the track candidates of an event, each thread with its own fitter */
+			struct TrackFitJob : public EUTelThreadPool::Job {
+				TrackFitJob(std::vector<EUTelGBLFitter*>& trackFitters, std::vector<EUTelTrack>& trackCandidates, std::vector<TrackFitResult>& fitResults):
+				fitters(trackFitters), tracks(trackCandidates), results(fitResults) {}
+				void process(size_t item, int thread) {
+					results[item].track = tracks[item];
+					try{
+						fitTrack(*fitters.at(thread), results[item]);
+					}
+					catch(std::string &e){
+						results[item].error = e;
+					}
+				}
+				std::vector<EUTelGBLFitter*>& fitters;
+				std::vector<EUTelTrack>& tracks;
+				std::vector<TrackFitResult>& results;
+				private:
+				DISALLOW_COPY_AND_ASSIGN(TrackFitJob)
+			};
+
     protected:
 
 			/** Number of events processed */
@@ -117,6 +157,17 @@ namespace eutelescope {
 
 			/** Track fitter */
 			EUTelGBLFitter *_trackFitter;
+
+			/** Number of threads fitting the tracks of an event */
+			int _numberOfThreads;
+
+			/** One fitter per thread, the first one is _trackFitter */
+			std::vector<EUTelGBLFitter*> _trackFitters;
+
+			/** Worker threads, NULL if the tracks are fitted on the calling thread */
+			EUTelThreadPool* _threadPool;
+
+			EUTelGBLFitter* createFitter();
 			//Function defined now for the processor////////////////////////////
 			void outputLCIO(LCEvent* evt, std::vector< EUTelTrack >& tracks);
 
@@ -13,6 +13,7 @@
 // eutelescope includes ".h"
 #include "EUTelExceptions.h"
 #include "EUTELESCOPE.h"
+#include "EUTelGenericPixGeoDescr.h"
 
 // marlin includes ".h"
 #include "marlin/EventModifier.h"
@@ -230,6 +231,50 @@ protected:
      */
     void geometricClustering(LCEvent* evt, LCCollectionVec* pulse);
 
+    //! Pixel geometry lookup table of one sensor
+    /*! For every pixel index in the range of the pixgeo descriptor
+     *  the centre and the half widths of the embedding box in the
+     *  plane local frame are stored contiguously as four floats, so
+     *  the clustering only needs one array lookup per hit pixel.
+     */
+    struct PixelGeometryTable {
+        PixelGeometryTable(): minX(0), minY(0), sizeX(0), sizeY(0), geometry() {}
+
+        //! Position of the pixel (x,y) in the table
+        inline size_t getIndex(int x, int y) const {
+            return static_cast<size_t>(y-minY)*static_cast<size_t>(sizeX) + static_cast<size_t>(x-minX);
+        }
+
+        //! Returns false if the pixel is outside of the tabulated range
+        inline bool getPixelGeometry(int x, int y, float& posX, float& posY, float& boundaryX, float& boundaryY) const {
+            if( x < minX || y < minY || x >= minX+sizeX || y >= minY+sizeY ) return false;
+            const float* entry = &geometry[ 4*getIndex(x, y) ];
+            posX = entry[0];
+            posY = entry[1];
+            boundaryX = entry[2];
+            boundaryY = entry[3];
+            return true;
+        }
+
+        int minX;
+        int minY;
+        int sizeX;
+        int sizeY;
+        //! (posX, posY, boundaryX, boundaryY) for each pixel
+        std::vector<float> geometry;
+    };
+
+    //! Compute the geometry of a single pixel with TGeo
+    /*! Navigates to the pixel volume and transforms its origin into
+     *  the plane local frame. This is slow and only used to fill the
+     *  PixelGeometryTable or for pixels outside of its range.
+     */
+    void computePixelGeometry(const std::string& planePath, geo::EUTelGenericPixGeoDescr* geoDescr, int xCoord, int yCoord,
+                              float& posX, float& posY, float& boundaryX, float& boundaryY) const;
+
+    //! Fill the PixelGeometryTable of a sensor for its full pixel index range
+    void buildPixelGeometryTable(const std::string& planePath, geo::EUTelGenericPixGeoDescr* geoDescr, PixelGeometryTable& table) const;
+
     //! Input collection name for ZS data
     /*! The input collection is the calibrated data one coming from
      *  the EUTelCalibrateEventProcessor. It is, usually, called
@@ -345,7 +390,9 @@ private:
     
     //! pulse Collection 
     LCCollectionVec* _pulseCollectionVec;
-  
+
+    //! Pixel geometry lookup tables, built on first use of each sensor
+    std::map<int, PixelGeometryTable> _pixelGeometryTableMap;
 };
 
 //! A global instance of the processor
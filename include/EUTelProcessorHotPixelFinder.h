@@ -12,6 +12,7 @@
 // eutelescope includes ".h"
 #include "EUTelEventImpl.h"
 #include "EUTelGenericSparsePixel.h"
+#include "EUTelMatrixDecoder.h"
 
 // marlin includes ".h"
 #include "marlin/EventModifier.h"
@@ -30,6 +31,7 @@
 
 // system includes <>
 #include <map>
+#include <vector>
 
 
 namespace eutelescope {
@@ -217,38 +219,16 @@ namespace eutelescope {
     std::map< int, int > _ancillaryIndexMap;
 
  
-    //! Vector of map arrays, keeps record of hit pixels 
-    /*! The vector elements are sorted by Detector ID
-     *  For each Detector unique ID element a map of pixels is created. 
-     *  Key is the sequential (counter) id of a hit,
-     *  Value - (sensor) unique pixel Id.
+    //! Pixel index decoder of each detector
+    /*! The vector elements are sorted as the status collection. The
+     *  decoders span the full [xMin,xMax] x [yMin,yMax] range of the
+     *  sensor, so every pixel has its own slot in the dense firing
+     *  counters.
      */
+    std::vector< EUTelMatrixDecoder > _matrixDecoderVec;
 
-    std::vector< std::map< int, int > > _hitIndexMapVec;
-  
-        
-    //! Vector of map arrays, keeps record of hit pixels 
-    /*! The vector elements are sorted by Detector ID
-     *  For each Detector unique ID element a map of pixels is created (inverse
-     *  mapping to _hitIndexMapVec). 
-     *  Key is a (sensor) unique pixel Id 
-     *  Value - sequential (counter) id of a hit.
-     */
-    
-    std::vector< std::map< int, int > > _inverse_hitIndexMapVec;
-
-    
-    //! Vector of map arrays, keeps record of hit pixels 
-    /*! The vector elements are sorted by Detector ID
-     *  For each Detector unique ID element a map of pixels is created. 
-     *  Key is a (sensor) unique pixel Id (to be addressed via
-     *  _inverse_hitIndexMapVec)
-     *  Value - EUTelGenericSparsePixel pointer.
-     */
-    
-    std::vector< std::map< int, EUTelGenericSparsePixel* > > _pixelMapVec;
-
-
+    //! Number of events accumulated in the firing counters
+    unsigned int _noOfAccumulatedEvents;
 
     //! Current run number.
     /*! This number is used to store the current run number
@@ -307,8 +287,13 @@ namespace eutelescope {
     //! A vector with the number of killed pixel
     std::vector< std::vector< unsigned short > > _killedPixelVec;
 
-    //! A vector with the firing frequency value
-    std::vector< std::vector< unsigned short > > _firingFreqVec;
+    //! A vector with the firing counters of each detector
+    /*! When building the hot pixel database the counters are dense
+     *  over the pixel matrix and indexed by
+     *  EUTelMatrixDecoder::getIndexFromXY, otherwise they follow the
+     *  pixel order of the status collection.
+     */
+    std::vector< std::vector< unsigned int > > _firingFreqVec;
 
     //! Simple data decoding and HotPixel database
     /*
@@ -316,9 +301,10 @@ namespace eutelescope {
     int _flagBuildHotPixelDatabase; 
     
     //! write out the list of hot pixels
-    /*!
+    /*! A pixel is hot if it fired in more than MaxAllowedFiringFreq of
+     *  all accumulated events.
      */
-    void HotPixelDBWriter(LCEvent * event);
+    void HotPixelDBWriter();
 
 
   };
@@ -158,6 +158,15 @@ namespace eutelescope {
 		EVENT::IntVec _excludePlanes;         
 		EVENT::IntVec _planeDimension;
 
+		/** Interpolate radiation lengths from the material budget cache instead of exact tracing */
+		bool _useMaterialBudgetCache;
+
+		/** Grid spacing of the material budget cache [mm] */
+		double _materialBudgetCacheBinSize;
+
+		/** Number of threads propagating the seeds */
+		int _numberOfThreads;
+
 		private:
 		DISALLOW_COPY_AND_ASSIGN(EUTelProcessorPatternRecognition)   // prevent users from making (default) copies of processors
      
@@ -13,6 +13,7 @@
 // eutelescope includes ".h"
 #include "EUTelExceptions.h"
 #include "EUTELESCOPE.h"
+#include "EUTelGenericSparsePixel.h"
 
 // marlin includes ".h"
 #include "marlin/EventModifier.h"
@@ -230,6 +231,20 @@ protected:
      */
     void sparseClustering(LCEvent* evt, LCCollectionVec* pulse);
 
+    //! Group the hit pixels of one plane into clusters
+    /*! The pixels are stored in an index sorted by (x,y), so the
+     *  neighbours of a pixel within _sparseMinDistanceSquared are
+     *  found by a few binary searches instead of a scan over all
+     *  remaining pixels. Clusters are seeded and grown in the same
+     *  order as the original pairwise algorithm, hence the output is
+     *  identical.
+     *
+     *  @param hitPixelVec The hit pixels of one sensor
+     *  @param clusterIndexVec For each cluster the indices into
+     *  hitPixelVec, in the order the pixels were attached
+     */
+    void groupPixels(const std::vector<EUTelGenericSparsePixel>& hitPixelVec, std::vector< std::vector<size_t> >& clusterIndexVec) const;
+
     //! Input collection name for ZS data
     /*! The input collection is the calibrated data one coming from
      *  the EUTelCalibrateEventProcessor. It is, usually, called
@@ -28,6 +28,9 @@
 #include "marlin/Processor.h"
 #include "marlin/VerbosityLevels.h"
 
+#include <map>
+#include <vector>
+
 
 
 
@@ -42,10 +45,14 @@ namespace eutelescope {
 	class  EUTelReaderGenericLCIO{
 		public: 
 			EUTelReaderGenericLCIO();
-            void getColVec( std::vector<EUTelTrack> tracks,LCEvent* evt,std::string colName );
+            void getColVec( std::vector<EUTelTrack>& tracks,LCEvent* evt,std::string colName );
             std::vector<EUTelTrack> getTracks( LCEvent* evt, std::string colName);
 
   	private:
+            /** Generic object holding the serialised doubles of a track, state or hit */
+            static IMPL::LCGenericObjectImpl* newGenericObject(const std::vector<double>& output);
+            /** Copy the doubles of a generic object into input, which is reused between objects */
+            static void getDoubles(const EVENT::LCGenericObject* object, std::vector<double>& input);
 	};
 
 }
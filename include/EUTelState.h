@@ -12,6 +12,7 @@
 #endif
 #include "EUTelHit.h"
 #include "EUTelGeometryTelescopeGeoDescription.h"
+#include "EUTelTrackMath.h"
 
 namespace eutelescope {
 
@@ -23,8 +24,8 @@ namespace eutelescope {
 			EUTelHit getHit();
 			int getDimensionSize() const ;
 			int	getLocation() const;
-			TMatrixDSym getStateCov() const;
-			TVectorD getStateVec();
+			Matrix5d getStateCov() const;
+			Vector5d getStateVec();
             TVector3 getMomLocal();
 			float getMomLocalX() const {return _momLocalX;}
 			float getMomLocalY() const {return _momLocalY;}
@@ -36,7 +37,7 @@ namespace eutelescope {
 			TVector3 getPositionGlobal() const; 
 			void getCombinedHitAndStateCovMatrixInLocalFrame(double (&cov)[4]) const;
 			bool getStateHasHit() const;
-			TMatrixD getProjectionMatrix() const;
+			Eigen::Matrix2d getProjectionMatrix() const;
 			TVector3 getIncidenceUnitMomentumVectorInLocalFrame();
 			TMatrixDSym getScatteringVarianceInLocalFrame();
 			TMatrixDSym getScatteringVarianceInLocalFrame(float variance);
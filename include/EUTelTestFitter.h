@@ -198,7 +198,10 @@ namespace eutelescope {
    *
    * \param SearchMultipleTracks Flag for searching multiple tracks in
    *        events with multiple hits. If false, only best (lowest
-   *        \f$ \chi^{2} \f$) track is taken.
+   *        \f$ \chi^{2} \f$) track is taken. Hypotheses which can not
+   *        be better than the best track found so far are then skipped,
+   *        so the per plane fit and residual histograms are only filled
+   *        for tracks improving on it.
    *
    * \param AllowAmbiguousHits Allow same hit to be used in more than
    *        one track. In the new implementation this option does not
@@ -259,7 +262,15 @@ namespace eutelescope {
    * layers or hit rejection is allowed, the algorithm checks all hits
    * selection possibilities (all track hypothesis). This task is
    * optimized to a large extent, but still track finding can be slow
-   * for large multiplicities. Here are some suggestions on how to
+   * for large multiplicities. Hits are added plane by plane to a
+   * partial fit, which is updated incrementally. As soon as its
+   * \f$ \chi^{2} \f$ plus penalties exceeds \e Chi2Max (or the best
+   * track, if \e SearchMultipleTracks is false), all hypotheses with
+   * the same hits in these planes are skipped, and the full fit is only
+   * done for the remaining ones. The \e firstChi2 histogram of the best
+   * \f$ \chi^{2} \f$ of each event is exact below \e Chi2Max; above
+   * it, the lowest partial \f$ \chi^{2} \f$ of the skipped hypotheses
+   * is used, a lower bound of their best track. Here are some suggestions on how to
    * improve performance.
    *
    *  \li Remove addition layers from geometry description. At high
@@ -415,6 +426,14 @@ namespace eutelescope {
      */
     double NominalFit();
 
+    //! Find track in XZ and YZ assuming nominal errors, for any hit pattern
+    /*! With nominal position errors the fit matrix only depends on
+     * which planes have a hit selected. Its inverse is calculated once
+     * per hit pattern and run, and stored in _maskFitArrays. The fit is
+     * then a matrix-vector product, as in NominalFit().
+     */
+    double MaskFit();
+
     //! Fit particle track in one plane (XZ or YZ), taking into
     //! account beam slope
     int DoAnalFit(double * pos, double *err, double slope=0.);
@@ -429,6 +448,34 @@ namespace eutelescope {
     //! Solve matrix equation
     int GaussjSolve(double * alfa, double * beta, int n);
 
+    //! Partial track fit in one plane (XZ or YZ)
+    /*! Normal equations of the fit to the planes added so far, with
+     *  the positions in these planes eliminated. What is left is a
+     *  quadratic form in the positions in the next two planes: matrix
+     *  (m00, m01, m11), right hand side (r0, r1) and constant c.
+     */
+    struct PrefixFit {
+      double m00, m01, m11;
+      double r0, r1;
+      double c;
+    };
+
+    //! Start partial fit, including beam constraint if used
+    void InitPrefixFit(PrefixFit & fit, double slope=0.) const;
+
+    //! Add next plane to partial fit
+    /*! Adds the measurement in plane ipl (err=0 if there is none) and
+     *  the scattering in plane ipl+1, then eliminates the position in
+     *  plane ipl. Planes have to be added in order, starting from 0.
+     */
+    void AddPrefixFitPlane(PrefixFit & fit, int ipl, double pos, double err) const;
+
+    //! Calculate \f$ \chi^{2} \f$ of partial fit
+    /*! Same as the \f$ \chi^{2} \f$ of the full fit to the measurements
+     *  added so far. Adding more measurements can not decrease it.
+     */
+    double GetPrefixFitChi2(const PrefixFit & fit) const;
+
 
     //! Silicon planes parameters as described in GEAR
     /*! This structure actually contains the following:
@@ -598,6 +645,12 @@ namespace eutelescope {
     double * _nominalFitArrayY ;
     double * _nominalErrorY ;
 
+    //! Inverse fit matrices for nominal errors, keyed by hit pattern
+    /*! Bit ipl of the key is set if plane ipl has a hit selected.
+     *  An empty matrix marks a pattern for which the fit fails.
+     */
+    std::map<unsigned long, std::vector<double> > _maskFitArrays ;
+
     // few counter to show the final summary
 
     //! Number of event w/o input hit
@@ -0,0 +1,113 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELTHREADPOOL_H
+#define EUTELTHREADPOOL_H
+
+// eutelescope includes ".h"
+#include "EUTELESCOPE.h"
+
+// system includes <>
+#include <pthread.h>
+#include <string>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Fixed set of worker threads to share independent items of work
+  /*! The threads are started once and are reused for every call to
+   *  run(). The calling thread takes part in the work, so a pool of
+   *  size one runs everything in the caller without any locking
+   *  overhead of note.
+   *
+   *  Items are handed out one by one, the order in which they are
+   *  processed is therefore not defined. Jobs have to write their
+   *  result into a slot belonging to the item, which keeps the merged
+   *  output independent of the number of threads.
+   *
+   *  An exception thrown while processing an item stops the hand out
+   *  of further items and is rethrown as lcio::Exception by run() once
+   *  all threads are idle again.
+   */
+  class EUTelThreadPool {
+
+  public:
+    //! Work to be shared over the threads of the pool
+    class Job {
+    public:
+      virtual ~Job() {}
+
+      //! Process a single item, called concurrently for different items
+      /*! thread is 0 for the caller of run() and 1 to getNumberOfThreads()-1
+       *  for the workers, so jobs can keep one set of scratch objects per
+       *  thread.
+       */
+      virtual void process( size_t item, int thread ) = 0;
+    };
+
+    //! Start nThreads-1 worker threads, the caller is the last one
+    explicit EUTelThreadPool( int nThreads );
+
+    //! Stop and join the worker threads
+    ~EUTelThreadPool();
+
+    //! Number of threads working in run(), including the caller
+    int getNumberOfThreads() const { return static_cast<int>( _workers.size() ) + 1; }
+
+    //! Process the items 0 to nItems-1 of job and return when all are done
+    void run( Job& job, size_t nItems );
+
+  private:
+    DISALLOW_COPY_AND_ASSIGN(EUTelThreadPool)
+
+    //! Entry point handed to pthread_create
+    static void* workerEntry( void* pool );
+
+    //! Wait for work until the pool is destroyed
+    void workerLoop();
+
+    //! Take items of the current job until none are left
+    void processItems( int thread );
+
+    //! Keep the first error message and stop handing out items
+    void setError( const std::string& message );
+
+    std::vector<pthread_t> _workers;
+
+    pthread_mutex_t _mutex;
+
+    //! Signalled when a new job is available or the pool shuts down
+    pthread_cond_t _startCondition;
+
+    //! Signalled when the last worker finished the current job
+    pthread_cond_t _doneCondition;
+
+    Job* _job;
+
+    size_t _nItems;
+
+    size_t _nextItem;
+
+    //! Incremented for each job, so workers can tell a new job from a spurious wake up
+    unsigned long _generation;
+
+    //! Number of workers still busy with the current job
+    size_t _nBusy;
+
+    //! Last thread index handed to a worker
+    int _nIndexedWorkers;
+
+    bool _shutdown;
+
+    bool _failed;
+
+    std::string _error;
+  };
+
+}
+#endif
@@ -0,0 +1,59 @@
+#ifndef EUTELTRACKMATH_H
+#define EUTELTRACKMATH_H
+
+// ROOT
+#include "TMatrixD.h"
+#include "TVectorD.h"
+
+//Eigen
+#include <Eigen/Core>
+#include <Eigen/LU>
+
+#include <cmath>
+
+namespace eutelescope {
+
+	/** Track state in the local frame of a plane: (q/p, dx/dz, dy/dz, x, y) */
+	typedef Eigen::Matrix<double, 5, 1> Vector5d;
+
+	/** Jacobians and covariances of the track state */
+	typedef Eigen::Matrix<double, 5, 5> Matrix5d;
+
+	namespace Utility {
+
+		/** Copy of a fixed size matrix as TMatrixD, where the GBL interface expects ROOT types */
+		template<typename Derived>
+		TMatrixD toTMatrixD( const Eigen::MatrixBase<Derived>& mat ) {
+			TMatrixD out( mat.rows(), mat.cols() );
+			for( int i = 0; i < mat.rows(); ++i ) {
+				for( int j = 0; j < mat.cols(); ++j ) {
+					out[i][j] = mat(i,j);
+				}
+			}
+			return out;
+		}
+
+		/** Copy of a fixed size vector as TVectorD */
+		template<typename Derived>
+		TVectorD toTVectorD( const Eigen::MatrixBase<Derived>& vec ) {
+			TVectorD out( vec.size() );
+			for( int i = 0; i < vec.size(); ++i ) {
+				out[i] = vec(i);
+			}
+			return out;
+		}
+
+		/** Set all entries with a magnitude below mod to zero */
+		inline Matrix5d setPrecision( Matrix5d mat, double mod ) {
+			for( int i = 0; i < 5; ++i ) {
+				for( int j = 0; j < 5; ++j ) {
+					if( std::fabs(mat(i,j)) < mod ) {
+						mat(i,j) = 0;
+					}
+				}
+			}
+			return mat;
+		}
+	}
+}
+#endif
@@ -176,19 +176,6 @@ namespace eutelescope {
                 const std::vector< unsigned int >&,
                 unsigned int = 0);
 
-        /*!
-         * Checks if a hit belongs to a hot-pixel-map
-         */
-
-        //! Called for first event per run
-        /*! Reads hotpixel information from hotPixelCollection into hotPixelMap
-         * to be used in the sensor exclusion area logic 
-         */
-
-        std::map<std::string, bool > FillHotPixelMap(EVENT::LCEvent *event, const std::string& hotPixelCollectionName);
-
-        bool HitContainsHotPixels(const IMPL::TrackerHitImpl * hit, const std::map<std::string, bool >& hotPixelMap);
-
 	std::auto_ptr<EUTelVirtualCluster> GetClusterFromHit(const IMPL::TrackerHitImpl*);
 
         int getSensorIDfromHit( EVENT::TrackerHit* hit);
@@ -0,0 +1,149 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+#ifndef ALIBAVACLIPPEDSTATISTICS_H
+#define ALIBAVACLIPPEDSTATISTICS_H 1
+
+// ROOT includes <>
+#include "TMath.h"
+
+// system includes <>
+#include <cmath>
+#include <vector>
+
+namespace alibava {
+
+	//! Running mean and sigma of one channel with outlier clipping
+	/*! The first values are kept in a small buffer. Once it is full,
+	 *  the buffer is clipped iteratively: values further than nSigma
+	 *  times the sigma from the mean are dropped, and mean and sigma
+	 *  are computed again until no more values are dropped. After that
+	 *  every new value is compared to the current estimate. Values
+	 *  inside the window update the running mean and variance, the
+	 *  others are counted as rejected.
+	 *
+	 *  The variance of a Gaussian clipped at nSigma is smaller than the
+	 *  full one. getSigma() corrects for this, so it estimates the
+	 *  sigma of the Gaussian core like a fit does. The memory does not
+	 *  depend on the number of values or on any binning.
+	 */
+	class AlibavaClippedStatistics {
+
+	public:
+		AlibavaClippedStatistics() :
+		_nSigma(3.), _truncation(truncationFactor(3.)), _nWarmup(100), _warmup(), _clipping(false),
+		_n(0), _mean(0.), _m2(0.), _nRejected(0) {}
+
+		//! Set the clipping window and the number of values used to start it
+		void setClipping(double nSigma, unsigned int nWarmup) {
+			_nSigma = nSigma;
+			_truncation = truncationFactor(nSigma);
+			_nWarmup = nWarmup > 1 ? nWarmup : 2;
+		}
+
+		//! Add a value
+		void add(double value) {
+			if (!_clipping) {
+				_warmup.push_back(static_cast<float>(value));
+				if (_warmup.size() >= _nWarmup) startClipping();
+				return;
+			}
+			if (std::fabs(value - _mean) <= _nSigma * getSigma()) accumulate(value);
+			else ++_nRejected;
+		}
+
+		//! Clip the buffer if there were fewer values than needed to start the clipping
+		void finish() {
+			if (!_clipping) startClipping();
+		}
+
+		//! Clipped mean, 0 before finish() if still in the first values
+		double getMean() const { return _mean; }
+
+		//! Sigma of the Gaussian core, from the clipped variance
+		double getSigma() const {
+			if (_n == 0) return 0.;
+			return std::sqrt(_m2 / _n / _truncation);
+		}
+
+		//! Number of values used in the estimate
+		unsigned long getNumberOfEntries() const { return _n; }
+
+		//! Number of values rejected by the clipping
+		unsigned long getNumberOfRejected() const { return _nRejected; }
+
+	private:
+		//! Welford update of the mean and the sum of squared deviations
+		void accumulate(double value) {
+			++_n;
+			const double delta = value - _mean;
+			_mean += delta / _n;
+			_m2 += delta * (value - _mean);
+		}
+
+		//! Iterative clipping of the buffered values, which then start the running estimate
+		void startClipping() {
+			std::vector<bool> used(_warmup.size(), true);
+			size_t nUsed = _warmup.size();
+			for (int iteration = 0; iteration < 20; ++iteration) {
+				_n = 0; _mean = 0.; _m2 = 0.;
+				for (size_t i = 0; i < _warmup.size(); ++i) if (used[i]) accumulate(_warmup[i]);
+				// the first pass is not clipped, its sigma is not corrected
+				const double window = _nSigma * (iteration == 0 && _n > 0 ? std::sqrt(_m2 / _n) : getSigma());
+				size_t nInside = 0;
+				for (size_t i = 0; i < _warmup.size(); ++i) {
+					used[i] = std::fabs(_warmup[i] - _mean) <= window;
+					if (used[i]) ++nInside;
+				}
+				if (nInside == nUsed || nInside == 0) break;
+				nUsed = nInside;
+			}
+			_n = 0; _mean = 0.; _m2 = 0.;
+			_nRejected = 0;
+			for (size_t i = 0; i < _warmup.size(); ++i) {
+				if (used[i]) accumulate(_warmup[i]);
+				else ++_nRejected;
+			}
+			std::vector<float>().swap(_warmup);
+			_clipping = true;
+		}
+
+		//! Ratio of the variance of a Gaussian clipped at nSigma to the full one
+		static double truncationFactor(double nSigma) {
+			const double inside = TMath::Erf(nSigma / std::sqrt(2.));
+			if (inside <= 0.) return 1.;
+			const double factor = 1. - 2. * nSigma * TMath::Gaus(nSigma, 0., 1., true) / inside;
+			return factor > 0. ? factor : 1.;
+		}
+
+		double _nSigma;
+
+		//! truncationFactor() of _nSigma
+		double _truncation;
+
+		unsigned int _nWarmup;
+
+		//! The first values, until the clipping starts
+		std::vector<float> _warmup;
+
+		bool _clipping;
+
+		unsigned long _n;
+
+		double _mean;
+
+		//! Sum of squared deviations from the mean of the used values
+		double _m2;
+
+		unsigned long _nRejected;
+	};
+
+}
+
+#endif
@@ -11,6 +11,9 @@
 // alibava includes ".h"
 #include "AlibavaBaseProcessor.h"
 
+// eutelescope includes ".h"
+#include "EUTelHistogramTable.h"
+
 // marlin includes ".h"
 #include "marlin/Processor.h"
 
@@ -20,6 +23,7 @@
 
 // ROOT includes <>
 #include "TObject.h"
+#include "TH1D.h"
 
 // system includes <>
 #include <string>
@@ -158,6 +162,11 @@ namespace alibava {
 		 *  _chanRawDataHistoName+chanNum
 		 */
 		std::string _chanDataHistoName;
+
+		//! The channel histograms indexed by chip and channel
+		/*! Filled in bookHistos(), masked channels have no histogram.
+		 */
+		eutelescope::EUTelHistogramTable<TH1D> _chanDataHistos;
 		
 
 		//! The function that returns name of the histogram
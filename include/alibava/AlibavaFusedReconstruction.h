@@ -0,0 +1,234 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+#ifndef ALIBAVAFUSEDRECONSTRUCTION_H
+#define ALIBAVAFUSEDRECONSTRUCTION_H 1
+
+// alibava includes ".h"
+#include "AlibavaBaseProcessor.h"
+#include "ALIBAVA.h"
+
+// eutelescope includes ".h"
+#include "EUTelHistogramTable.h"
+
+// marlin includes ".h"
+#include "marlin/Processor.h"
+
+// lcio includes <.h>
+#include <lcio.h>
+#include <IMPL/LCRunHeaderImpl.h>
+#include <IMPL/LCCollectionVec.h>
+#include <IMPL/TrackerDataImpl.h>
+
+// ROOT includes <>
+#include "TObject.h"
+#include "TH1D.h"
+
+// system includes <>
+#include <string>
+
+
+namespace alibava {
+
+	//! Pedestal subtraction, common mode correction and clustering in one processor
+	/*! This processor does the work of AlibavaPedestalSubtraction,
+	 *  AlibavaConstantCommonModeProcessor, AlibavaCommonModeSubtraction
+	 *  and AlibavaSeedClustering for the raw data of each chip. The 128
+	 *  channels of a chip are handled in arrays on the stack, there is
+	 *  no copy of the LCIO charge vectors and no intermediate collection
+	 *  has to be read back from the event.
+	 *
+	 *  Only the clusters are written by default. The pedestal
+	 *  subtracted data, the common mode and its error and the common
+	 *  mode corrected data are written only if their collection name is
+	 *  set, they are then the same as the ones of the separate
+	 *  processors.
+	 *
+	 *  The seed channels are handled in order of decreasing signal to
+	 *  noise ratio, seeds with the same ratio in order of the channel
+	 *  number.
+	 */
+
+	class AlibavaFusedReconstruction:public alibava::AlibavaBaseProcessor   {
+
+	public:
+
+
+		//! Returns a new instance of AlibavaFusedReconstruction
+		/*! This method returns an new instance of the this processor.  It
+		 *  is called by Marlin execution framework and it shouldn't be
+		 *  called/used by the final user.
+		 *
+		 *  @return a new AlibavaFusedReconstruction.
+		 */
+		virtual Processor * newProcessor () {
+			return new AlibavaFusedReconstruction;
+		}
+
+		//! Default constructor
+		AlibavaFusedReconstruction ();
+
+		//! Called at the job beginning.
+		/*! This is executed only once in the whole execution. It prints
+		 *  out the processor parameters and checks the cuts, the signal
+		 *  polarity and the sensitive axis.
+		 */
+		virtual void init ();
+
+		//! Called for every run.
+		/*! Reads the chip selection from the run header, sets the channel
+		 *  masks, reads the pedestal and noise values, copies them in the
+		 *  per chip arrays and books the histograms.
+		 *
+		 *  @param run the LCRunHeader of the this current run
+		 */
+		virtual void processRunHeader (LCRunHeader * run);
+
+		//! Called every event
+		/*! Reconstructs every chip of the input collection and adds the
+		 *  requested collections to the event.
+		 *
+		 *  @param evt the current LCEvent event as passed by the
+		 *  ProcessMgr
+		 */
+		virtual void processEvent (LCEvent * evt);
+
+
+		//! Check event method
+		/*! This method is called by the Marlin execution framework as
+		 *  soon as the processEvent is over. It can be used to fill check
+		 *  plots. For the time being there is nothing to check and do in
+		 *  this slot.
+		 *
+		 *  @param evt The LCEvent event as passed by the ProcessMgr
+		 *
+		 */
+		virtual void check (LCEvent * evt);
+
+
+		//! Book histograms
+		/*! Books the common mode, cluster size and eta histograms of each
+		 *  selected chip and keeps them in _chipHistos.
+		 */
+		void bookHistos();
+
+
+		//! Called after data processing.
+		/*! Prints the number of skipped events.
+		 */
+		virtual void end();
+
+		//////////////////////////
+		// Processor Parameters //
+		//////////////////////////
+
+		// Output collections, an empty name means the collection is not written
+
+		// Pedestal subtracted data, as written by AlibavaPedestalSubtraction
+		std::string _recoDataCollectionName;
+
+		// Common mode and its error, as written by AlibavaConstantCommonModeProcessor
+		std::string _commonmodeCollectionName;
+		std::string _commonmodeerrorCollectionName;
+
+		// Common mode corrected data, as written by AlibavaCommonModeSubtraction
+		std::string _correctedDataCollectionName;
+
+		// Clusters, as written by AlibavaSeedClustering
+		std::string _clusterCollectionName;
+
+		// Common Mode
+		// The number of iterations of the common mode calculation
+		int _Niteration;
+
+		// Channels deviating more than this from the common mode, in units of its error, are not used in the next iteration
+		float _NoiseDeviation;
+
+		// SNR Cuts
+		// The signal/noise ratio that channels have to pass to be considered as seed channel
+		float _seedCut;
+
+		// The signal/noise ratio that neigbour channels have to pass to be added to the cluster
+		float _neighCut;
+
+		// Sensitive Axis
+		// The sensitive axis of the strip sensor(s) according to telescope. Set to zero (0) for "Y", any other value means "X"
+		int _sensitiveAxisX;
+
+		// Signal Polarity
+		// Polarity of the signal. Set this parameter to -1 for negative signals, any other value will be disregarded and the signal will be assumed to be positive
+		int _signalPolarity;
+
+		std::string getHistoNameForChip(std::string histoName, int ichip);
+
+	protected:
+
+		//! Reconstructs one chip
+		/*! Fills the requested data collections and the cluster
+		 *  collection, a NULL collection is not filled.
+		 *
+		 *  @return the number of clusters of this chip
+		 */
+		int reconstructChip(int chipnum, const EVENT::FloatVec & rawVec,
+								  IMPL::LCCollectionVec * recoColVec, IMPL::LCCollectionVec * commonColVec,
+								  IMPL::LCCollectionVec * commerrColVec, IMPL::LCCollectionVec * correctedColVec,
+								  IMPL::LCCollectionVec * clusterColVec);
+
+		//! Iterative common mode and its error
+		/*! Same calculation as
+		 *  AlibavaConstantCommonModeProcessor::calculateConstantCommonMode
+		 *  on the pedestal subtracted signals of a chip.
+		 */
+		void calculateCommonMode(int chipnum, const float * recoSignal, float & commonmode, float & commonmodeerror);
+
+		//! Eta of the cluster around seedChan, as in AlibavaSeedClustering::calculateEta
+		float calculateEta(int chipnum, const float * signal, int seedChan);
+
+		//! Adds a TrackerDataImpl with the chip number and values to a data collection
+		void addChipData(IMPL::LCCollectionVec * colVec, int chipnum, const float * values);
+
+		/////////////////////
+		// Histogram Names //
+		/////////////////////
+
+		// Common mode histogram name
+		std::string _commonModeHistoName;
+
+		// Eta histogram name for ClusterSize > 1
+		std::string _etaHistoName;
+
+		// Cluster Size
+		std::string _clusterSizeHistoName;
+
+		//! Columns of _chipHistos
+		enum { kCommonModeHisto, kClusterSizeHisto, kEtaHisto, kNumberOfChipHistos };
+
+		//! The histograms indexed by chip number and kind
+		eutelescope::EUTelHistogramTable<TH1D> _chipHistos;
+
+		//
+		bool _isSensitiveAxisX;
+
+		//! Pedestal values of each chip, copied from the pedestal map
+		float _pedestal[ALIBAVA::NOOFCHIPS][ALIBAVA::NOOFCHANNELS];
+
+		//! Noise values of each chip, copied from the noise map
+		float _noise[ALIBAVA::NOOFCHIPS][ALIBAVA::NOOFCHANNELS];
+
+		//! Channel masks of each chip, copied from isMasked()
+		bool _masked[ALIBAVA::NOOFCHIPS][ALIBAVA::NOOFCHANNELS];
+
+	};
+
+	//! A global instance of the processor
+	AlibavaFusedReconstruction gAlibavaFusedReconstruction;
+
+}
+
+#endif
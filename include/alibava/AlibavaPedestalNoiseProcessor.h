@@ -10,6 +10,10 @@
 
 // alibava includes ".h"
 #include "AlibavaBaseProcessor.h"
+#include "AlibavaClippedStatistics.h"
+
+// eutelescope includes ".h"
+#include "EUTelHistogramTable.h"
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -20,10 +24,12 @@
 
 // ROOT includes <>
 #include "TObject.h"
+#include "TH1D.h"
 
 // system includes <>
 #include <string>
 #include <list>
+#include <vector>
 
 
 namespace alibava {
@@ -171,6 +177,28 @@ namespace alibava {
 		 */
 		std::string _chanDataFitName;
 
+		//! The channel histograms indexed by chip and channel
+		/*! Filled in bookHistos(), masked channels have no histogram.
+		 *  In the streaming mode they are only booked for the
+		 *  validation.
+		 */
+		eutelescope::EUTelHistogramTable<TH1D> _chanDataHistos;
+
+		//! Use the clipped running statistics instead of the Gaussian fits
+		bool _useStreamingStatistics;
+
+		//! Clipping window of the running statistics in units of the noise
+		float _clippingSigma;
+
+		//! Number of events used to start the clipping
+		int _clippingStartEvents;
+
+		//! Fit the channel histograms as well and compare to the running statistics
+		bool _validateWithFit;
+
+		//! The running statistics, indexed by chip * NOOFCHANNELS + channel
+		std::vector<AlibavaClippedStatistics> _chanStatistics;
+
 		//! The function that returns name of the histogram for each channel
 		std::string getChanDataHistoName(unsigned int ichip, unsigned int ichan);
 	
@@ -16,6 +16,7 @@
 #include "EUTelRunHeaderImpl.h"
 #include "EUTelEventImpl.h"
 #include "EUTelHistogramManager.h"
+#include "EUTelCalibrationKernels.h"
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -41,6 +42,7 @@
 #include <iostream>
 #include <iomanip>
 #include <memory>
+#include <algorithm>
 
 using namespace std;
 using namespace lcio;
@@ -445,14 +447,11 @@ void EUTelCalibrateEventProcessor::processEvent (LCEvent * event) {
 
     for (unsigned int iDetector = 0; iDetector < inputCollectionVec->size(); iDetector++) {
       vector< float > commonModeCorVec;
-      commonModeCorVec.clear();
 
       // reset quantity for the common mode.
-      double pixelSum      = 0.;
       double commonMode    = 0.;
-      int    goodPixel     = 0;
       int    skippedPixel  = 0;
-      int    skippedRow   = 0;
+      int    skippedRow    = 0;
 
 
       TrackerRawDataImpl  * rawData   = dynamic_cast < TrackerRawDataImpl * >(inputCollectionVec->getElementAt(iDetector));
@@ -478,30 +477,24 @@ void EUTelCalibrateEventProcessor::processEvent (LCEvent * event) {
 
       idDataEncoder.setCellID(corrected);
 
-      ShortVec::const_iterator rawIter     = rawData->getADCValues().begin();
-      FloatVec::const_iterator pedIter     = pedestal->getChargeValues().begin();
-      FloatVec::const_iterator noiseIter   = noise->getChargeValues().begin();
-      ShortVec::const_iterator statusIter  = status->getADCValues().begin();
-
+      // the pixel loops work directly on the contiguous LCIO vectors
+      const ShortVec & adcValues    = rawData->getADCValues();
+      const FloatVec & pedValues    = pedestal->getChargeValues();
+      const FloatVec & noiseValues  = noise->getChargeValues();
+      const ShortVec & statusValues = status->getADCValues();
+      const size_t     noOfPixel    = adcValues.size();
+      const short      goodStatus   = static_cast< short >( EUTELESCOPE::GOODPIXEL );
 
       bool isEventValid = true;
       if ( _doCommonMode == 1 ) {
 
         // FULLFRAME common mode
-        while ( rawIter != rawData->getADCValues().end() ) {
-          bool isHit   = ( ((*rawIter) - (*pedIter)) > _hitRejectionCut * (*noiseIter) );
-          bool isGood  = ( (*statusIter) == EUTELESCOPE::GOODPIXEL );
-
-          if ( !isHit && isGood ) {
-            pixelSum += (*rawIter) - (*pedIter);
-            ++goodPixel;
-          } else if ( isHit ) {
-            ++skippedPixel;
-          }
-          ++rawIter;
-          ++pedIter;
-          ++noiseIter;
-          ++statusIter;
+        // an empty frame has no good pixel, the event is skipped below
+        int    goodPixel = 0;
+        double pixelSum  = 0.;
+        if ( noOfPixel > 0 ) {
+          pixelSum = CalibrationKernels::commonModeSum( &adcValues[0], &pedValues[0], &noiseValues[0], &statusValues[0],
+                                                        noOfPixel, _hitRejectionCut, goodStatus, goodPixel, skippedPixel );
         }
 
         if ( ( ( _maxNoOfRejectedPixels == -1 )  ||  ( skippedPixel < _maxNoOfRejectedPixels ) ) &&
@@ -527,52 +520,35 @@ void EUTelCalibrateEventProcessor::processEvent (LCEvent * event) {
       } else if ( _doCommonMode == 2 ) {
 
         // ROWWISE common mode
-        ShortVec adcValues = rawData->getADCValues ();
-        FloatVec _pedestal     = pedestal->getChargeValues();
-        ShortVec _status  = status->getADCValues();
-        FloatVec  _noise   = noise->getChargeValues();
-        int    iPixel       = 0;
-        int    colCounter   = 0;
-        int    rowLength    = _maxX[iDetector] -  _minX[iDetector] + 1;
-
-        for (int yPixel = _minY[iDetector]; yPixel <= _maxY[iDetector]; yPixel++) {
-
-          double pixelSum           = 0.;
-          double commonMode         = 0.;
-          int    goodPixel          = 0;
-          int    skippedPixelPerRow = 0;
-
-          for ( int xPixel = _minX[iDetector]; xPixel <= _maxX[iDetector]; xPixel++) {
-            bool isHit  = ( ( adcValues[iPixel] - _pedestal[iPixel] ) > _hitRejectionCut * _noise[iPixel] );
-            bool isGood = ( _status[iPixel] == EUTELESCOPE::GOODPIXEL );
-            if ( !isHit && isGood ) {
-              pixelSum += adcValues[iPixel] - _pedestal[iPixel];
-              ++goodPixel;
-            } else if ( isHit ) {
-              ++skippedPixelPerRow;
-              ++skippedPixel;
-            }
-            ++iPixel;
-          }
+        const int rowLength = _maxX[iDetector] - _minX[iDetector] + 1;
+        const int noOfRows  = noOfPixel > 0 ? _maxY[iDetector] - _minY[iDetector] + 1 : 0;
+        commonModeCorVec.assign( noOfPixel, 0. );
+
+        for ( int iRow = 0; iRow < noOfRows; iRow++ ) {
+
+          const int rowBegin           = iRow * rowLength;
+          int       goodPixel          = 0;
+          int       skippedPixelPerRow = 0;
+          double    pixelSum           = CalibrationKernels::commonModeSum( &adcValues[rowBegin], &pedValues[rowBegin], &noiseValues[rowBegin],
+                                                                            &statusValues[rowBegin], rowLength, _hitRejectionCut, goodStatus,
+                                                                            goodPixel, skippedPixelPerRow );
+          skippedPixel += skippedPixelPerRow;
 
           // we are now at the end of the row, so let's calculate the
           // common mode
           if ( ( skippedPixelPerRow < _maxNoOfRejectedPixelPerRow ) &&
                ( goodPixel != 0 ) ) {
-            commonMode = pixelSum / goodPixel ;
-            commonModeCorVec.insert( commonModeCorVec.begin() + colCounter * rowLength, rowLength, commonMode );
+            double rowCommonMode = pixelSum / goodPixel ;
+            std::fill( commonModeCorVec.begin() + rowBegin, commonModeCorVec.begin() + rowBegin + rowLength, rowCommonMode );
 
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
             string tempHistoName = _commonModeDistHistoName + "_d" + to_string( sensorID );
             if ( AIDA::IHistogram1D* histo = dynamic_cast<AIDA::IHistogram1D*>(_aidaHistoMap[tempHistoName]) )
-              histo->fill(commonMode);
+              histo->fill(rowCommonMode);
 #endif
           } else {
-            commonModeCorVec.insert( commonModeCorVec.begin() + colCounter * rowLength, rowLength, 0. );
             ++skippedRow;
           }
-
-          ++colCounter;
         }
         if ( skippedRow > _maxNoOfSkippedRow ) {
           isEventValid = false;
@@ -581,83 +557,39 @@ void EUTelCalibrateEventProcessor::processEvent (LCEvent * event) {
       } // end if on _doCommonMode
 
       if(isEventValid) {
-        if(_doCommonMode == 2) {
-          ShortVec adcValues = rawData->getADCValues ();
-          FloatVec _pedestal = pedestal->getChargeValues();
 
-          int iPixel = 0;
-
-          for (int yPixel = _minY[iDetector]; yPixel <= _maxY[iDetector]; yPixel++) {
-            for ( int xPixel = _minX[iDetector]; xPixel <= _maxX[iDetector]; xPixel++) {
-
-              double correctedValue = adcValues[iPixel] - _pedestal[iPixel] - commonModeCorVec[iPixel];
-              corrected->chargeValues().push_back(correctedValue);
-
-              ++iPixel;
-#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
-              if (_fillDebugHisto == 1) {
-                string tempHistoName = _rawDataDistHistoName + "_d" + to_string( sensorID );
-                if ( AIDA::IHistogram1D* histo = dynamic_cast<AIDA::IHistogram1D*>(_aidaHistoMap[tempHistoName]) ) {
-                  histo->fill(adcValues[iPixel]);
-                } else {
-                  streamlog_out ( ERROR1 ) << "Not able to retrieve histogram pointer for " << tempHistoName
-                                           << ".\nDisabling histogramming from now on " << endl;
-                  _fillDebugHisto = 0 ;
-                }
-
-                tempHistoName = _dataDistHistoName + "_d" + to_string( sensorID );
-                if ( AIDA::IHistogram1D * histo = dynamic_cast<AIDA::IHistogram1D*>(_aidaHistoMap[tempHistoName]) ) {
-                  histo->fill(correctedValue);
-                } else {
-                  streamlog_out ( ERROR1 ) << "Not able to retrieve histogram pointer for " << tempHistoName
-                                           << ".\nDisabling histogramming from now on " << endl;
-                  _fillDebugHisto = 0 ;
-                }
-              }
-#endif
-            }
-          }
+        // in the case the user doesn't want to apply any correction
+        // at all, the value of the commonMode variable is taken
+        // directly from the initialization ( = 0 ).
+        FloatVec & correctedValues = corrected->chargeValues();
+        correctedValues.resize( noOfPixel );
+        if ( noOfPixel == 0 ) {
+          // nothing to correct in an empty frame
+        } else if ( _doCommonMode == 2 ) {
+          CalibrationKernels::subtractPedestal( &adcValues[0], &pedValues[0], &commonModeCorVec[0], noOfPixel, &correctedValues[0] );
         } else {
-
-          // that's the case the user wants to apply the FullFrame
-          // common mode or doesn't want to apply any correction at
-          // all. In this last case the value of the commonMode
-          // variable is taken directly from the initialization ( = 0 ).
-
-          rawIter     = rawData->getADCValues().begin();
-          pedIter     = pedestal->getChargeValues().begin();
-
-          while ( rawIter != rawData->getADCValues().end() )  {
-
-            double correctedValue = (*rawIter) - (*pedIter) - commonMode;
-            corrected->chargeValues().push_back(correctedValue);
-
+          CalibrationKernels::subtractPedestal( &adcValues[0], &pedValues[0], static_cast< float >( commonMode ), noOfPixel, &correctedValues[0] );
+        }
 
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
-            if (_fillDebugHisto == 1) {
-              string tempHistoName = _rawDataDistHistoName + "_d" + to_string( sensorID );
-              if ( AIDA::IHistogram1D* histo = dynamic_cast<AIDA::IHistogram1D*>(_aidaHistoMap[tempHistoName]) ) {
-                histo->fill(*rawIter);
-              } else {
-                streamlog_out ( ERROR1 ) << "Not able to retrieve histogram pointer for " << tempHistoName
-                                         << ".\nDisabling histogramming from now on " << endl;
-                _fillDebugHisto = 0 ;
-              }
-
-              tempHistoName = _dataDistHistoName + "_d" + to_string( sensorID );
-              if ( AIDA::IHistogram1D * histo = dynamic_cast<AIDA::IHistogram1D*>(_aidaHistoMap[tempHistoName]) ) {
-                histo->fill(correctedValue);
-              } else {
-                streamlog_out ( ERROR1 ) << "Not able to retrieve histogram pointer for " << tempHistoName
-                                         << ".\nDisabling histogramming from now on " << endl;
-                _fillDebugHisto = 0 ;
-              }
+        if (_fillDebugHisto == 1) {
+          string rawHistoName  = _rawDataDistHistoName + "_d" + to_string( sensorID );
+          string dataHistoName = _dataDistHistoName + "_d" + to_string( sensorID );
+          AIDA::IHistogram1D * rawHisto  = dynamic_cast<AIDA::IHistogram1D*>(_aidaHistoMap[rawHistoName]);
+          AIDA::IHistogram1D * dataHisto = dynamic_cast<AIDA::IHistogram1D*>(_aidaHistoMap[dataHistoName]);
+          if ( rawHisto && dataHisto ) {
+            for ( size_t iPixel = 0; iPixel < noOfPixel; ++iPixel ) {
+              rawHisto->fill(adcValues[iPixel]);
+              dataHisto->fill(correctedValues[iPixel]);
             }
-#endif
-            ++rawIter;
-            ++pedIter;
+          } else {
+            streamlog_out ( ERROR1 ) << "Not able to retrieve histogram pointer for "
+                                     << ( rawHisto ? dataHistoName : rawHistoName )
+                                     << ".\nDisabling histogramming from now on " << endl;
+            _fillDebugHisto = 0 ;
           }
         }
+#endif
 
       } else {
         // this is the case the event is not valid because of common
@@ -29,6 +29,7 @@
 #include "EUTelMatrixDecoder.h"
 #include "EUTelTrackerDataInterfacerImpl.h"
 #include "EUTelSparseClusterImpl.h"
+#include "EUTelCalibrationKernels.h"
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -95,6 +96,7 @@ EUTelClusteringProcessor::EUTelClusteringProcessor ()
       _fillHistos(false),
       _histoInfoFileName(""),
       _seedCandidateMap(),
+      _seedCandidateIndexVec(),
       _totClusterMap(),
       _noOfDetector(0),
       _ExcludedPlanes(),
@@ -2302,17 +2304,19 @@ void EUTelClusteringProcessor::fixedFrameClustering(LCEvent * evt, LCCollectionV
         short clusterCounter = 0;
         short limitExceed    = 0;
 
-        _seedCandidateMap.clear();
+        const FloatVec & signalValues = nzsData->getChargeValues();
+        _seedCandidateIndexVec.clear();
+        if ( !signalValues.empty() ) {
+            CalibrationKernels::findSeedCandidates( &signalValues[0], &noise->getChargeValues()[0], &status->getADCValues()[0],
+                                                    signalValues.size(), _ffSeedCut, static_cast< short >( EUTELESCOPE::GOODPIXEL ),
+                                                    _seedCandidateIndexVec );
+        }
 
-        for (unsigned int iPixel = 0; iPixel < nzsData->getChargeValues().size(); iPixel++)
-        {
-            if (status->getADCValues()[iPixel] == EUTELESCOPE::GOODPIXEL)
-            {
-                if ( nzsData->getChargeValues()[iPixel] > _ffSeedCut * noise->getChargeValues()[iPixel])
-                {
-                    _seedCandidateMap.push_back(make_pair( nzsData->getChargeValues()[iPixel], iPixel));
-                }
-            }
+        _seedCandidateMap.clear();
+        _seedCandidateMap.reserve( _seedCandidateIndexVec.size() );
+        for ( size_t iCandidate = 0; iCandidate < _seedCandidateIndexVec.size(); ++iCandidate ) {
+            unsigned int iPixel = _seedCandidateIndexVec[ iCandidate ];
+            _seedCandidateMap.push_back(make_pair( signalValues[iPixel], iPixel));
         }
 
         // continue only if seed candidate map is not empty!
@@ -2320,15 +2324,17 @@ void EUTelClusteringProcessor::fixedFrameClustering(LCEvent * evt, LCCollectionV
 
             streamlog_out ( DEBUG0 ) << "There are << " << _seedCandidateMap.size() << " seed candidates." << endl;
 
-            // now built up a cluster for each seed candidate
-            //Start by sorting the vector in order of smallest to largest seed signal
-            std::sort(_seedCandidateMap.begin(),_seedCandidateMap.end());
-            vector< pair< float, unsigned int > >::iterator mapIter = _seedCandidateMap.end();
-            while ( mapIter != _seedCandidateMap.begin() ) {
-                --mapIter;
+            // now built up a cluster for each seed candidate, taking
+            // them from the heap from the largest to the smallest seed
+            // signal
+            std::make_heap(_seedCandidateMap.begin(),_seedCandidateMap.end());
+            while ( !_seedCandidateMap.empty() ) {
+                std::pop_heap(_seedCandidateMap.begin(),_seedCandidateMap.end());
+                const pair< float, unsigned int > seedCandidate = _seedCandidateMap.back();
+                _seedCandidateMap.pop_back();
                 // check if this seed candidate has not been already added to a
                 // cluster
-                if ( status->adcValues()[(*mapIter).second] == EUTELESCOPE::GOODPIXEL ) {
+                if ( status->adcValues()[seedCandidate.second] == EUTELESCOPE::GOODPIXEL ) {
                     // if we enter here, this means that at least the seed pixel
                     // wasn't added yet to another cluster.  Note that now we need
                     // to build a candidate cluster that has to pass the
@@ -2338,7 +2344,7 @@ void EUTelClusteringProcessor::fixedFrameClustering(LCEvent * evt, LCCollectionV
                     FloatVec clusterCandidateCharges;
                     IntVec   clusterCandidateIndeces;
                     int seedX, seedY;
-                    matrixDecoder.getXYFromIndex((*mapIter).second,seedX, seedY);
+                    matrixDecoder.getXYFromIndex(seedCandidate.second,seedX, seedY);
 
                     // start looping around the seed pixel. Remember that the seed
                     // pixel has to stay in the center of cluster
@@ -2560,45 +2566,51 @@ void EUTelClusteringProcessor::nzsBrickedClustering(LCEvent * evt, LCCollectionV
         vector< pair <float, int> > seedCandidateMap;
 
         // fill the seed candidate map
-        for (unsigned int iPixel = 0; iPixel < nzsData->getChargeValues().size(); iPixel++)
+        //! CUT 1
+        const FloatVec & signalValues = nzsData->getChargeValues();
+        _seedCandidateIndexVec.clear();
+        if ( !signalValues.empty() ) {
+            CalibrationKernels::findSeedCandidates( &signalValues[0], &noise->getChargeValues()[0], &status->getADCValues()[0],
+                                                    signalValues.size(), _ffSeedCut, static_cast< short >( EUTELESCOPE::GOODPIXEL ),
+                                                    _seedCandidateIndexVec );
+        }
+        seedCandidateMap.reserve( _seedCandidateIndexVec.size() );
+        for ( size_t iCandidate = 0; iCandidate < _seedCandidateIndexVec.size(); ++iCandidate )
         {
-            if (status->getADCValues()[iPixel] == EUTELESCOPE::GOODPIXEL)
+            int iPixel = static_cast< int >( _seedCandidateIndexVec[ iCandidate ] );
+            seedCandidateMap.push_back(make_pair( signalValues[iPixel], iPixel));
+            streamlog_out ( MESSAGE2 )
+                << "Added pixel at (index=" << iPixel
+                << ") with signal " << signalValues[iPixel]
+                << " to the seedCandidateMap" << endl;
+
+            if ( noise->getChargeValues()[ iPixel ] < 0.01 )
             {
-                //! CUT 1
-                if ( nzsData->getChargeValues()[iPixel] > _ffSeedCut * noise->getChargeValues()[iPixel])
-                {
-                    seedCandidateMap.push_back(make_pair( nzsData->getChargeValues()[iPixel], iPixel));
-                    streamlog_out ( MESSAGE2 )
-                        << "Added pixel at (index=" << iPixel
-                        << ") with signal " << nzsData->getChargeValues()[iPixel]
-                        << " to the seedCandidateMap" << endl;
-
-                    if ( noise->getChargeValues()[ iPixel ] < 0.01 )
-                    {
-                        streamlog_out ( ERROR2 )    << "ZERO NOISE SEED PIXEL ADDED (nszBrickedClustering)!"
-                                                    << "\n index=" << iPixel
-                                                    << "\n amp=" << nzsData->getChargeValues()[ iPixel ]
-                                                    << "\n status=" << status->getADCValues()[ iPixel ]
-                                                    <<    " GOODP   =  0,"
-                                                    <<    " BAD     =  1,"
-                                                    <<    " HIT     = -1,"
-                                                    <<    " MISSING =  2,"
-                                                    <<    " FIRING  =  3.";
-                    }
-                }
+                streamlog_out ( ERROR2 )    << "ZERO NOISE SEED PIXEL ADDED (nszBrickedClustering)!"
+                                            << "\n index=" << iPixel
+                                            << "\n amp=" << signalValues[ iPixel ]
+                                            << "\n status=" << status->getADCValues()[ iPixel ]
+                                            <<    " GOODP   =  0,"
+                                            <<    " BAD     =  1,"
+                                            <<    " HIT     = -1,"
+                                            <<    " MISSING =  2,"
+                                            <<    " FIRING  =  3.";
             }
         }
 
         streamlog_out ( DEBUG0 ) << "The number of seed candidates is: " << seedCandidateMap.size() << endl;
-        std::sort(seedCandidateMap.begin(),seedCandidateMap.end());
         if ( !seedCandidateMap.empty() )
         {
-            // now build up a cluster for each seed candidate
-            vector< pair<float, int> >::iterator rMapIter = seedCandidateMap.end();
-            while ( rMapIter != seedCandidateMap.begin() )
+            // now build up a cluster for each seed candidate, taking
+            // them from the heap from the largest to the smallest seed
+            // signal
+            std::make_heap(seedCandidateMap.begin(),seedCandidateMap.end());
+            while ( !seedCandidateMap.empty() )
             {
-                rMapIter--;
-                if ( status->adcValues()[ (*rMapIter).second ] == EUTELESCOPE::GOODPIXEL )
+                std::pop_heap(seedCandidateMap.begin(),seedCandidateMap.end());
+                const pair<float, int> seedCandidate = seedCandidateMap.back();
+                seedCandidateMap.pop_back();
+                if ( status->adcValues()[ seedCandidate.second ] == EUTELESCOPE::GOODPIXEL )
                 {
                     // if we enter here, this means that at least the seed pixel
                     // wasn't added yet to another cluster.  Note that now we need
@@ -2615,7 +2627,7 @@ void EUTelClusteringProcessor::nzsBrickedClustering(LCEvent * evt, LCCollectionV
                     // start looping around the seed pixel. Remember that the seed
                     // pixel has to stay in the center of cluster
                     int seedX, seedY;
-                    matrixDecoder.getXYFromIndex ( (*rMapIter).second, seedX, seedY );
+                    matrixDecoder.getXYFromIndex ( seedCandidate.second, seedX, seedY );
 
                     for (int yPixel = seedY - (_ffYClusterSize / 2); yPixel <= seedY + (_ffYClusterSize / 2); yPixel++)
                     {
@@ -2819,7 +2831,7 @@ void EUTelClusteringProcessor::nzsBrickedClustering(LCEvent * evt, LCCollectionV
                     delete brickedClusterCandidate;
 
                 } //END: if ( currentSeedpixelcandidate == EUTELESCOPE::GOODPIXEL )
-            } //END: while (not all seed candidates in the map have been processed) ((while ( rMapIter != seedCandidateMap.rend() )))
+            } //END: while (not all seed candidates in the heap have been processed)
         } //END: if ( seedCandidateMap.size() != 0 )
     } //for ( unsigned int i = 0 ; i < zsInputDataCollectionVec->size(); i++ )
 
@@ -2872,20 +2884,16 @@ void EUTelClusteringProcessor::end() {
 
 void EUTelClusteringProcessor::resetStatus(IMPL::TrackerRawDataImpl * status) {
 
-    int i = 0;
-    ShortVec::iterator iter = status->adcValues().begin();
-    while ( iter != status->adcValues().end() )
+    // written as a select, so the loop over the full frame is
+    // vectorised
+    const short goodPixel    = static_cast< short >( EUTELESCOPE::GOODPIXEL );
+    const short hitPixel     = static_cast< short >( EUTELESCOPE::HITPIXEL );
+    const short missingPixel = static_cast< short >( EUTELESCOPE::MISSINGPIXEL );
+    ShortVec & statusValues  = status->adcValues();
+    for ( size_t iPixel = 0; iPixel < statusValues.size(); ++iPixel )
     {
-        if ( *iter == EUTELESCOPE::HITPIXEL )
-        {
-            *iter = EUTELESCOPE::GOODPIXEL;
-        }
-        else if ( *iter == EUTELESCOPE::MISSINGPIXEL )
-        {
-            *iter = EUTELESCOPE::GOODPIXEL;
-        }
-        ++iter;
-        i++;
+        const short value      = statusValues[ iPixel ];
+        statusValues[ iPixel ] = ( ( value == hitPixel ) | ( value == missingPixel ) ) ? goodPixel : value;
     }
 }
 
@@ -111,6 +111,14 @@ _histoInfoFileName("histoinfo.xml")
                               "How many events are needed to get reasonable correlation plots (and Offset DB)? (default=1000)",
                               _events, static_cast <int> (1000) );
 
+  registerOptionalParameter ("UseHistogramBuffers",
+                             "Fill the correlation histograms through buffers which are flushed every HistogramFlushInterval events. Faster, but the entries, mean and RMS of the saved histograms are computed from the filled bins, only the bin contents are exact (default=false)",
+                             _useHistogramBuffers, static_cast <bool> (false) );
+
+  registerOptionalParameter ("HistogramFlushInterval",
+                             "Number of events between two flushes of the buffered correlation histograms, 0 flushes only at the end. Only used with UseHistogramBuffers (default=1000)",
+                             _histogramFlushInterval, static_cast <int> (1000) );
+
   registerOptionalParameter ("FixedPlane", "SensorID of fixed plane", _fixedPlaneID, 0);
 
 
@@ -224,6 +232,8 @@ void EUTelCorrelator::processEvent (LCEvent * event) {
      if(_iEvt > _events) return;
         ++_iEvt;
 
+     if ( _useHistogramBuffers && _histogramFlushInterval > 0 && _iEvt % _histogramFlushInterval == 0 ) flushHistogramBuffers();
+
 
      EUTelEventImpl * evt = static_cast<EUTelEventImpl*> (event) ;
 
@@ -438,8 +448,8 @@ void EUTelCorrelator::processEvent (LCEvent * event) {
             streamlog_out( MESSAGE1 )  << " ex " << externalSensorID <<" = [" << externalXCenter << ":" << externalYCenter << "]"
                                        << " in " << internalSensorID <<" = [" << internalXCenter << ":" << internalYCenter << "]" << std::endl;
 
-            _clusterXCorrelationMatrix[ externalSensorID ][ internalSensorID ]->fill( externalXCenter, internalXCenter );
-            _clusterYCorrelationMatrix[ externalSensorID ][ internalSensorID ]->fill( externalYCenter, internalYCenter );
+            _clusterXCorrelationBuffer[ externalSensorID ][ internalSensorID ].fill( externalXCenter, internalXCenter );
+            _clusterYCorrelationBuffer[ externalSensorID ][ internalSensorID ].fill( externalYCenter, internalYCenter );
 
           } // endif
 
@@ -561,11 +571,11 @@ void EUTelCorrelator::processEvent (LCEvent * event) {
             for(int i = 0; i < (int)trackX.size();i++)
             {
               if( i == indexPlane ) continue; // skip as this one is not booked
-              _hitXCorrelationMatrix[ iplane[ indexPlane ]        ] [ iplane[i]        ] -> fill ( trackX[ indexPlane ]          , trackX[i]           ) ;
-              _hitYCorrelationMatrix[ iplane[ indexPlane ]        ] [ iplane[i]        ] -> fill ( trackY[ indexPlane ]          , trackY[i]           ) ;
+              _hitXCorrelationBuffer[ iplane[ indexPlane ]        ] [ iplane[i]        ].fill ( trackX[ indexPlane ]          , trackX[i]           ) ;
+              _hitYCorrelationBuffer[ iplane[ indexPlane ]        ] [ iplane[i]        ].fill ( trackY[ indexPlane ]          , trackY[i]           ) ;
               // assume all rotations have been done in the hitmaker processor:
-              _hitXCorrShiftMatrix[ iplane[ indexPlane ]        ][ iplane[i]        ]->fill( trackX[ indexPlane ]          , trackX[ indexPlane ]          - trackX[i]          );
-              _hitYCorrShiftMatrix[ iplane[ indexPlane ]        ][ iplane[i]        ]->fill( trackY[ indexPlane ]          , trackY[ indexPlane ]          - trackY[i]         );
+              _hitXCorrShiftBuffer[ iplane[ indexPlane ]        ][ iplane[i]        ].fill( trackX[ indexPlane ]          , trackX[ indexPlane ]          - trackX[i]          );
+              _hitYCorrShiftBuffer[ iplane[ indexPlane ]        ][ iplane[i]        ].fill( trackY[ indexPlane ]          , trackY[ indexPlane ]          - trackY[i]         );
             }
           }
         }else{
@@ -585,6 +595,9 @@ void EUTelCorrelator::processEvent (LCEvent * event) {
 
 void EUTelCorrelator::end() {
 
+#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+    flushHistogramBuffers();
+#endif
 
  
     if( _hasHitCollection)
@@ -604,6 +617,9 @@ void EUTelCorrelator::end() {
                 if( _hitXCorrShiftMatrix[ exPlaneID ][ inPlaneID ]->yAxis().bins() <= 0 ) continue;
 
 
+                // with UseHistogramBuffers the shift histograms get one
+                // weighted fill per bin and flush: their bin entries count
+                // flushes, only the bin heights count the hit pairs
                 float _heighestBinX = 0.;
                 for( int ibin = 0; ibin < _hitXCorrShiftMatrix[ exPlaneID ][ inPlaneID ]->yAxis().bins(); ibin++)
                 {
@@ -612,7 +628,7 @@ void EUTelCorrelator::end() {
                         +
                         _hitXCorrShiftProjection[ inPlaneID ]->axis().binWidth(ibin)/2.
                         ;
-                    double _binValue = _hitXCorrShiftMatrix[ exPlaneID ][ inPlaneID ]->binEntriesY( ibin );
+                    double _binValue = _hitXCorrShiftMatrix[ exPlaneID ][ inPlaneID ]->binHeightY( ibin );
                     _hitXCorrShiftProjection[ inPlaneID ]->fill( xbin, _binValue );
                     if( _binValue>0)
                     if( _binValue > _heighestBinX )
@@ -630,7 +646,7 @@ void EUTelCorrelator::end() {
                         +
                         _hitYCorrShiftProjection[ inPlaneID ]->axis().binWidth(ibin)/2.
                         ;
-                    double _binValue = _hitYCorrShiftMatrix[ exPlaneID ][ inPlaneID ]->binEntriesY( ibin );
+                    double _binValue = _hitYCorrShiftMatrix[ exPlaneID ][ inPlaneID ]->binHeightY( ibin );
                     _hitYCorrShiftProjection[ inPlaneID ]->fill( xbin, _binValue );
                     if( _binValue>0)
                     if( _binValue > _heighestBinY )
@@ -696,6 +712,23 @@ void EUTelCorrelator::end() {
     streamlog_out ( MESSAGE4 )  << "Successfully finished" << endl;
 }
 
+#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+void EUTelCorrelator::flushHistogramBuffers() {
+
+  HistogramBufferMatrix * buffers[] = { &_clusterXCorrelationBuffer, &_clusterYCorrelationBuffer,
+                                        &_hitXCorrelationBuffer, &_hitYCorrelationBuffer,
+                                        &_hitXCorrShiftBuffer, &_hitYCorrShiftBuffer };
+
+  for ( size_t iMatrix = 0; iMatrix < sizeof( buffers ) / sizeof( buffers[0] ); ++iMatrix ) {
+    for ( HistogramBufferMatrix::iterator row = buffers[iMatrix]->begin(); row != buffers[iMatrix]->end(); ++row ) {
+      for ( std::map< unsigned int, EUTelHistogramBuffer2D< AIDA::IHistogram2D > >::iterator col = row->second.begin(); col != row->second.end(); ++col ) {
+        col->second.flush();
+      }
+    }
+  }
+}
+#endif
+
 void EUTelCorrelator::bookHistos() {
 
   if ( !_hasClusterCollection && !_hasHitCollection ) return ;
@@ -994,6 +1027,11 @@ void EUTelCorrelator::bookHistos() {
       {
         _clusterXCorrelationMatrix[ row ] = innerMapXCluster  ;
         _clusterYCorrelationMatrix[ row ] = innerMapYCluster  ;        
+
+        for ( std::map< unsigned int, AIDA::IHistogram2D* >::const_iterator iter = innerMapXCluster.begin(); iter != innerMapXCluster.end(); ++iter ) {
+          _clusterXCorrelationBuffer[ row ][ iter->first ].bind( iter->second, _useHistogramBuffers );
+          _clusterYCorrelationBuffer[ row ][ iter->first ].bind( innerMapYCluster[ iter->first ], _useHistogramBuffers );
+        }
         
       }
 
@@ -1004,6 +1042,13 @@ void EUTelCorrelator::bookHistos() {
 
          _hitXCorrShiftMatrix[ row ]   = innerMapXHitShift  ;
          _hitYCorrShiftMatrix[ row ]   = innerMapYHitShift  ;        
+
+         for ( std::map< unsigned int, AIDA::IHistogram2D* >::const_iterator iter = innerMapXHit.begin(); iter != innerMapXHit.end(); ++iter ) {
+           _hitXCorrelationBuffer[ row ][ iter->first ].bind( iter->second, _useHistogramBuffers );
+           _hitYCorrelationBuffer[ row ][ iter->first ].bind( innerMapYHit[ iter->first ], _useHistogramBuffers );
+           _hitXCorrShiftBuffer[ row ][ iter->first ].bind( innerMapXHitShift[ iter->first ], _useHistogramBuffers );
+           _hitYCorrShiftBuffer[ row ][ iter->first ].bind( innerMapYHitShift[ iter->first ], _useHistogramBuffers );
+         }
  
             // book special histos to calculate sensors initial offsets in X and Y (Projection histograms)
             // book X
@@ -12,10 +12,6 @@ EigenFitter::EigenFitter(int nPlanes){
   //H maps parameter vector in to the local x-y coordinates of the plane
   H(0,0) = 1; H(1,1) =1;
 
-  //Transportation matrix
-  transM.setIdentity();
-  transMtranspose = transM.transpose();
-
   //Storage of track estimates per plane for the forward, backward running filters, and for the final smoothed estimate
   backward.resize(nPlanes);  
   forward.resize(nPlanes);
@@ -39,6 +35,9 @@ void EigenFitter::calculatePlaneWeight(FitPlane& plane, TrackEstimate* e, float
   }
   plane.weights.resize(nMeas);
   plane.weights.setZero();
+  //Residual variances are the same for all measurements in the plane
+  const float varX = plane.getSigmaX() * plane.getSigmaX() + e->cov(0,0);
+  const float varY = plane.getSigmaY() * plane.getSigmaY() + e->cov(1,1);
   //Get the value exp( -chi2 / 2t) for each measurement
   for(size_t m = 0; m < nMeas ; m++){
     const Measurement &meas = plane.meas.at(m);
@@ -46,8 +45,8 @@ void EigenFitter::calculatePlaneWeight(FitPlane& plane, TrackEstimate* e, float
 //printf("%8.3f %8.3f <->%8.3f %8.3f \n", e->params(0),e->params(1), meas.getM()(0), meas.getM()(1) );
 
     chi2s = resids.array().square().matrix();
-    chi2s(0) /= plane.getSigmaX() * plane.getSigmaX() + e->cov(0,0);
-    chi2s(1) /= plane.getSigmaY() * plane.getSigmaY() + e->cov(1,1);
+    chi2s(0) /= varX;
+    chi2s(1) /= varY;
     //resids = plane.getVars() + Vector2f( e->cov(0,0), e->cov(1,1) );
     //chi2s = chi2s.cwise() / resids;
 //printf("X: chi2:%8.3f  plane.sigmaX:%8.3f e-cov(00):%8.3f res(0):%8.3f\n", chi2s(0), plane.getSigmaX(), e->cov(0,0), resids(0) );
@@ -85,23 +84,27 @@ void EigenFitter::predictInfo(const FitPlane &prev, const FitPlane &cur, TrackEs
   //Add scattering to weight matrix using Woodbury matrix identity
   //inv( C + H Q H') = W - W H (inv(Q) + H' W H ) H' W
   //inv( C + H Q H')x = Wx - W H (inv(Q) + H' W H ) H' Wx
-  tmp4x4.setZero();
-  tmp4x4(2,2) = 1.0f / (invScatterCov(0) + e->cov(2,2));
-  tmp4x4(3,3) = 1.0f / (invScatterCov(1) + e->cov(3,3));
-
-  // //The rest
-  tmp4x4_2 = e->cov * tmp4x4;
-  e->cov -= tmp4x4_2 * e->cov;
-  e->params -= tmp4x4_2 * e->params;
-  
-  //Inverse jacobian is just the oposite transformation
-  transM(0,2) = transM(1,3) = transMtranspose(2,0) = transMtranspose(3,1) = prev.getMeasZ() - cur.getMeasZ();
+  //The middle matrix only has the (2,2) and (3,3) elements, so this is
+  //a rank 2 update with the slope columns of the symmetric W
+  float d2 = 1.0f / (invScatterCov(0) + e->cov(2,2));
+  float d3 = 1.0f / (invScatterCov(1) + e->cov(3,3));
+  tmpState1 = e->cov.col(2);
+  tmpState2 = e->cov.col(3);
+  e->params -= tmpState1 * (d2 * e->params(2)) + tmpState2 * (d3 * e->params(3));
+  e->cov -= d2 * tmpState1 * tmpState1.transpose() + d3 * tmpState2 * tmpState2.transpose();
 
-  //New weight matrix is inv(F)' inv(C) inv(F)
-  tmp4x4 = transMtranspose * e->cov;
-  e->cov = tmp4x4  * transM;
-  //Weigt vector bacomes
-  e->params = transMtranspose * e->params;
+  //Inverse jacobian is just the oposite transformation
+  //inv(F) = I + dz (E02 + E13)
+  float dz = prev.getMeasZ() - cur.getMeasZ();
+
+  //New weight matrix is inv(F)' inv(C) inv(F), column then row operations
+  e->cov.col(2) += dz * e->cov.col(0);
+  e->cov.col(3) += dz * e->cov.col(1);
+  e->cov.row(2) += dz * e->cov.row(0);
+  e->cov.row(3) += dz * e->cov.row(1);
+  //Weigt vector bacomes inv(F)' x
+  e->params(2) += dz * e->params(0);
+  e->params(3) += dz * e->params(1);
 }
 
 void EigenFitter::updateInfo(const FitPlane &pl, const int index, TrackEstimate *e){
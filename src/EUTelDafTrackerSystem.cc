@@ -3,6 +3,8 @@
 
 #include <iostream>
 #include <algorithm>
+#include <cmath>
+#include <utility>
 #include <Eigen/Core>
 
 #include <TVector3.h>
@@ -121,31 +123,14 @@ void TrackerSystem::getChi2Daf(TrackCandidate *candidate){
   candidate->chi2 = chi2; candidate->ndof = (ndof * 2) - 4;
 }
 
-bool clusterSort(PlaneHit& a, PlaneHit& b) {
-  //Sort by radius
-  return( a.getM().squaredNorm() > b.getM().squaredNorm()  ); 
+int TrackerSystem::getClusterCell(float pos, float cellSize) {
+  return( static_cast<int>( std::floor( pos / cellSize )));
 }
 
-int TrackerSystem::addNeighbors(vector<PlaneHit> &candidate, list<PlaneHit> &hits){
-  int counter(0); //How many hits are added to the cluster this iteration?
-  for(list<PlaneHit>::iterator hit = hits.begin(); hit != hits.end(); hit++ ){
-    for(vector<PlaneHit>::iterator it = candidate.begin(); it != candidate.end(); it++){
-      Eigen::Vector2f resids = (*hit).getM() - (*it).getM();
-     if(resids.squaredNorm() > m_sqrClusterRadius  ) { continue;}
-//     if(counter>3)  printf("addNeigh %5d %8.3f gt/lt %8.3f \n", counter, resids.squaredNorm(), m_sqrClusterRadius );
-      candidate.push_back((*hit));
-      hit = hits.erase(hit);
-      counter ++; break;
-    }
-  }
-  return (counter);
-}
-
-
 void TrackerSystem::clusterTracker(){
   streamlog_out(MESSAGE2)<< " void TrackerSystem::clusterTracker ---------- BEGIN ------------ " << std::endl;
 
-  list<PlaneHit> availableHits;
+  vector<PlaneHit> availableHits;
   //Add all meas points to list
   for(size_t ii = 0; ii < planes.size(); ii++){
     streamlog_out(MESSAGE2) << " i : " << ii << " of " << planes.size() << std::endl;
@@ -154,18 +139,57 @@ void TrackerSystem::clusterTracker(){
     float yShift = -1 * getNominalYdz() * planes.at(ii).getZpos();
     for(size_t mm = 0; mm < planes.at(ii).meas.size(); mm++){
       PlaneHit a(planes.at(ii).meas.at(mm).getX() + xShift, planes.at(ii).meas.at(mm).getY() + yShift, ii, mm);
-//    printf("clusterTracker:: ii=%5d mm=%5d X=%8.3f Y=%8.3f \n",ii,mm,planes.at(ii).meas.at(mm).getX() + xShift, planes.at(ii).meas.at(mm).getY() + yShift);
       availableHits.push_back( a );
     }
   }
-  //Sort by radius from origin
-  availableHits.sort(clusterSort);
-
-  while( not availableHits.empty() ){
-    vector<PlaneHit> candidate;
-    candidate.push_back( availableHits.front() );
-    availableHits.pop_front();
-    while( addNeighbors( candidate , availableHits ) > 0) {;}
+
+  //Bucket hits into a grid with the cluster radius as cell size, all
+  //neighbours of a hit are then in the 3x3 cells around it. Seeds are
+  //taken by decreasing radius from origin.
+  const float cellSize = m_sqrClusterRadius > 0.0f ? std::sqrt(m_sqrClusterRadius) : 1.0f;
+  vector< pair< pair<int, int>, size_t > > grid( availableHits.size() );
+  vector< pair< float, size_t > > seedOrder( availableHits.size() );
+  for(size_t ii = 0; ii < availableHits.size(); ii++){
+    const Eigen::Vector2f& m = availableHits.at(ii).getM();
+    grid.at(ii) = make_pair( make_pair( getClusterCell(m(0), cellSize), getClusterCell(m(1), cellSize) ), ii);
+    seedOrder.at(ii) = make_pair( -m.squaredNorm(), ii);
+  }
+  sort(grid.begin(), grid.end());
+  sort(seedOrder.begin(), seedOrder.end());
+
+  vector<bool> used( availableHits.size(), false);
+  vector<size_t> toVisit;
+  vector<PlaneHit> candidate;
+
+  for(size_t iseed = 0; iseed < seedOrder.size(); iseed++){
+    size_t seed = seedOrder.at(iseed).second;
+    if( used.at(seed) ) { continue; }
+
+    //Flood fill: add all hits connected to the seed by steps within the cluster radius
+    candidate.clear();
+    used.at(seed) = true;
+    toVisit.push_back(seed);
+    while( not toVisit.empty() ){
+      const PlaneHit& hit = availableHits.at( toVisit.back() );
+      toVisit.pop_back();
+      candidate.push_back( hit );
+      int cellX = getClusterCell( hit.getM()(0), cellSize);
+      int cellY = getClusterCell( hit.getM()(1), cellSize);
+      for(int dx = -1; dx <= 1; dx++){
+        for(int dy = -1; dy <= 1; dy++){
+          pair<int, int> cell = make_pair(cellX + dx, cellY + dy);
+          vector< pair< pair<int, int>, size_t > >::const_iterator it = lower_bound( grid.begin(), grid.end(), make_pair(cell, static_cast<size_t>(0)));
+          for(; it != grid.end() && it->first == cell; it++){
+            size_t other = it->second;
+            if( used.at(other) ) { continue; }
+            Eigen::Vector2f resids = availableHits.at(other).getM() - hit.getM();
+            if(resids.squaredNorm() > m_sqrClusterRadius  ) { continue;}
+            used.at(other) = true;
+            toVisit.push_back(other);
+          }
+        }
+      }
+    }
     //If we find enough hits, we make a candidate
 
     if(candidate.size() < getMinClusterSize() ){ continue; }
@@ -175,7 +199,6 @@ void TrackerSystem::clusterTracker(){
 		<< " If you are sure you config is right, see trackersystem.h on how to increase it." << std::endl;
       return;
     }
-//printf("TrackerSystem::clusterTracker candidate size is OK\n");
     TrackCandidate* cnd = tracks.at(m_nTracks);
     for(size_t ii = 0; ii < planes.size(); ii++){
      if( planes.at(ii).meas.size() > 0 ) { 
@@ -188,7 +211,6 @@ void TrackerSystem::clusterTracker(){
       cnd->weights.at( hit.getPlane() )( hit.getIndex()) = 1.0;
     }
     m_nTracks++;
-//printf("TrackerSystem::clusterTracker m_nTracks = %5d \n", m_nTracks);
   }
 
   streamlog_out(MESSAGE2)<< " void TrackerSystem::clusterTracker ----------- END --------------" << std::endl;
@@ -198,7 +220,8 @@ void TrackerSystem::clusterTracker(){
 void TrackerSystem::fitPlanesInfo(TrackCandidate *candidate){
   //Biased fitter
   size_t nPlanes = planes.size();
-  TrackEstimate* e = new TrackEstimate();
+  TrackEstimate estimate;
+  TrackEstimate* e = &estimate;
   e->cov.setZero();
   e->params.setZero();
   e->cov(2,2) = e->cov(3,3) = 1.0e-5f;
@@ -222,7 +245,6 @@ void TrackerSystem::fitPlanesInfo(TrackCandidate *candidate){
     m_fitter->backward.at(ii)->copy(e);
     m_fitter->updateInfo( planes.at(ii), candidate->indexes.at(ii), e );
   }
-  delete e;
 
   m_fitter->smoothInfo();
 
@@ -355,7 +377,8 @@ void TrackerSystem::checkNan(TrackEstimate* e){
 float TrackerSystem::fitPlanesInfoDafInner(){
 //printf("fitPlanesInfodafInner \n");
   size_t nPlanes = planes.size();// usually 6
-  TrackEstimate* e = new TrackEstimate();
+  TrackEstimate estimate;
+  TrackEstimate* e = &estimate;
   e->cov.setZero();
   e->params.setZero();
   //Forward fitter
@@ -375,8 +398,8 @@ float TrackerSystem::fitPlanesInfoDafInner(){
   }
 //printf("ndof %5.2f <? 2.5 [return?]\n", ndof);
   //No reason to complete
-  //if(ndof < 2.5) { delete e; return(ndof);}
-  if(ndof < 1.5) { delete e; return(ndof);} //Changed the magic number 2.5 to 1.5, because this lets you have tracks on only 3 planes. I have no idea why this works and tbh this should be made better
+  //if(ndof < 2.5) { return(ndof);}
+  if(ndof < 1.5) { return(ndof);} //Changed the magic number 2.5 to 1.5, because this lets you have tracks on only 3 planes. I have no idea why this works and tbh this should be made better
   
   //Backward fitter, never bias
   e->cov.setZero();
@@ -389,7 +412,6 @@ float TrackerSystem::fitPlanesInfoDafInner(){
     m_fitter->backward.at(ii)->copy(e);
     m_fitter->updateInfoDaf( planes.at(ii), e );
   }
-  delete e;
 
 //  printf("returning ndof=%8.3f \n", ndof);
 
@@ -401,7 +423,8 @@ float TrackerSystem::fitPlanesInfoDafBiased(){
 //printf("TrackerSystem::fitPlanesInfoDafBiased\n");
 
   size_t nPlanes = planes.size();
-  TrackEstimate* e = new TrackEstimate();
+  TrackEstimate estimate;
+  TrackEstimate* e = &estimate;
   e->cov.setZero();
   e->params.setZero();
   //Forward fitter
@@ -417,7 +440,7 @@ float TrackerSystem::fitPlanesInfoDafBiased(){
 //    printf("forward: m_fitter: %5d  ndof=%5.2f \n", ii, ndof); 
   }
   //No reason to complete
-  if(ndof < 2.5) { delete e; return(ndof);}
+  if(ndof < 2.5) { return(ndof);}
   
   //Backward fitter, never bias
   e->cov.setZero();
@@ -430,7 +453,6 @@ float TrackerSystem::fitPlanesInfoDafBiased(){
     m_fitter->updateInfoDaf( planes.at(ii), e );
 //    printf("backward: m_fitter: %5d  ndof=%5.2f \n", ii, ndof); 
   }
-  delete e;
 
   m_fitter->smoothInfo();
   return(ndof);
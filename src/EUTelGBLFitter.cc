@@ -85,19 +85,19 @@ namespace eutelescope {
 	void EUTelGBLFitter::setScattererGBL(gbl::GblPoint& point, EUTelState & state ) {
 		streamlog_out(DEBUG1) << " setScattererGBL ------------- BEGIN --------------  " << std::endl;
 		TMatrixDSym precisionMatrix =  state.getScatteringVarianceInLocalFrame();
-		streamlog_out(MESSAGE1) << "The precision matrix being used for the sensor  "<<state.getLocation()<<":" << std::endl;
+		streamlog_out(DEBUG1) << "The precision matrix being used for the sensor  "<<state.getLocation()<<":" << std::endl;
 		streamlog_message( DEBUG0, precisionMatrix.Print();, std::endl; );
 		point.addScatterer(state.getKinks(), precisionMatrix);
 		streamlog_out(DEBUG1) << "  setScattererGBL  ------------- END ----------------- " << std::endl;
 	}
 		//This is used when the we know the radiation length already
 		void EUTelGBLFitter::setScattererGBL(gbl::GblPoint& point,EUTelState & state, float variance,TVectorD scat ) {
-		streamlog_out(MESSAGE1) << " setScattererGBL ------------- BEGIN --------------  " << std::endl;
+		streamlog_out(DEBUG1) << " setScattererGBL ------------- BEGIN --------------  " << std::endl;
 		TMatrixDSym precisionMatrix =  state.getScatteringVarianceInLocalFrame(variance);
-		streamlog_out(MESSAGE1) << "The precision matrix being used for the scatter:  " << std::endl;
+		streamlog_out(DEBUG1) << "The precision matrix being used for the scatter:  " << std::endl;
 		streamlog_message( DEBUG0, precisionMatrix.Print();, std::endl; );
 		point.addScatterer(scat, precisionMatrix);
-		streamlog_out(MESSAGE1) << "  setScattererGBL  ------------- END ----------------- " << std::endl;
+		streamlog_out(DEBUG1) << "  setScattererGBL  ------------- END ----------------- " << std::endl;
 	}
 	void EUTelGBLFitter::setLocalDerivativesToPoint(gbl::GblPoint& point, float distanceFromKinkTargetToNextPlane){
 		TMatrixD derivatives(2,2);
@@ -109,7 +109,7 @@ namespace eutelescope {
 	}
 	//This will add measurement information to the GBL point
 	//Note that if we have a strip sensor then y will be ignored using projection matrix.
-	void EUTelGBLFitter::setMeasurementGBL(gbl::GblPoint& point, const double *hitPos,  double statePos[3], double combinedCov[4], TMatrixD projection){
+	void EUTelGBLFitter::setMeasurementGBL(gbl::GblPoint& point, const double *hitPos,  double statePos[3], double combinedCov[4], const Eigen::Matrix2d& projection){
 		streamlog_out(DEBUG1) << " setMeasurementGBL ------------- BEGIN --------------- " << std::endl;
 		TVectorD meas(2);//Remember we need to pass the same 5 since gbl expects this due to jacobian
 		meas.Zero();
@@ -124,9 +124,10 @@ namespace eutelescope {
 		streamlog_out(DEBUG4) << "X:" << std::setw(20) << meas[0] << std::setw(20) << measPrec[0] <<"," << std::endl;
 		streamlog_out(DEBUG4) << "Y:" << std::setw(20) << meas[1] << std::setw(20)  <<"," << measPrec[1] << std::endl;
 		streamlog_out(DEBUG4) << "This H matrix:" << std::endl;
-		streamlog_message( DEBUG0, projection.Print();, std::endl; );
+		streamlog_out( DEBUG0 ) << projection << std::endl;
 		//The gbl library creates 5 measurement vector and 5x5 propagation matrix automatically. If  
-		point.addMeasurement(projection, meas, measPrec, 0);//The last zero is the minimum precision before this is set to 0. TO DO:Remove this magic number
+		TMatrixD proM2l = Utility::toTMatrixD(projection);
+		point.addMeasurement(proM2l, meas, measPrec, 0);//The last zero is the minimum precision before this is set to 0. TO DO:Remove this magic number
 		streamlog_out(DEBUG1) << " setMeasurementsGBL ------------- END ----------------- " << std::endl;
 	}
 
@@ -418,10 +419,10 @@ namespace eutelescope {
 		else ierr = traj->fit( *chi2, *ndf, loss );
 
 		if( ierr != 0 ){
-			streamlog_out(MESSAGE0) << "Fit failed!" << " Track error: "<< ierr << " and chi2: " << *chi2 << std::endl;
+			streamlog_out(DEBUG0) << "Fit failed!" << " Track error: "<< ierr << " and chi2: " << *chi2 << std::endl;
 		}
 		else{
-		streamlog_out(MESSAGE0) << "Fit Successful!" << " Track error; "<< ierr << " and chi2: " << *chi2 << std::endl;
+		streamlog_out(DEBUG0) << "Fit Successful!" << " Track error; "<< ierr << " and chi2: " << *chi2 << std::endl;
 		}
 		streamlog_out ( DEBUG4 ) << " EUTelGBLFitter::computeTrajectoryAndFit -- END " << std::endl;
 	}
@@ -511,22 +512,23 @@ namespace eutelescope {
             streamlog_out(DEBUG1) <<"Distance between states "<<distance << std::endl;
             streamlog_out(DEBUG1) <<"Minimum value of jacobian accepted "<<min << std::endl;
 
-        TMatrixD simpleJacobian = EUTelNav::getPropagationJacobianGlobalToGlobal(distance, momStart.Unit());
+        Matrix5d simpleJacobian = EUTelNav::getPropagationJacobianGlobalToGlobal(distance, momStart.Unit());
         TVector3 momStartLocal = transVecGlobalToLocal(momStart, locationStart);
-        TMatrixD localToGlobalJacobianStart =  EUTelNav::getMeasToGlobal(momStartLocal, locationStart);
+        Matrix5d localToGlobalJacobianStart =  EUTelNav::getMeasToGlobal(momStartLocal, locationStart);
         TVector3 momEndLocal = transVecGlobalToLocal(momEnd, locationEnd);
-        TMatrixD localToGlobalJacobianEnd =  EUTelNav::getMeasToGlobal(momEndLocal,locationEnd );
+        Matrix5d localToGlobalJacobianEnd =  EUTelNav::getMeasToGlobal(momEndLocal,locationEnd );
         streamlog_out( DEBUG0 ) << "Invert local matrix... " << std::endl;
-        TMatrixD globalToLocalJacobianEnd = localToGlobalJacobianEnd.Invert();
+        Matrix5d globalToLocalJacobianEnd = localToGlobalJacobianEnd.inverse();
         streamlog_out( DEBUG0 ) << "Global to local: " << std::endl;
-        streamlog_message( DEBUG0, globalToLocalJacobianEnd.Print();, std::endl; );
-        TMatrixD localToNextLocalJacobian = globalToLocalJacobianEnd*simpleJacobian*localToGlobalJacobianStart;
+        streamlog_out( DEBUG0 ) << globalToLocalJacobianEnd << std::endl;
+        Matrix5d localToNextLocalJacobian = globalToLocalJacobianEnd*simpleJacobian*localToGlobalJacobianStart;
         streamlog_out(DEBUG1) <<"Jacobian before min derivative removal: " << std::endl;
-        streamlog_message( DEBUG1, localToNextLocalJacobian.Print();, std::endl; );
+        streamlog_out( DEBUG1 ) << localToNextLocalJacobian << std::endl;
         localToNextLocalJacobian = Utility::setPrecision(localToNextLocalJacobian ,min);
         streamlog_out(DEBUG1) <<"OUTPUT JACOBAIN  " <<locationStart<<"->"<<locationEnd <<":"  << std::endl;
-        streamlog_message( DEBUG1, localToNextLocalJacobian.Print();, std::endl; );
-        return localToNextLocalJacobian;
+        streamlog_out( DEBUG1 ) << localToNextLocalJacobian << std::endl;
+        //GBL points are built from ROOT matrices
+        return Utility::toTMatrixD(localToNextLocalJacobian);
     }
     TVector3 EUTelGBLFitter::transVecGlobalToLocal(TVector3 input, int location){
         double globalVec[] = { input[0],input[1],input[2] };
@@ -554,7 +556,7 @@ namespace eutelescope {
 		}
 		_scattererPositions.push_back(secondScatterPosition);//Z position of 2nd scatterer
 		if(secondScatterPosition > _end){
-			streamlog_out(MESSAGE5) << "The second scatter distance: "<< secondScatterPosition <<". The distance of the arc length: " << _end  << std::endl;
+			streamlog_out(DEBUG5) << "The second scatter distance: "<< secondScatterPosition <<". The distance of the arc length: " << _end  << std::endl;
 			throw(lcio::Exception("The distance of the second scatterer is larger than the next plane. "));
 		}
 		_scattererPositions.push_back(_end-secondScatterPosition); 
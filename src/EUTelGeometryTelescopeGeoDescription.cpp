@@ -9,6 +9,8 @@
 #include <string>
 #include <cstring>
 #include <sstream>
+#include <limits>
+#include <cmath>
 
 // MARLIN
 #include "marlin/Global.h"
@@ -35,8 +37,6 @@
 #include "TMath.h"
 #include "TError.h"
 
-#define  SCATTER_IDENTIFIER 314
-
 using namespace eutelescope;
 using namespace geo;
 
@@ -48,14 +48,16 @@ EUTelGeometryTelescopeGeoDescription& EUTelGeometryTelescopeGeoDescription::getI
 	static  EUTelGeometryTelescopeGeoDescription instance;
 	unsigned i = EUTelGeometryTelescopeGeoDescription::_counter;
 	
-	//do it only once!
+	//do it only once! Only this first call writes the counter, later
+	//calls only read it. The threads of EUTelThreadPool get the
+	//geometry through here, after it was set up on the main thread.
 	if( i < 1 )
 	{
 		instance.setGearManager(_g);
 		instance.readGear();
+		instance.counter();
 	}
 	
-	instance.counter();
 	return instance;
 }
 
@@ -164,6 +166,8 @@ void EUTelGeometryTelescopeGeoDescription::initialisePlanesToExcluded(IntVec pla
 	}else{
 			streamlog_out(DEBUG0) <<"The correct number of planes have been excluded" << std::endl;
 	}
+	//the split of the material between planes and air depends on the excluded planes
+	clearMaterialBudgetCache();
 }
 
 /** Sensor ID vector ordered according to their position along the Z axis (beam axis)
@@ -383,8 +387,17 @@ _sensorZOrderToIDMap(),
 _sensorIDtoZOrderMap(),
 _nPlanes(0),
 _isGeoInitialized(false),
+_planeTransforms(),
+_planeTransformSlot(),
+_useAnalyticNavigation(false),
+_useMaterialBudgetCache(false),
+_materialBudgetBinSize(1.),
+_materialBudgetCache(),
+_tgeoMutex(),
 _geoManager(nullptr)
 {
+	pthread_mutex_init( &_tgeoMutex, NULL );
+
 	//Set ROOTs verbosity to only display error messages or higher (so info will not be streamed to stderr)
 	gErrorIgnoreLevel =  kError;  
 
@@ -440,6 +453,7 @@ EUTelGeometryTelescopeGeoDescription::~EUTelGeometryTelescopeGeoDescription()
 {
 	delete _geoManager;
 	delete _pixGeoMgr;
+	pthread_mutex_destroy( &_tgeoMutex );
 }
 
 /**
@@ -448,6 +462,10 @@ EUTelGeometryTelescopeGeoDescription::~EUTelGeometryTelescopeGeoDescription()
  */
 void EUTelGeometryTelescopeGeoDescription::initializeTGeoDescription( std::string tgeofilename ) {
     
+    invalidatePlaneTransforms();
+    clearMaterialBudgetCache();
+    //shapes of an imported geometry are unknown, navigate through TGeo
+    _useAnalyticNavigation = false;
     _geoManager = TGeoManager::Import( tgeofilename.c_str() );
     if( !_geoManager ) {
         streamlog_out( WARNING ) << "Can't read file " << tgeofilename << std::endl;
@@ -663,6 +681,10 @@ void EUTelGeometryTelescopeGeoDescription::initializeTGeoDescription( std::strin
    } // loop over sensorID
 
     _geoManager->CloseGeometry();
+    invalidatePlaneTransforms();
+    clearMaterialBudgetCache();
+    //all sensors are boxes built from GEAR, intersections can be computed directly
+    _useAnalyticNavigation = true;
     _isGeoInitialized = true;
     // Dump ROOT TGeo object into file
     if ( dumpRoot ) _geoManager->Export( geomName.c_str() );
@@ -770,6 +792,62 @@ int EUTelGeometryTelescopeGeoDescription::getSensorIDFromManager()  {
 	return sensorID;
 }
 
+/**
+ * Cached local-to-global transformation of the sensor with a given sensorID.
+ * The 3x4 matrix is read from the TGeo node on first use and stored as the
+ * row-major rotation followed by the translation in a flat array.
+ *
+ * @param sensorID Id of the sensor
+ * @return pointer to 12 doubles: r00,r01,r02,r10,...,r22,tx,ty,tz
+ */
+const double* EUTelGeometryTelescopeGeoDescription::getPlaneTransform( int sensorID ) {
+    if( sensorID < 0 ) {
+        throw eutelescope::InvalidGeometryException("No transformation available for a negative sensor ID");
+    }
+
+    size_t id = static_cast<size_t>( sensorID );
+    if( id >= _planeTransformSlot.size() ) {
+        _planeTransformSlot.resize( id+1, -1 );
+    }
+
+    if( _planeTransformSlot[id] < 0 ) {
+        std::map<int, std::string>::const_iterator pathIt = _planePath.find( sensorID );
+        if( pathIt == _planePath.end() ) {
+            streamlog_out( ERROR5 ) << "No TGeo volume for sensor " << sensorID << std::endl;
+            throw eutelescope::InvalidGeometryException("Requested transformation of an unknown sensor");
+        }
+
+        _geoManager->cd( pathIt->second.c_str() );
+        const TGeoMatrix* matrix = _geoManager->GetCurrentNode()->GetMatrix();
+        const double* rotation = matrix->GetRotationMatrix();
+        const double* translation = matrix->GetTranslation();
+
+        _planeTransformSlot[id] = static_cast<int>( _planeTransforms.size()/12 );
+        _planeTransforms.insert( _planeTransforms.end(), rotation, rotation+9 );
+        _planeTransforms.insert( _planeTransforms.end(), translation, translation+3 );
+    }
+
+    return &_planeTransforms[ 12*_planeTransformSlot[id] ];
+}
+
+/**
+ * Drop all cached plane transformations, they are rebuilt from TGeo on next use.
+ */
+void EUTelGeometryTelescopeGeoDescription::invalidatePlaneTransforms() {
+    _planeTransforms.clear();
+    _planeTransformSlot.clear();
+}
+
+/**
+ * Fill the transformation cache for every sensor, so later lookups do not
+ * touch TGeo or resize the cache.
+ */
+void EUTelGeometryTelescopeGeoDescription::cacheAllPlaneTransforms() {
+    for( std::vector<int>::const_iterator it = _sensorIDVec.begin(); it != _sensorIDVec.end(); ++it ) {
+        getPlaneTransform( *it );
+    }
+}
+
 /**
  * Coordinate transformation from local reference frame of sensor with a given sensorID
  * to the global coordinate system
@@ -779,8 +857,7 @@ int EUTelGeometryTelescopeGeoDescription::getSensorIDFromManager()  {
  * @param globalPos (x,y,z) in global coordinate system
  */
 void EUTelGeometryTelescopeGeoDescription::local2Master( int sensorID, const double localPos[], double globalPos[] ) {
-    _geoManager->cd( _planePath[sensorID].c_str() );
-    _geoManager->GetCurrentNode()->LocalToMaster( localPos, globalPos );
+    local2MasterBatch( sensorID, localPos, globalPos, 1 );
 }
 
 /**
@@ -792,8 +869,7 @@ void EUTelGeometryTelescopeGeoDescription::local2Master( int sensorID, const dou
  * @param localPos (x,y,z) in local coordinate system
  */
 void EUTelGeometryTelescopeGeoDescription::master2Local(int sensorID, const double globalPos[], double localPos[] ) {
-    _geoManager->cd( _planePath[sensorID].c_str() );
-    _geoManager->GetCurrentNode()->MasterToLocal( globalPos, localPos );
+    master2LocalBatch( sensorID, globalPos, localPos, 1 );
 }
 
 /**
@@ -804,8 +880,11 @@ void EUTelGeometryTelescopeGeoDescription::master2Local(int sensorID, const doub
  * @param localVec (x,y,z) in local coordinate system
  */
 void EUTelGeometryTelescopeGeoDescription::local2MasterVec( int sensorID, const double localVec[], double globalVec[] ) {
-    _geoManager->cd( _planePath[sensorID].c_str() );
-    _geoManager->GetCurrentNode()->LocalToMasterVect( localVec, globalVec );
+    const double* t = getPlaneTransform( sensorID );
+    const double x = localVec[0], y = localVec[1], z = localVec[2];
+    globalVec[0] = t[0]*x + t[1]*y + t[2]*z;
+    globalVec[1] = t[3]*x + t[4]*y + t[5]*z;
+    globalVec[2] = t[6]*x + t[7]*y + t[8]*z;
 }
 
 
@@ -817,10 +896,59 @@ void EUTelGeometryTelescopeGeoDescription::local2MasterVec( int sensorID, const
  * @param localVec (x,y,z) in local coordinate system
  */
 void EUTelGeometryTelescopeGeoDescription::master2LocalVec( int sensorID, const double globalVec[], double localVec[] ) {
-    
-    _geoManager->cd( _planePath[sensorID].c_str() );
-    _geoManager->GetCurrentNode()->MasterToLocalVect( globalVec, localVec );
+    const double* t = getPlaneTransform( sensorID );
+    const double x = globalVec[0], y = globalVec[1], z = globalVec[2];
+    localVec[0] = t[0]*x + t[3]*y + t[6]*z;
+    localVec[1] = t[1]*x + t[4]*y + t[7]*z;
+    localVec[2] = t[2]*x + t[5]*y + t[8]*z;
+}
 
+/**
+ * Coordinate transformation of many points on the same sensor from its local
+ * reference frame to the global coordinate system.
+ * 
+ * @param sensorID Id of the sensor (specifies local coordinate system)
+ * @param localPos nPoints consecutive (x,y,z) triplets in local coordinate system
+ * @param globalPos nPoints consecutive (x,y,z) triplets in global coordinate system
+ * @param nPoints number of points to transform
+ */
+void EUTelGeometryTelescopeGeoDescription::local2MasterBatch( int sensorID, const double* localPos, double* globalPos, size_t nPoints ) {
+    const double* t = getPlaneTransform( sensorID );
+    const double r00 = t[0], r01 = t[1], r02 = t[2];
+    const double r10 = t[3], r11 = t[4], r12 = t[5];
+    const double r20 = t[6], r21 = t[7], r22 = t[8];
+    const double tx = t[9], ty = t[10], tz = t[11];
+
+    for( size_t i = 0; i < nPoints; ++i ) {
+        const double x = localPos[3*i], y = localPos[3*i+1], z = localPos[3*i+2];
+        globalPos[3*i]   = tx + r00*x + r01*y + r02*z;
+        globalPos[3*i+1] = ty + r10*x + r11*y + r12*z;
+        globalPos[3*i+2] = tz + r20*x + r21*y + r22*z;
+    }
+}
+
+/**
+ * Coordinate transformation of many points from the global coordinate system
+ * to the local reference frame of the same sensor.
+ * 
+ * @param sensorID Id of the sensor (specifies local coordinate system)
+ * @param globalPos nPoints consecutive (x,y,z) triplets in global coordinate system
+ * @param localPos nPoints consecutive (x,y,z) triplets in local coordinate system
+ * @param nPoints number of points to transform
+ */
+void EUTelGeometryTelescopeGeoDescription::master2LocalBatch( int sensorID, const double* globalPos, double* localPos, size_t nPoints ) {
+    const double* t = getPlaneTransform( sensorID );
+    const double r00 = t[0], r01 = t[1], r02 = t[2];
+    const double r10 = t[3], r11 = t[4], r12 = t[5];
+    const double r20 = t[6], r21 = t[7], r22 = t[8];
+    const double tx = t[9], ty = t[10], tz = t[11];
+
+    for( size_t i = 0; i < nPoints; ++i ) {
+        const double x = globalPos[3*i] - tx, y = globalPos[3*i+1] - ty, z = globalPos[3*i+2] - tz;
+        localPos[3*i]   = r00*x + r10*y + r20*z;
+        localPos[3*i+1] = r01*x + r11*y + r21*z;
+        localPos[3*i+2] = r02*x + r12*y + r22*z;
+    }
 }
 
 /**
@@ -1038,6 +1166,131 @@ float EUTelGeometryTelescopeGeoDescription::calculateTotalRadiationLengthAndWeig
 	streamlog_out(DEBUG1) << "calculateTotalRadiationLength()------------------------------END" <<std::endl;
 
 }
+/**
+ * Radiation length from a point on a plane to the end of the telescope along the beam axis.
+ * With the material budget cache switched on the values are bilinearly interpolated
+ * between exact results on a grid of transverse positions per plane. Where the grid
+ * points around the point do not cross the same planes (sensor edges) or a grid point
+ * has no valid result, the exact tracing is used.
+ *
+ * @param planeID the plane the point is located on
+ * @param start starting point in the global coordinate system
+ * @param end ending point in the global coordinate system
+ * @return total radiation length in units of X0, 0 if the track should be dropped
+ */
+float EUTelGeometryTelescopeGeoDescription::getRadiationLengthsToEnd( int planeID, const double start[3], const double end[3], std::map<const int,double>& mapSensor, std::map<const int,double>& mapAir ) {
+	pthread_mutex_lock( &_tgeoMutex );
+	float total = 0.;
+	try
+	{
+		total = getRadiationLengthsToEndLocked( planeID, start, end, mapSensor, mapAir );
+	}
+	catch(...)
+	{
+		pthread_mutex_unlock( &_tgeoMutex );
+		throw;
+	}
+	pthread_mutex_unlock( &_tgeoMutex );
+	return total;
+}
+
+/**
+ * Implementation of getRadiationLengthsToEnd, the caller holds _tgeoMutex.
+ */
+float EUTelGeometryTelescopeGeoDescription::getRadiationLengthsToEndLocked( int planeID, const double start[3], const double end[3], std::map<const int,double>& mapSensor, std::map<const int,double>& mapAir ) {
+	if( !_useMaterialBudgetCache || _materialBudgetBinSize <= 0. )
+	{
+		return calculateTotalRadiationLengthAndWeights( start, end, mapSensor, mapAir );
+	}
+
+	const double u = start[0]/_materialBudgetBinSize;
+	const double v = start[1]/_materialBudgetBinSize;
+	const int ix = static_cast<int>( std::floor(u) );
+	const int iy = static_cast<int>( std::floor(v) );
+	const double fu = u - ix;
+	const double fv = v - iy;
+
+	const MaterialBudgetNode* nodes[4] = { &getMaterialBudgetNode( planeID, ix, iy ), &getMaterialBudgetNode( planeID, ix+1, iy ),
+					       &getMaterialBudgetNode( planeID, ix, iy+1 ), &getMaterialBudgetNode( planeID, ix+1, iy+1 ) };
+	const double weights[4] = { (1.-fu)*(1.-fv), fu*(1.-fv), (1.-fu)*fv, fu*fv };
+
+	//interpolation only makes sense if all grid points see the same material layout
+	for( int n = 0; n < 4; ++n )
+	{
+		if( nodes[n]->total == 0. || nodes[n]->sensor.size() != nodes[0]->sensor.size() || nodes[n]->air.size() != nodes[0]->air.size() 
+		    || !std::equal( nodes[n]->sensor.begin(), nodes[n]->sensor.end(), nodes[0]->sensor.begin(), sameMaterialBudgetKey )
+		    || !std::equal( nodes[n]->air.begin(), nodes[n]->air.end(), nodes[0]->air.begin(), sameMaterialBudgetKey ) )
+		{
+			return calculateTotalRadiationLengthAndWeights( start, end, mapSensor, mapAir );
+		}
+	}
+
+	double total = 0.;
+	for( int n = 0; n < 4; ++n )
+	{
+		total += weights[n]*nodes[n]->total;
+	}
+	for( std::map<const int,double>::const_iterator it = nodes[0]->sensor.begin(); it != nodes[0]->sensor.end(); ++it )
+	{
+		double value = 0.;
+		for( int n = 0; n < 4; ++n ) value += weights[n]*nodes[n]->sensor.find(it->first)->second;
+		mapSensor[it->first] = value;
+	}
+	for( std::map<const int,double>::const_iterator it = nodes[0]->air.begin(); it != nodes[0]->air.end(); ++it )
+	{
+		double value = 0.;
+		for( int n = 0; n < 4; ++n ) value += weights[n]*nodes[n]->air.find(it->first)->second;
+		mapAir[it->first] = value;
+	}
+	return static_cast<float>( total );
+}
+
+/**
+ * Exact material budget at a grid point of the given plane, traced on first request.
+ * The start point is placed on the mid-plane of the sensor at the grid position.
+ */
+const EUTelGeometryTelescopeGeoDescription::MaterialBudgetNode& EUTelGeometryTelescopeGeoDescription::getMaterialBudgetNode( int planeID, int ix, int iy ) {
+	MaterialBudgetKey key = std::make_pair( planeID, std::make_pair( ix, iy ) );
+	std::map<MaterialBudgetKey, MaterialBudgetNode>::iterator it = _materialBudgetCache.find( key );
+	if( it != _materialBudgetCache.end() ) return it->second;
+
+	it = _materialBudgetCache.insert( std::make_pair( key, MaterialBudgetNode() ) ).first;
+	MaterialBudgetNode& node = it->second;
+
+	const double x = ix*_materialBudgetBinSize;
+	const double y = iy*_materialBudgetBinSize;
+	TVector3 norm = siPlaneNormal( planeID );
+	double z = siPlaneZPosition( planeID );
+	if( std::fabs(norm[2]) > 1e-12 )
+	{
+		z -= ( norm[0]*(x - siPlaneXPosition(planeID)) + norm[1]*(y - siPlaneYPosition(planeID)) )/norm[2];
+	}
+
+	const double start[] = { x, y, z-0.025 };
+	const double end[]   = { x, y, z+0.025 };
+	node.total = calculateTotalRadiationLengthAndWeights( start, end, node.sensor, node.air );
+	return node;
+}
+
+/**
+ * Switch the material budget cache on or off and set its grid spacing [mm].
+ */
+void EUTelGeometryTelescopeGeoDescription::setMaterialBudgetCache( bool useCache, double binSize ) {
+	_useMaterialBudgetCache = useCache;
+	if( binSize != _materialBudgetBinSize )
+	{
+		_materialBudgetBinSize = binSize;
+		clearMaterialBudgetCache();
+	}
+}
+
+/**
+ * Drop all cached material budget grid points.
+ */
+void EUTelGeometryTelescopeGeoDescription::clearMaterialBudgetCache() {
+	_materialBudgetCache.clear();
+}
+
 //This function wil not add kapton to excluded planes.
 //TO DO: The found planes will be different from the excluded. Since sometimes we will miss a plane if there are two DUT for example. Must keep a note of these since we will be still adding radiation length incorrectly if not accounted for. These track are removed at the moment since some entries of radiation length will zero.
 double EUTelGeometryTelescopeGeoDescription::addKapton(std::map<const int, double> & mapSensor){
@@ -1111,10 +1364,140 @@ void EUTelGeometryTelescopeGeoDescription::mapWeightsToSensor(std::map<const int
 		}
 	}
 }
+/**
+ * Intersection of a straight line with the box of a sensor.
+ * The line is transformed into the local frame of the sensor, where the
+ * box is axis aligned, and clipped against the three slabs.
+ *
+ * @param sensorID Id of the sensor
+ * @param globalPos starting point of the line in global coordinates
+ * @param globalDir direction of the line in global coordinates
+ * @param tEnter line parameter at which the line enters the box
+ * @param tExit line parameter at which the line leaves the box
+ * @return false if the line misses the box
+ */
+bool EUTelGeometryTelescopeGeoDescription::intersectPlaneBox( int sensorID, const double globalPos[], const double globalDir[], double& tEnter, double& tExit ) {
+	double localPos[3];
+	double localDir[3];
+	master2Local( sensorID, globalPos, localPos );
+	master2LocalVec( sensorID, globalDir, localDir );
+
+	const double halfSize[3] = { siPlaneXSize(sensorID)/2., siPlaneYSize(sensorID)/2., siPlaneZSize(sensorID)/2. };
+
+	tEnter = -std::numeric_limits<double>::max();
+	tExit  =  std::numeric_limits<double>::max();
+	for( int k = 0; k < 3; ++k )
+	{
+		if( std::fabs(localDir[k]) < 1e-12 )
+		{
+			//parallel to this slab, either always or never inside
+			if( std::fabs(localPos[k]) > halfSize[k] ) return false;
+			continue;
+		}
+		double t1 = (-halfSize[k] - localPos[k])/localDir[k];
+		double t2 = ( halfSize[k] - localPos[k])/localDir[k];
+		if( t1 > t2 ) std::swap( t1, t2 );
+		if( t1 > tEnter ) tEnter = t1;
+		if( t2 < tExit )  tExit  = t2;
+		if( tEnter > tExit ) return false;
+	}
+	return true;
+}
+
+/**
+ * Check if a global point lies inside the box of a given sensor.
+ *
+ * @param sensorID Id of the sensor
+ * @param globalPos (x,y,z) in global coordinate system
+ */
+bool EUTelGeometryTelescopeGeoDescription::isPointInsidePlane( int sensorID, const double globalPos[] ) {
+	double localPos[3];
+	master2Local( sensorID, globalPos, localPos );
+	return std::fabs(localPos[0]) <= siPlaneXSize(sensorID)/2. 
+		&& std::fabs(localPos[1]) <= siPlaneYSize(sensorID)/2. 
+		&& std::fabs(localPos[2]) <= siPlaneZSize(sensorID)/2.;
+}
+
 //
 // straight line - shashlyk plane assembler
 //
 int EUTelGeometryTelescopeGeoDescription::findNextPlane(  double* lpoint,  double* ldir, float* newpoint ){
+	if( !_useAnalyticNavigation )
+	{
+		return findNextPlaneTGeo( lpoint, ldir, newpoint );
+	}
+	if(newpoint==NULL)
+	{
+		throw(lcio::Exception("You have passed a NULL pointer to findNextPlane.")); 	
+	}
+	//Here we set the normalised direction, the caller gets it back normalised as with the TGeo stepping
+	double normdir = TMath::Sqrt(ldir[0]*ldir[0]+ldir[1]*ldir[1]+ldir[2]*ldir[2]); 
+	ldir[0] = ldir[0]/normdir; 
+	ldir[1] = ldir[1]/normdir; 
+	ldir[2] = ldir[2]/normdir;
+
+	//the plane we start in is not a candidate, all others are intersected and the closest one ahead wins
+	int nextSensorID = -100;
+	double tNext = std::numeric_limits<double>::max();
+	for( std::vector<int>::const_iterator it = _sensorIDVec.begin(); it != _sensorIDVec.end(); ++it )
+	{
+		double tEnter, tExit;
+		if( !intersectPlaneBox( *it, lpoint, ldir, tEnter, tExit ) ) continue;
+		if( tEnter <= 0. ) continue;
+		if( tEnter < tNext )
+		{
+			tNext = tEnter;
+			nextSensorID = *it;
+		}
+	}
+
+	if( nextSensorID < 0 ) return nextSensorID;
+
+	for(int ip=0;ip<3;ip++) 
+	{
+		newpoint[ip] = static_cast<float>( lpoint[ip] + tNext*ldir[ip] );
+	}
+	newpoint[2] += 0.01; // step into the new volume as done by the TGeo stepping
+	streamlog_out( DEBUG0 ) << "::findNextPlane next sensorID: " << nextSensorID << " at " << newpoint[0] << " " << newpoint[1] << " " << newpoint[2] << std::endl;
+	return nextSensorID;
+}
+
+//This will take in a global coordinate and direction and output the new global point on the next sensor. 
+bool EUTelGeometryTelescopeGeoDescription::findNextPlaneEntrance(  TVector3 lpoint,  TVector3 ldir, int nextSensorID, float* newpoint ){
+	if( !_useAnalyticNavigation )
+	{
+		return findNextPlaneEntranceTGeo( lpoint, ldir, nextSensorID, newpoint );
+	}
+	if(newpoint==NULL)
+	{
+		throw(lcio::Exception("You have passed a NULL pointer to findNextPlane.")); 	
+	}
+
+	const double dlPoint[3] = { lpoint[0], lpoint[1], lpoint[2] };
+	TVector3 unitDir = ldir.Unit();
+	const double dlDir[3] = { unitDir[0], unitDir[1], unitDir[2] };
+
+	//only entrances ahead of the starting point are accepted
+	double tEnter, tExit;
+	if( !intersectPlaneBox( nextSensorID, dlPoint, dlDir, tEnter, tExit ) || tEnter < 0. )
+	{
+		return false;
+	}
+
+	for(int ip=0;ip<3;ip++) 
+	{
+		newpoint[ip] = static_cast<float>( dlPoint[ip] + tEnter*dlDir[ip] );
+	}
+	newpoint[2] += 0.001; // step by one um into the new volume as done by the TGeo stepping
+	streamlog_out( DEBUG0 ) << "findNextPlaneEntrance sensorID: " << nextSensorID << " at " << newpoint[0] << " " << newpoint[1] << " " << newpoint[2] << std::endl;
+	return true;
+}
+
+
+//
+// TGeo stepping fallback for geometries not built from GEAR boxes
+//
+int EUTelGeometryTelescopeGeoDescription::findNextPlaneTGeo(  double* lpoint,  double* ldir, float* newpoint ){
 	if(newpoint==NULL)
 	{
 		throw(lcio::Exception("You have passed a NULL pointer to findNextPlane.")); 	
@@ -1172,7 +1555,7 @@ int EUTelGeometryTelescopeGeoDescription::findNextPlane(  double* lpoint,  doubl
 	return -100;
 }
 //This will take in a global coordinate and direction and output the new global point on the next sensor. 
-bool EUTelGeometryTelescopeGeoDescription::findNextPlaneEntrance(  TVector3 lpoint,  TVector3 ldir, int nextSensorID, float* newpoint ){
+bool EUTelGeometryTelescopeGeoDescription::findNextPlaneEntranceTGeo(  TVector3 lpoint,  TVector3 ldir, int nextSensorID, float* newpoint ){
 	streamlog_out(DEBUG5) << "EUTelGeometryTelescopeGeoDescription::findNextPlaneEntrance()------BEGIN" << std::endl;
 	if(newpoint==NULL)
 	{
@@ -1241,6 +1624,9 @@ bool EUTelGeometryTelescopeGeoDescription::findNextPlaneEntrance(  TVector3 lpoi
 void EUTelGeometryTelescopeGeoDescription::updateSiPlanesLayout() {
  streamlog_out( MESSAGE1 ) << "EUTelGeometryTelescopeGeoDescription::updateSiPlanesLayout() --- START ---- " << std::endl;
 
+    invalidatePlaneTransforms();
+    clearMaterialBudgetCache();
+
     gear::SiPlanesParameters*    siplanesParameters = const_cast< gear::SiPlanesParameters*> (&( _gearManager->getSiPlanesParameters()));
     gear::SiPlanesLayerLayout*  siplanesLayerLayout = const_cast< gear::SiPlanesLayerLayout*> (&(_siPlanesParameters->getSiPlanesLayerLayout()));
 
@@ -1275,6 +1661,9 @@ void EUTelGeometryTelescopeGeoDescription::updateTrackerPlanesLayout() {
 
     streamlog_out( MESSAGE1 ) << "EUTelGeometryTelescopeGeoDescription::updateTrackerPlanesLayout() --- START ---- " << std::endl;
 
+    invalidatePlaneTransforms();
+    clearMaterialBudgetCache();
+
     gear::TrackerPlanesParameters*  trackerplanesParameters  = const_cast< gear::TrackerPlanesParameters*>  (&( _gearManager->getTrackerPlanesParameters() ));
     gear::TrackerPlanesLayerLayout* trackerplanesLayerLayout = const_cast< gear::TrackerPlanesLayerLayout*> (&(  trackerplanesParameters->getTrackerPlanesLayerLayout() ));
     
@@ -0,0 +1,190 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelHotPixelMask.h"
+#include "EUTELESCOPE.h"
+#include "EUTelGenericSparsePixel.h"
+#include "EUTelSparseClusterImpl.h"
+#include "EUTelTrackerDataInterfacerImpl.h"
+#include "EUTelGeometryTelescopeGeoDescription.h"
+#include "EUTelGenericPixGeoDescr.h"
+
+// marlin includes ".h"
+#include "marlin/Global.h"
+
+// lcio includes <.h>
+#include <Exceptions.h>
+#include <IMPL/LCCollectionVec.h>
+#include <IMPL/TrackerDataImpl.h>
+#include <UTIL/CellIDDecoder.h>
+
+// system includes <>
+#include <algorithm>
+#include <exception>
+#include <map>
+#include <memory>
+#include <utility>
+
+using namespace eutelescope;
+
+EUTelHotPixelMask::EUTelHotPixelMask() :
+  _sensorMasks(),
+  _nMaskedPixels(0)
+{
+}
+
+void EUTelHotPixelMask::clear() {
+  _sensorMasks.clear();
+  _nMaskedPixels = 0;
+}
+
+bool EUTelHotPixelMask::load( EVENT::LCEvent* event, const std::string& hotPixelCollectionName ) {
+  clear();
+
+  IMPL::LCCollectionVec* hotPixelCollectionVec = NULL;
+  try {
+    hotPixelCollectionVec = static_cast< IMPL::LCCollectionVec* >( event->getCollection( hotPixelCollectionName ) );
+  }
+  catch( lcio::DataNotAvailableException& ) {
+    return false;
+  }
+
+  UTIL::CellIDDecoder<IMPL::TrackerDataImpl> cellDecoder( hotPixelCollectionVec );
+
+  // collect the pixels first, so the mask of every sensor is allocated once
+  std::map< int, std::vector< std::pair<int, int> > > pixelsPerSensor;
+  for( int i = 0; i < hotPixelCollectionVec->getNumberOfElements(); i++ ) {
+    IMPL::TrackerDataImpl* hotPixelData = dynamic_cast< IMPL::TrackerDataImpl* >( hotPixelCollectionVec->getElementAt( i ) );
+    SparsePixelType type = static_cast<SparsePixelType>( static_cast<int>( cellDecoder( hotPixelData )["sparsePixelType"] ) );
+    int sensorID = static_cast<int>( cellDecoder( hotPixelData )["sensorID"] );
+
+    if( type != kEUTelGenericSparsePixel ) {
+      streamlog_out( WARNING2 ) << "Hot pixels of sensor " << sensorID << " are of unsupported type " << type << " and are not masked" << std::endl;
+      continue;
+    }
+
+    std::auto_ptr< EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel> > sparseData( new EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel>( hotPixelData ) );
+    std::vector< std::pair<int, int> >& pixels = pixelsPerSensor[sensorID];
+    pixels.reserve( pixels.size() + sparseData->size() );
+    EUTelGenericSparsePixel pixel;
+    for( unsigned int iPixel = 0; iPixel < sparseData->size(); iPixel++ ) {
+      sparseData->getSparsePixelAt( iPixel, &pixel );
+      pixels.push_back( std::make_pair( static_cast<int>( pixel.getXCoord() ), static_cast<int>( pixel.getYCoord() ) ) );
+    }
+  }
+
+  for( std::map< int, std::vector< std::pair<int, int> > >::const_iterator it = pixelsPerSensor.begin(); it != pixelsPerSensor.end(); ++it ) {
+    const std::vector< std::pair<int, int> >& pixels = it->second;
+    if( pixels.empty() ) continue;
+
+    int minX = pixels.front().first, maxX = minX;
+    int minY = pixels.front().second, maxY = minY;
+    for( size_t i = 1; i < pixels.size(); i++ ) {
+      minX = std::min( minX, pixels[i].first );
+      maxX = std::max( maxX, pixels[i].first );
+      minY = std::min( minY, pixels[i].second );
+      maxY = std::max( maxY, pixels[i].second );
+    }
+
+    // the full sensor is covered when its pixel geometry is known
+    try {
+      int geoMinX = 0, geoMaxX = 0, geoMinY = 0, geoMaxY = 0;
+      geo::gGeometry().getPixGeoDescr( it->first )->getPixelIndexRange( geoMinX, geoMaxX, geoMinY, geoMaxY );
+      minX = std::min( minX, geoMinX );
+      maxX = std::max( maxX, geoMaxX );
+      minY = std::min( minY, geoMinY );
+      maxY = std::max( maxY, geoMaxY );
+    }
+    catch( std::exception& ) {
+      streamlog_out( DEBUG2 ) << "No pixel geometry for sensor " << it->first << ", the hot pixel mask covers the masked pixels only" << std::endl;
+    }
+
+    reserveRange( it->first, minX, maxX, minY, maxY );
+    for( size_t i = 0; i < pixels.size(); i++ ) {
+      maskPixel( it->first, pixels[i].first, pixels[i].second );
+    }
+  }
+
+  streamlog_out( DEBUG5 ) << "Loaded " << _nMaskedPixels << " hot pixels from " << hotPixelCollectionName << std::endl;
+  return true;
+}
+
+void EUTelHotPixelMask::maskPixel( int sensorID, int x, int y ) {
+  if( sensorID < 0 ) {
+    streamlog_out( WARNING2 ) << "Can not mask pixel " << x << "," << y << " of sensor " << sensorID << std::endl;
+    return;
+  }
+  reserveRange( sensorID, x, x, y, y );
+
+  SensorMask& sensorMask = _sensorMasks[sensorID];
+  std::vector<bool>::reference bit = sensorMask.bits[ static_cast<size_t>( y - sensorMask.minY ) * sensorMask.nX + ( x - sensorMask.minX ) ];
+  if( !bit ) {
+    bit = true;
+    ++_nMaskedPixels;
+  }
+}
+
+void EUTelHotPixelMask::reserveRange( int sensorID, int minX, int maxX, int minY, int maxY ) {
+  if( static_cast<size_t>( sensorID ) >= _sensorMasks.size() ) {
+    _sensorMasks.resize( sensorID + 1 );
+  }
+
+  SensorMask& sensorMask = _sensorMasks[sensorID];
+  if( sensorMask.nX > 0 ) {
+    const int oldMaxX = sensorMask.minX + sensorMask.nX - 1;
+    const int oldMaxY = sensorMask.minY + sensorMask.nY - 1;
+    if( minX >= sensorMask.minX && maxX <= oldMaxX && minY >= sensorMask.minY && maxY <= oldMaxY ) return;
+    minX = std::min( minX, sensorMask.minX );
+    maxX = std::max( maxX, oldMaxX );
+    minY = std::min( minY, sensorMask.minY );
+    maxY = std::max( maxY, oldMaxY );
+  }
+
+  SensorMask resized;
+  resized.minX = minX;
+  resized.minY = minY;
+  resized.nX = maxX - minX + 1;
+  resized.nY = maxY - minY + 1;
+  resized.bits.assign( static_cast<size_t>( resized.nX ) * resized.nY, false );
+  for( int iy = 0; iy < sensorMask.nY; iy++ ) {
+    for( int ix = 0; ix < sensorMask.nX; ix++ ) {
+      if( sensorMask.bits[ static_cast<size_t>( iy ) * sensorMask.nX + ix ] ) {
+        resized.bits[ static_cast<size_t>( iy + sensorMask.minY - minY ) * resized.nX + ( ix + sensorMask.minX - minX ) ] = true;
+      }
+    }
+  }
+  std::swap( sensorMask.minX, resized.minX );
+  std::swap( sensorMask.minY, resized.minY );
+  std::swap( sensorMask.nX, resized.nX );
+  std::swap( sensorMask.nY, resized.nY );
+  sensorMask.bits.swap( resized.bits );
+}
+
+bool EUTelHotPixelMask::hitContainsMaskedPixel( const IMPL::TrackerHitImpl* hit ) const {
+  if( empty() || hit == NULL || hit->getType() != kEUTelSparseClusterImpl ) return false;
+
+  const EVENT::LCObjectVec& clusterVector = hit->getRawHits();
+  if( clusterVector.empty() ) return false;
+
+  IMPL::TrackerDataImpl* clusterFrame = dynamic_cast< IMPL::TrackerDataImpl* >( clusterVector[0] );
+  if( clusterFrame == NULL ) {
+    streamlog_out( WARNING2 ) << "Invalid hit found in EUTelHotPixelMask::hitContainsMaskedPixel, it is not masked" << std::endl;
+    return false;
+  }
+
+  EUTelSparseClusterImpl<EUTelGenericSparsePixel> cluster( clusterFrame );
+  const int sensorID = cluster.getDetectorID();
+  EUTelGenericSparsePixel pixel;
+  for( unsigned int iPixel = 0; iPixel < cluster.size(); iPixel++ ) {
+    cluster.getSparsePixelAt( iPixel, &pixel );
+    if( isMasked( sensorID, pixel.getXCoord(), pixel.getYCoord() ) ) return true;
+  }
+  return false;
+}
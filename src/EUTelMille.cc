@@ -611,7 +611,7 @@ void EUTelMille::processRunHeader (LCRunHeader * rdr) {
 void EUTelMille::findtracks2(
                             int missinghits,
                             std::vector<IntVec > &indexarray,
-                            IntVec vec,
+                            IntVec &vec,
                             std::vector<std::vector<EUTelMille::HitsInPlane> > &_allHitsArray,
                             unsigned int i,
                             int y
@@ -632,135 +632,93 @@ void EUTelMille::findtracks2(
     vec.push_back(y); // recall hit id from the plane (i-1)
  }
 
+ const std::vector<EUTelMille::HitsInPlane> &hits = _allHitsArray[i];
+ const bool lastPlane = ( i >= _allHitsArray.size()-1 );
 
- if( (_allHitsArray[i].size() == 0) && (i <_allHitsArray.size()-1) )
+ if( hits.size() == 0 )
  {
-    findtracks2(missinghits,indexarray,vec, _allHitsArray, i+1, -1 ); 
- } 
-
- for(size_t j =0; j < _allHitsArray[i].size(); j++)
+    if( !lastPlane )
     {
-      int ihit = static_cast< int >(j);
-      streamlog_out(DEBUG5) << "ihit:" << ihit << std::endl;
-
-      //if we are not in the last plane, call this method again
-      if(i < _allHitsArray.size()-1)
-        {
-          vec.push_back( ihit); //index of the cluster in the last plane
-         
-          //track candidate requirements
-          bool taketrack = true;
-          const int e = vec.size()-2;
-          if(e >= 0)
-            {
-              double residualX  = -999999.;
-              double residualY  = -999999.;
-              double residualZ  = -999999.;
-
-              // ACTIVE
-              // stop on the last non-zero hit
-
-              // now loop through all hits on a track candidate "vec"
-              // start at the end, stop on the first non-zero hit
-              for(int ivec=e; ivec>=e; --ivec)                  //     <-> OFF
-              {
-                if(vec[ivec]>=0) // non zero hit has id vec[ivec]>=0 {otherwise -1}
-                {
-                  double x = _allHitsArray[ivec][vec[ivec]].measuredX;
-                  double y = _allHitsArray[ivec][vec[ivec]].measuredY;
-                  double z = _allHitsArray[ivec][vec[ivec]].measuredZ;
-                  residualX  = abs(x - _allHitsArray[e+1][vec[e+1]].measuredX);
-                  residualY  = abs(y - _allHitsArray[e+1][vec[e+1]].measuredY);
-                  residualZ  = abs(z - _allHitsArray[e+1][vec[e+1]].measuredZ);
-		  streamlog_out(DEBUG9) << "residuals:" << std::endl;
-		  streamlog_out(DEBUG9) << residualX << std::endl;
-		  streamlog_out(DEBUG9) << residualY << std::endl;
-		  streamlog_out(DEBUG9) << residualZ << std::endl;
-
-                  break; 
-                }   
-              }
-           
-             if ( 
-                   residualX < _residualsXMin[e] || residualX > _residualsXMax[e] ||
-                   residualY < _residualsYMin[e] || residualY > _residualsYMax[e] 
-                 )
-                 taketrack = false;
-
-              if( taketrack == false )
-              {
-                taketrack = true; 
-                ihit=-1;
-              } 
-            }
-          vec.pop_back(); 
-
-          if(taketrack)
-          { 
-              findtracks2(missinghits, indexarray, vec, _allHitsArray, i+1, ihit );
-          }
-        }
-      else
+      findtracks2(missinghits,indexarray,vec, _allHitsArray, i+1, -1 ); 
+    }
+    else if( static_cast< int >(indexarray.size()) < _maxTrackCandidates )
+    {
+      vec.push_back(-1);
+      indexarray.push_back(vec);
+      vec.pop_back();
+    }
+ }
+ else if( lastPlane )
+ {
+    // the residual cuts are not applied to the hits in the last plane
+    for(size_t j =0; j < hits.size(); j++)
+    {
+      if(static_cast< int >(indexarray.size()) >= _maxTrackCandidates) break;
+      vec.push_back( static_cast< int >(j) ); //index of the cluster in the last plane
+      indexarray.push_back(vec);
+      vec.pop_back();
+    }
+    streamlog_out(DEBUG9) << "indexarray size at last plane:" << indexarray.size() << std::endl;
+ }
+ else if( i == 0 )
+ {
+    for(size_t j =0; j < hits.size(); j++)
+    {
+      findtracks2(missinghits, indexarray, vec, _allHitsArray, i+1, static_cast< int >(j) );
+    }
+ }
+ else
+ {
+    // only the hit of the previous plane is compared to,
+    // a hit which fails the cuts makes this plane a missing hit
+    const int e = i-1;
+    size_t nAccepted = 0;
+    if( vec[e] < 0 )
+    {
+      // no hit to compare to, as before the residuals are -999999
+      if( isInResidualWindow( -999999., -999999., e ) )
+      {
+        for(size_t j =0; j < hits.size(); j++)
         {
-          //we are in the last plane
-          vec.push_back( ihit ); //index of the cluster in the last plane
-
-          //track candidate requirements
-          bool taketrack = true;
-          const int e = vec.size()-2;
-          if(e >= 0)
-            {
-              double residualX  = -999999.;
-              double residualY  = -999999.;
-              //double residualZ  = -999999.;
-
-              // now loop through all hits on a track candidate "vec"
-              // start at the end, stop on the first non-zero hit
-              for(int ivec=e; ivec>=e; --ivec)                        //   <-> OFF
-              {
-                if(vec[ivec]>=0) // non zero hit has id vec[ivec]>=0 {otherwise -1}
-                {
-                  double x = _allHitsArray[ivec][vec[ivec]].measuredX;
-                  double y = _allHitsArray[ivec][vec[ivec]].measuredY;
-                  //double z = _allHitsArray[ivec][vec[ivec]].measuredZ;
-                  residualX  = abs(x - _allHitsArray[e+1][vec[e+1]].measuredX);
-                  residualY  = abs(y - _allHitsArray[e+1][vec[e+1]].measuredY);
-                  //residualZ  = abs(z - _allHitsArray[e+1][vec[e+1]].measuredZ);
-                  break; 
-                }   
-              }
-           
-              if ( 
-                   residualX < _residualsXMin[e] || residualX > _residualsXMax[e] ||
-                   residualY < _residualsYMin[e] || residualY > _residualsYMax[e] 
-                 )
-                 taketrack = false;
- 
-              if( taketrack == false )
-              {
-                taketrack = true; 
-                ihit=-1;
-              } 
-            }
-
-          if(static_cast< int >(indexarray.size()) >= _maxTrackCandidates)
-            taketrack = false;
- 
-          if(taketrack)
-            {
-               indexarray.push_back(vec);
-	       streamlog_out(DEBUG9) << "indexarray size at last plane:" << indexarray.size() << std::endl;
-            }
-          vec.pop_back(); //last element must be removed because the
-                          //vector is still used -> we are in a last plane hit loop!
-
+          findtracks2(missinghits, indexarray, vec, _allHitsArray, i+1, static_cast< int >(j) );
         }
+        nAccepted = hits.size();
+      }
     }
+    else
+    {
+      // the hits are sorted in x, only the ones within the x window of the previous hit can pass
+      const EUTelMille::HitsInPlane &previous = _allHitsArray[e][vec[e]];
+      std::vector<EUTelMille::HitsInPlane>::const_iterator first =
+        std::lower_bound( hits.begin(), hits.end(), EUTelMille::HitsInPlane( previous.measuredX - _residualsXMax[e], 0., 0. ), EUTelMille::HitsInPlane::lessMeasuredX );
+      std::vector<EUTelMille::HitsInPlane>::const_iterator last =
+        std::upper_bound( first, hits.end(), EUTelMille::HitsInPlane( previous.measuredX + _residualsXMax[e], 0., 0. ), EUTelMille::HitsInPlane::lessMeasuredX );
+      for( std::vector<EUTelMille::HitsInPlane>::const_iterator hit = first; hit < last; ++hit )
+      {
+        const double residualX = abs( previous.measuredX - hit->measuredX );
+        const double residualY = abs( previous.measuredY - hit->measuredY );
+        if( !isInResidualWindow( residualX, residualY, e ) ) continue;
+        ++nAccepted;
+        findtracks2(missinghits, indexarray, vec, _allHitsArray, i+1, static_cast< int >( hit - hits.begin() ) );
+      }
+    }
+    // all hits failing the cuts lead to the same candidate, it is searched once
+    if( nAccepted < hits.size() )
+    {
+      findtracks2(missinghits, indexarray, vec, _allHitsArray, i+1, -1 );
+    }
+ }
 
-  if( (_allHitsArray[i].size() == 0) && (i >= _allHitsArray.size()-1) )
-  {
-               indexarray.push_back(vec);
-  } 
+ if(i>0)
+ { 
+    vec.pop_back();
+ }
+}
+
+bool EUTelMille::isInResidualWindow(double residualX, double residualY, int e) const
+{
+  return !( residualX < _residualsXMin[e] || residualX > _residualsXMax[e] ||
+            residualY < _residualsYMin[e] || residualY > _residualsYMax[e] );
 }
 
 
@@ -1001,55 +959,10 @@ double residYFit[], double angleFit[2]) {
 
 void  EUTelMille::FillHotPixelMap(LCEvent *event)
 {
-    LCCollectionVec *hotPixelCollectionVec = 0;
-    try 
-    {
-      hotPixelCollectionVec = static_cast< LCCollectionVec* > ( event->getCollection( _hotPixelCollectionName  ) );
-    }
-    catch (...)
+    if( !_hotPixelMask.load( event, _hotPixelCollectionName ) && !_hotPixelCollectionName.empty() )
     {
-      if (!_hotPixelCollectionName.empty())
 	streamlog_out ( WARNING ) << "_hotPixelCollectionName " << _hotPixelCollectionName.c_str() << " not found" << endl; 
-      return;
     }
-
-        CellIDDecoder<TrackerDataImpl> cellDecoder( hotPixelCollectionVec );
-	
-        for(int i=0; i<  hotPixelCollectionVec->getNumberOfElements(); i++)
-        {
-           TrackerDataImpl* hotPixelData = dynamic_cast< TrackerDataImpl *> ( hotPixelCollectionVec->getElementAt( i ) );
-	   SparsePixelType  type         = static_cast<SparsePixelType> (static_cast<int> (cellDecoder( hotPixelData )["sparsePixelType"]));
-
-	   int sensorID              = static_cast<int > ( cellDecoder( hotPixelData )["sensorID"] );
-
-           if( type  ==  kEUTelGenericSparsePixel )
-           {  
-              auto_ptr<EUTelSparseClusterImpl< EUTelGenericSparsePixel > > m26Data( new EUTelSparseClusterImpl< EUTelGenericSparsePixel >   ( hotPixelData ) );
-
-              std::vector<EUTelGenericSparsePixel*> m26PixelVec;
-	      EUTelGenericSparsePixel m26Pixel;
-  	      //Push all single Pixels of one plane in the m26PixelVec
-
-             for ( unsigned int iPixel = 0; iPixel < m26Data->size(); iPixel++ ) 
-             {
-              IntVec m26ColVec();
-              m26Data->getSparsePixelAt( iPixel, &m26Pixel);
-              streamlog_out ( DEBUG3 ) << iPixel << " of " << m26Data->size() << " HotPixelInfo:  " << m26Pixel.getXCoord() << " " << m26Pixel.getYCoord() << " " << m26Pixel.getSignal() << endl;
-              try
-              {
-                 char ix[100];
-                 sprintf(ix, "%d,%d,%d", sensorID, m26Pixel.getXCoord(), m26Pixel.getYCoord() ); 
-                 _hotPixelMap[ix] = true;             
-              }
-              catch(...)
-              {
-                 std::cout << "can not add pixel " << std::endl;
-                 std::cout << sensorID << " " << m26Pixel.getXCoord() << " " << m26Pixel.getYCoord() << " " << std::endl;   
-              }
-             }
-           }
-       }
-
 }
 
 void  EUTelMille::findMatchedHits(int& _ntrack, Track* TrackHere) {
@@ -1288,7 +1201,12 @@ void EUTelMille::processEvent (LCEvent * event) {
     std::vector<IntVec > indexarray;
 
     streamlog_out( DEBUG5 ) << "Event #" << _iEvt << std::endl;
-    findtracks2(0, indexarray, IntVec(), _allHitsArray, 0, 0);
+    for(size_t i = 0; i < _allHitsArray.size(); i++)
+      {
+        std::sort(_allHitsArray[i].begin(), _allHitsArray[i].end(), EUTelMille::HitsInPlane::lessMeasuredX);
+      }
+    IntVec candidate;
+    findtracks2(0, indexarray, candidate, _allHitsArray, 0, 0);
     for(size_t i = 0; i < indexarray.size(); i++)
       {
         for(size_t j = 0; j <  _nPlanes; j++)
@@ -2231,10 +2149,8 @@ else
 
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
 
-        string tempHistoName;
-
         if ( _histogramSwitch ) {
-          if ( AIDA::IHistogram1D* chi2x_histo = dynamic_cast<AIDA::IHistogram1D*>(_aidaHistoMap[_chi2XLocalname]) )
+          if ( AIDA::IHistogram1D* chi2x_histo = _chi2Histos.get( 0, 0 ) )
             chi2x_histo->fill(Chiquare[0]);
           else {
             streamlog_out ( ERROR2 ) << "Not able to retrieve histogram pointer for " << _chi2XLocalname << endl;
@@ -2244,7 +2160,7 @@ else
         }
 
         if ( _histogramSwitch ) {
-          if ( AIDA::IHistogram1D* chi2y_histo = dynamic_cast<AIDA::IHistogram1D*>(_aidaHistoMap[_chi2YLocalname]) )
+          if ( AIDA::IHistogram1D* chi2y_histo = _chi2Histos.get( 0, 1 ) )
             chi2y_histo->fill(Chiquare[1]);
           else {
             streamlog_out ( ERROR2 ) << "Not able to retrieve histogram pointer for " << _chi2YLocalname << endl;
@@ -2257,8 +2173,6 @@ else
         // loop over all detector planes
         for(unsigned int iDetector = 0; iDetector < _nPlanes; iDetector++ ) {
 
-          int sensorID = _orderedSensorID.at( iDetector );
-
           if ( 
               abs(_waferResidX[iDetector]) < 1e-06 &&  
               abs(_waferResidY[iDetector]) < 1e-06 &&  
@@ -2266,66 +2180,23 @@ else
              )   continue;
 
 
-          if ( _histogramSwitch ) {
-            tempHistoName = _residualXLocalname + "_d" + to_string( sensorID );
-            if ( AIDA::IHistogram1D* residx_histo = dynamic_cast<AIDA::IHistogram1D*>(_aidaHistoMap[tempHistoName.c_str()]) )
+          // the histograms are taken from the tables filled in
+          // bookHistos(), the columns follow the X, Y, Z order
+          const double waferResid[3] = { _waferResidX[iDetector], _waferResidY[iDetector], _waferResidZ[iDetector] };
+          for ( int iAxis = 0; iAxis < 3 && _histogramSwitch; iAxis++ ) {
+            if ( AIDA::IHistogram1D* resid_histo = _residualHistos.get( iDetector, iAxis ) )
             {
-                residx_histo->fill(_waferResidX[iDetector]);
+              resid_histo->fill(waferResid[iAxis]);
 
-                tempHistoName = _residualXvsYLocalname + "_d" + to_string( sensorID );
-                AIDA::IProfile1D* residxvsY_histo = dynamic_cast<AIDA::IProfile1D*>(_aidaHistoMapProf1D[tempHistoName.c_str()]) ;
-                residxvsY_histo->fill(_yPosHere[iDetector], _waferResidX[iDetector]);
- 
-                tempHistoName = _residualXvsXLocalname + "_d" + to_string( sensorID );
-                AIDA::IProfile1D* residxvsX_histo = dynamic_cast<AIDA::IProfile1D*>(_aidaHistoMapProf1D[tempHistoName.c_str()]) ;
-                residxvsX_histo->fill(_xPosHere[iDetector], _waferResidX[iDetector]);
-            }
-            else
-            {
-              streamlog_out ( ERROR2 ) << "Not able to retrieve histogram pointer for " << _residualXLocalname << endl;
-              streamlog_out ( ERROR2 ) << "Disabling histogramming from now on" << endl;
-              _histogramSwitch = false;
-            }
-          }
-
-          if ( _histogramSwitch ) {
-            tempHistoName = _residualYLocalname + "_d" + to_string( sensorID );
-            if ( AIDA::IHistogram1D* residy_histo = dynamic_cast<AIDA::IHistogram1D*>(_aidaHistoMap[tempHistoName.c_str()]) )
-            {
-              residy_histo->fill(_waferResidY[iDetector]);
-
-              tempHistoName = _residualYvsYLocalname + "_d" + to_string( sensorID );
-              AIDA::IProfile1D* residyvsY_histo = dynamic_cast<AIDA::IProfile1D*>(_aidaHistoMapProf1D[tempHistoName.c_str()]) ;
-              residyvsY_histo->fill(_yPosHere[iDetector], _waferResidY[iDetector]);
- 
-              tempHistoName = _residualYvsXLocalname + "_d" + to_string( sensorID );
-              AIDA::IProfile1D* residyvsX_histo = dynamic_cast<AIDA::IProfile1D*>(_aidaHistoMapProf1D[tempHistoName.c_str()]) ;
-              residyvsX_histo->fill(_xPosHere[iDetector], _waferResidY[iDetector]);
+              if ( AIDA::IProfile1D* residvsX_histo = _residualProfiles.get( iDetector, 2 * iAxis ) )
+                residvsX_histo->fill(_xPosHere[iDetector], waferResid[iAxis]);
+              if ( AIDA::IProfile1D* residvsY_histo = _residualProfiles.get( iDetector, 2 * iAxis + 1 ) )
+                residvsY_histo->fill(_yPosHere[iDetector], waferResid[iAxis]);
             }
             else
             {
-              streamlog_out ( ERROR2 ) << "Not able to retrieve histogram pointer for " << _residualYLocalname << endl;
-              streamlog_out ( ERROR2 ) << "Disabling histogramming from now on" << endl;
-              _histogramSwitch = false;
-            }
-          }
-          if ( _histogramSwitch ) {
-            tempHistoName = _residualZLocalname + "_d" + to_string( sensorID );
-            if ( AIDA::IHistogram1D* residz_histo = dynamic_cast<AIDA::IHistogram1D*>(_aidaHistoMap[tempHistoName.c_str()]) )
-            {
-              residz_histo->fill(_waferResidZ[iDetector]);
-
-              tempHistoName = _residualZvsYLocalname + "_d" + to_string( sensorID );
-              AIDA::IProfile1D* residzvsY_histo = dynamic_cast<AIDA::IProfile1D*>(_aidaHistoMapProf1D[tempHistoName.c_str()]) ;
-              residzvsY_histo->fill(_yPosHere[iDetector], _waferResidZ[iDetector]);
- 
-              tempHistoName = _residualZvsXLocalname + "_d" + to_string( sensorID );
-              AIDA::IProfile1D* residzvsX_histo = dynamic_cast<AIDA::IProfile1D*>(_aidaHistoMapProf1D[tempHistoName.c_str()]) ;
-              residzvsX_histo->fill(_xPosHere[iDetector], _waferResidZ[iDetector]);
-             }
-            else 
-            {
-              streamlog_out ( ERROR2 ) << "Not able to retrieve histogram pointer for " << _residualZLocalname << endl;
+              const string residualName[3] = { _residualXLocalname, _residualYLocalname, _residualZLocalname };
+              streamlog_out ( ERROR2 ) << "Not able to retrieve histogram pointer for " << residualName[iAxis] << endl;
               streamlog_out ( ERROR2 ) << "Disabling histogramming from now on" << endl;
               _histogramSwitch = false;
             }
@@ -2411,71 +2282,21 @@ bool EUTelMille::hitContainsHotPixels( TrackerHitImpl   * hit)
 {
   try
     {
-      try{
-	LCObjectVec clusterVector = hit->getRawHits();
-
-	if ( hit->getType() == kEUTelSparseClusterImpl ) 
-	  {
-      
-	    TrackerDataImpl * clusterFrame = dynamic_cast<TrackerDataImpl*> ( clusterVector[0] );
-	    if (clusterFrame == 0){
-	      // found invalid result from cast
-	      throw UnknownDataTypeException("Invalid hit found in method hitContainsHotPixels()");
-	    }
-		
-	    eutelescope::EUTelSparseClusterImpl< eutelescope::EUTelGenericSparsePixel > *cluster = new eutelescope::EUTelSparseClusterImpl< eutelescope::EUTelGenericSparsePixel >(clusterFrame);
-	    int sensorID = cluster->getDetectorID();
- 
-	    for ( unsigned int iPixel = 0; iPixel < cluster->size(); iPixel++ ) 
-              {
-                EUTelGenericSparsePixel m26Pixel;
-                cluster->getSparsePixelAt( iPixel, &m26Pixel);
-                int pixelX, pixelY;
-                pixelX = m26Pixel.getXCoord();
-                pixelY = m26Pixel.getYCoord();
-
-		{                       
-		    char ix[100];
-		    sprintf(ix, "%d,%d,%d", sensorID, pixelX, pixelY ); 
-		    std::map<std::string, bool >::const_iterator z = _hotPixelMap.find(ix);
-		    if(z!=_hotPixelMap.end() && _hotPixelMap[ix] == true  )
-		      { 
-			streamlog_out(DEBUG3) << "Skipping hit as it was found in the hot pixel map." << endl;
-			return true; // if TRUE  this hit will be skipped
-		      }
-		} 
-	      }
-
-	  } else if ( hit->getType() == kEUTelBrickedClusterImpl ) {
-
-	  // fixed cluster implementation. Remember it
-	  //  can come from
-	  //  both RAW and ZS data
-                   
-	} else if ( hit->getType() == kEUTelDFFClusterImpl ) {
-              
-	  // fixed cluster implementation. Remember it can come from
-	  // both RAW and ZS data
-	} else if ( hit->getType() == kEUTelFFClusterImpl ) {
-              
-	  // fixed cluster implementation. Remember it can come from
-	  // both RAW and ZS data
-	} 
-      }
-      catch(lcio::Exception e){
-	// catch specific exceptions
-          streamlog_out ( ERROR5 ) << "Exception occured in hitContainsHotPixels(): " << e.what() << endl;
-      }
+      if( _hotPixelMask.hitContainsMaskedPixel( hit ) )
+	{
+	  streamlog_out(DEBUG3) << "Skipping hit as it was found in the hot pixel map." << endl;
+	  return true; // if TRUE  this hit will be skipped
+	}
+    }
+  catch(lcio::Exception& e)
+    {
+      streamlog_out ( ERROR5 ) << "Exception occured in hitContainsHotPixels(): " << e.what() << endl;
     }
   catch(...)
     { 
       // if anything went wrong in the above return FALSE, meaning do not skip this hit
-      return 0;
     }
-
-  // if none of the above worked return FALSE, meaning do not skip this hit
-  return 0;
-
+  return false;
 }
 
 
@@ -2503,7 +2324,6 @@ void EUTelMille::end() {
 
     streamlog_out ( MESSAGE4 ) << endl << "Generating the steering file for the pede program..." << endl;
 
-    string tempHistoName;
     double *meanX = new double[_nPlanes];
     double *meanY = new double[_nPlanes];
     double *meanZ = new double[_nPlanes];
@@ -2511,11 +2331,8 @@ void EUTelMille::end() {
     // loop over all detector planes
     for(unsigned int iDetector = 0; iDetector < _nPlanes; iDetector++ ) {
 
-      int sensorID = _orderedSensorID.at( iDetector );
-
       if ( _histogramSwitch ) {
-        tempHistoName =  _residualXLocalname + "_d" + to_string( sensorID );
-        if ( AIDA::IHistogram1D* residx_histo = dynamic_cast<AIDA::IHistogram1D*>(_aidaHistoMap[tempHistoName.c_str()]) )
+        if ( AIDA::IHistogram1D* residx_histo = _residualHistos.get( iDetector, 0 ) )
           meanX[iDetector] = residx_histo->mean();
         else {
           streamlog_out ( ERROR2 ) << "Not able to retrieve histogram pointer for " << _residualXLocalname << endl;
@@ -2525,8 +2342,7 @@ void EUTelMille::end() {
       }
 
       if ( _histogramSwitch ) {
-        tempHistoName =  _residualYLocalname + "_d" + to_string( sensorID );
-        if ( AIDA::IHistogram1D* residy_histo = dynamic_cast<AIDA::IHistogram1D*>(_aidaHistoMap[tempHistoName.c_str()]) )
+        if ( AIDA::IHistogram1D* residy_histo = _residualHistos.get( iDetector, 1 ) )
           meanY[iDetector] = residy_histo->mean();
         else {
           streamlog_out ( ERROR2 ) << "Not able to retrieve histogram pointer for " << _residualYLocalname << endl;
@@ -2536,8 +2352,7 @@ void EUTelMille::end() {
       }
 
       if ( _histogramSwitch ) {
-        tempHistoName =  _residualZLocalname + "_d" + to_string( sensorID );
-        if ( AIDA::IHistogram1D* residz_histo = dynamic_cast<AIDA::IHistogram1D*>(_aidaHistoMap[tempHistoName.c_str()]) )
+        if ( AIDA::IHistogram1D* residz_histo = _residualHistos.get( iDetector, 2 ) )
           meanZ[iDetector] = residz_histo->mean();
         else {
           streamlog_out ( ERROR2 ) << "Not able to retrieve histogram pointer for " << _residualZLocalname << endl;
@@ -3247,6 +3062,27 @@ void EUTelMille::bookHistos() {
         _histogramSwitch = false;
       }
     }
+
+    // resolve the names once, so that the filling is done by index
+    _chi2Histos.reset( 1, 2 );
+    _chi2Histos.setFromMap( 0, 0, _aidaHistoMap, _chi2XLocalname );
+    _chi2Histos.setFromMap( 0, 1, _aidaHistoMap, _chi2YLocalname );
+
+    const string residualName[3] = { _residualXLocalname, _residualYLocalname, _residualZLocalname };
+    const string residualProfileName[6] = { _residualXvsXLocalname, _residualXvsYLocalname,
+                                            _residualYvsXLocalname, _residualYvsYLocalname,
+                                            _residualZvsXLocalname, _residualZvsYLocalname };
+    _residualHistos.reset( _nPlanes, 3 );
+    _residualProfiles.reset( _nPlanes, 6 );
+    for(unsigned int iDetector = 0; iDetector < _nPlanes; iDetector++ ){
+      string sensorSuffix = "_d" + to_string( _orderedSensorID.at( iDetector ) );
+      for ( int iAxis = 0; iAxis < 3; iAxis++ ) {
+        _residualHistos.setFromMap( iDetector, iAxis, _aidaHistoMap, residualName[iAxis] + sensorSuffix );
+      }
+      for ( int iProfile = 0; iProfile < 6; iProfile++ ) {
+        _residualProfiles.setFromMap( iDetector, iProfile, _aidaHistoMapProf1D, residualProfileName[iProfile] + sensorSuffix );
+      }
+    }
   } catch (lcio::Exception& e ) {
 
 
@@ -1,5 +1,17 @@
 #include "EUTelMillepede.h"
 
+// ROOT
+#include "TDecompChol.h"
+#include "TMatrixDSym.h"
+#include "TVectorD.h"
+
+// Eigen
+#include <Eigen/Core>
+#include <Eigen/LU>
+
+// system includes <>
+#include <cmath>
+
 using namespace lcio;
 using namespace std;
 using namespace marlin;
@@ -66,18 +78,32 @@ void EUTelMillepede::computeAlignmentToMeasurementJacobian( float x,float y, flo
 	streamlog_out(DEBUG0) << "This is the empty Alignment Jacobian" << std::endl;
 	streamlog_message( DEBUG0, _jacobian.Print();, std::endl; );			
 		
-	_jacobian[0][0] = -1.0; // dxh/dxs      dxh => change in hit position         dxs => Change in sensor position
-	_jacobian[1][0] = 0.0; // dyh/dxs
-	_jacobian[0][1] = 0.0; // dxh/dys     
-	_jacobian[1][1] = -1.0; // dyh/dys
-	_jacobian[0][2] = y; // dxh/rotzs   
-	_jacobian[1][2] = -x; // dyh/rotzs
-	_jacobian[0][3] = slopeXvsZ; // dxh/dzs
-	_jacobian[1][3] = slopeYvsZ; // dyh/dzs
-	_jacobian[0][4] = -x*slopeXvsZ; // dxh/rotyr
-	_jacobian[1][4] = -x*slopeYvsZ; // dyh/rotyr
-	_jacobian[0][5] = -y*slopeXvsZ; // dxh/rotxr          
-	_jacobian[1][5] = -y*slopeYvsZ; // dyh/rotxr         
+	double derivatives[2][6];
+	alignmentDerivatives(x, y, slopeXvsZ, slopeYvsZ, derivatives);
+	for(int i = 0; i < 2; ++i){
+		for(int j = 0; j < 6; ++j){
+			_jacobian[i][j] = derivatives[i][j];
+		}
+	}
+}
+
+void EUTelMillepede::alignmentDerivatives(float x, float y, float slopeXvsZ, float slopeYvsZ, double derivatives[2][6]){
+	derivatives[0][0] = -1.0; // dxh/dxs      dxh => change in hit position         dxs => Change in sensor position
+	derivatives[1][0] = 0.0; // dyh/dxs
+	derivatives[0][1] = 0.0; // dxh/dys     
+	derivatives[1][1] = -1.0; // dyh/dys
+	derivatives[0][2] = y; // dxh/rotzs   
+	derivatives[1][2] = -x; // dyh/rotzs
+	derivatives[0][3] = slopeXvsZ; // dxh/dzs
+	derivatives[1][3] = slopeYvsZ; // dyh/dzs
+	derivatives[0][4] = -x*slopeXvsZ; // dxh/rotyr
+	derivatives[1][4] = -x*slopeYvsZ; // dyh/rotyr
+	derivatives[0][5] = -y*slopeXvsZ; // dxh/rotxr          
+	derivatives[1][5] = -y*slopeYvsZ; // dyh/rotxr         
+}
+
+bool EUTelMillepede::isFixed(const std::vector<int>& fixedPlaneIds, int sensorId){
+	return std::find(fixedPlaneIds.begin(), fixedPlaneIds.end(), sensorId) != fixedPlaneIds.end();
 }
 
 void EUTelMillepede::setGlobalLabels(EUTelState& state){
@@ -440,6 +466,262 @@ void EUTelMillepede::printFixedPlanes(){
 	}
 	streamlog_out(MESSAGE5)<<endl;
 }
+//The in process alignment keeps per measurement the residual to the input track, its precision and the state parameters needed for the alignment jacobian.
+//The track model is a straight line in the global frame, with the offsets and slopes at the first measurement as local parameters. Scattering is not included.
+void EUTelMillepede::storeTrack(std::vector<EUTelState>& measurementStates){
+	//Fewer than 3 measurements leave no degrees of freedom for the 4 local parameters
+	if(measurementStates.size() < 3){
+		return;
+	}
+	_storedTrackBegin.push_back(_storedMeasurements.size());
+	const double zReference = measurementStates.front().getPositionGlobal()[2];
+	for(size_t i = 0; i < measurementStates.size(); ++i){
+		EUTelState& state = measurementStates.at(i);
+		if(!state.getStateHasHit()){
+			throw(lcio::Exception("You are just about to store a state with no hit for the alignment."));
+		}
+		EUTelHit hit = state.getHit();
+		const double* hitPosition = hit.getPosition();
+		const float* statePosition = state.getPosition();
+		double cov[4];
+		state.getCombinedHitAndStateCovMatrixInLocalFrame(cov);
+
+		StoredMeasurement measurement;
+		measurement.sensorID = state.getLocation();
+		measurement.residual[0] = hitPosition[0] - statePosition[0];
+		measurement.residual[1] = hitPosition[1] - statePosition[1];
+		measurement.precision[0] = 1. / cov[0];
+		measurement.precision[1] = 1. / cov[3];
+		measurement.x = statePosition[0];
+		measurement.y = statePosition[1];
+		measurement.slopeXvsZ = state.getMomLocalX()/state.getMomLocalZ();
+		measurement.slopeYvsZ = state.getMomLocalY()/state.getMomLocalZ();
+
+		//The local x and y axes in the global frame give the derivatives to the global x and y of the straight line
+		const double distance = state.getPositionGlobal()[2] - zReference;
+		for(int j = 0; j < 2; ++j){
+			const double localAxis[3] = { j == 0 ? 1. : 0., j == 1 ? 1. : 0., 0. };
+			double globalAxis[3];
+			geo::gGeometry().local2MasterVec(measurement.sensorID, localAxis, globalAxis);
+			measurement.localDerivatives[j][0] = globalAxis[0];
+			measurement.localDerivatives[j][1] = globalAxis[0]*distance;
+			measurement.localDerivatives[j][2] = globalAxis[1];
+			measurement.localDerivatives[j][3] = globalAxis[1]*distance;
+		}
+		_storedMeasurements.push_back(measurement);
+	}
+}
+
+//This does what pede does with the method inversion, on the stored tracks: the local parameters of each track are eliminated from the normal equations and
+//the matrix of the global parameters is solved. The residuals are then corrected by the new alignment and the tracks are fitted again, so the outlier rejection
+//sees the new alignment. This is repeated until the corrections are small compared to their errors, without reading the data again.
+bool EUTelMillepede::solveInProcess(int maxIterations, double chi2NdfCut){
+	streamlog_out(DEBUG2) << "EUTelMillepede::solveInProcess------------------------------------BEGIN" << std::endl;
+	//Index of each free parameter in the matrix, by label-1. Fixed parameters and planes which are not aligned have -1.
+	const size_t nLabels = 6*_xShiftsMap.size();
+	std::vector<int> freeIndex(nLabels, -1);
+	std::map<int, std::vector<int> > sensorLabels;
+	int nFree = 0;
+	const std::map<int, int>& planes = geo::gGeometry().sensorZOrderToIDWithoutExcludedPlanes();
+	for(size_t i = 0; i < planes.size(); ++i){
+		const int sensorId = planes.at(i);
+		setGlobalLabels(sensorId);
+		sensorLabels[sensorId] = _globalLabels;
+		//Same order as the labels
+		const bool fixed[6] = { isFixed(_fixedAlignmentXShfitPlaneIds, sensorId), isFixed(_fixedAlignmentYShfitPlaneIds, sensorId),
+		                        isFixed(_fixedAlignmentZRotationPlaneIds, sensorId), isFixed(_fixedAlignmentZShfitPlaneIds, sensorId),
+		                        isFixed(_fixedAlignmentYRotationPlaneIds, sensorId), isFixed(_fixedAlignmentXRotationPlaneIds, sensorId) };
+		for(int k = 0; k < 6; ++k){
+			if(!fixed[k]){
+				freeIndex.at(_globalLabels[k]-1) = nFree++;
+			}
+		}
+	}
+	_inProcessCorrections.assign(nLabels, 0.);
+	_inProcessErrors.assign(nLabels, 0.);
+	if(nFree == 0){
+		streamlog_out(WARNING5) << "All alignment parameters are fixed. Nothing to align." << std::endl;
+		return false;
+	}
+
+	TMatrixDSym matrix(nFree);
+	TVectorD vector(nFree);
+	TMatrixDSym covariance(nFree);
+	//Per track: residuals corrected by the alignment, derivatives and free indices of each row
+	std::vector<double> residuals;
+	std::vector<double> weights;
+	std::vector<double> globalDerivatives;
+	std::vector<int> globalIndices;
+	std::vector<double> localDerivatives;
+	std::vector<double> globalLocal;
+	bool converged = false;
+	for(int iteration = 0; iteration < maxIterations; ++iteration){
+		//The first iteration uses the residuals of the unaligned input, so no track is rejected there
+		const double cut = (iteration == 0) ? 0. : chi2NdfCut;
+		matrix.Zero();
+		vector.Zero();
+		size_t nUsed = 0;
+		size_t nRejected = 0;
+		for(size_t iTrack = 0; iTrack < _storedTrackBegin.size(); ++iTrack){
+			const size_t begin = _storedTrackBegin[iTrack];
+			const size_t end = (iTrack+1 < _storedTrackBegin.size()) ? _storedTrackBegin[iTrack+1] : _storedMeasurements.size();
+			const size_t nRows = 2*(end - begin);
+			residuals.resize(nRows);
+			weights.resize(nRows);
+			globalDerivatives.resize(6*nRows);
+			globalIndices.resize(6*nRows);
+			localDerivatives.resize(4*nRows);
+
+			//Local fit of the straight line
+			Eigen::Matrix4d localMatrix = Eigen::Matrix4d::Zero();
+			Eigen::Vector4d localVector = Eigen::Vector4d::Zero();
+			int nMeasured = 0;
+			for(size_t m = begin; m < end; ++m){
+				const StoredMeasurement& measurement = _storedMeasurements[m];
+				double derivatives[2][6];
+				alignmentDerivatives(measurement.x, measurement.y, measurement.slopeXvsZ, measurement.slopeYvsZ, derivatives);
+				std::map<int, std::vector<int> >::const_iterator labels = sensorLabels.find(measurement.sensorID);
+				for(int j = 0; j < 2; ++j){
+					const size_t row = 2*(m - begin) + j;
+					double residual = measurement.residual[j];
+					for(int k = 0; k < 6; ++k){
+						const int label = (labels == sensorLabels.end()) ? 0 : labels->second[k];
+						globalDerivatives[6*row+k] = derivatives[j][k];
+						globalIndices[6*row+k] = (label == 0) ? -1 : freeIndex[label-1];
+						if(label != 0){
+							residual -= derivatives[j][k]*_inProcessCorrections[label-1];
+						}
+					}
+					residuals[row] = residual;
+					weights[row] = measurement.precision[j];
+					if(weights[row] > 0.){
+						++nMeasured;
+					}
+					for(int k = 0; k < 4; ++k){
+						localDerivatives[4*row+k] = measurement.localDerivatives[j][k];
+						localVector(k) += weights[row]*residual*localDerivatives[4*row+k];
+						for(int l = 0; l < 4; ++l){
+							localMatrix(k, l) += weights[row]*localDerivatives[4*row+k]*measurement.localDerivatives[j][l];
+						}
+					}
+				}
+			}
+			if(nMeasured <= 4 || std::fabs(localMatrix.determinant()) < 1.e-12){
+				continue;
+			}
+			const Eigen::Matrix4d localCovariance = localMatrix.inverse();
+			const Eigen::Vector4d localParameters = localCovariance*localVector;
+			double chi2 = 0.;
+			for(size_t row = 0; row < nRows; ++row){
+				double residual = residuals[row];
+				for(int k = 0; k < 4; ++k){
+					residual -= localDerivatives[4*row+k]*localParameters(k);
+				}
+				chi2 += weights[row]*residual*residual;
+			}
+			if(cut > 0. && chi2 > cut*(nMeasured - 4)){
+				++nRejected;
+				continue;
+			}
+			++nUsed;
+
+			//Add the track to the global normal equations, with the local parameters eliminated
+			//Sum of weight times global derivative times local derivatives, 6 parameters per measurement
+			globalLocal.assign(4*3*nRows, 0.);
+			for(size_t row = 0; row < nRows; ++row){
+				const size_t first = 6*(row/2);
+				for(int k = 0; k < 6; ++k){
+					const int index = globalIndices[6*row+k];
+					if(index < 0) continue;
+					const double weightedDerivative = weights[row]*globalDerivatives[6*row+k];
+					vector(index) += weightedDerivative*residuals[row];
+					//A row only depends on the parameters of its own plane
+					for(int l = 0; l < 6; ++l){
+						const int index2 = globalIndices[6*row+l];
+						if(index2 < 0 || index2 > index) continue;
+						matrix(index, index2) += weightedDerivative*globalDerivatives[6*row+l];
+					}
+					for(int l = 0; l < 4; ++l){
+						globalLocal[4*(first+k)+l] += weightedDerivative*localDerivatives[4*row+l];
+					}
+				}
+			}
+			const size_t nGlobal = 3*nRows;
+			for(size_t a = 0; a < nGlobal; ++a){
+				const int index = globalIndices[12*(a/6)+a%6];
+				if(index < 0) continue;
+				const Eigen::Vector4d product = localCovariance*Eigen::Vector4d(globalLocal[4*a], globalLocal[4*a+1], globalLocal[4*a+2], globalLocal[4*a+3]);
+				vector(index) -= product.dot(localVector);
+				for(size_t b = 0; b < nGlobal; ++b){
+					const int index2 = globalIndices[12*(b/6)+b%6];
+					if(index2 < 0 || index2 > index) continue;
+					matrix(index, index2) -= product(0)*globalLocal[4*b] + product(1)*globalLocal[4*b+1] + product(2)*globalLocal[4*b+2] + product(3)*globalLocal[4*b+3];
+				}
+			}
+		}
+		streamlog_out(MESSAGE5) << "In process alignment iteration " << iteration << ": " << nUsed << " tracks used, " << nRejected << " rejected" << std::endl;
+		if(3*nRejected > nUsed + nRejected){
+			streamlog_out(MESSAGE5) << "Too many rejects (>33.3%). Number of rejects high. We can't use these tracks for alignment" << std::endl;
+			return true;
+		}
+		if(nUsed == 0){
+			throw(lcio::Exception("There are no tracks for the in process alignment."));
+		}
+		//Only the lower triangle was filled
+		for(int i = 0; i < nFree; ++i){
+			for(int j = 0; j < i; ++j){
+				matrix(j, i) = matrix(i, j);
+			}
+		}
+		TDecompChol decomposition(matrix);
+		if(!decomposition.Decompose()){
+			throw(lcio::Exception("The alignment matrix is not positive definite. Fix more alignment parameters."));
+		}
+		bool ok = true;
+		const TVectorD corrections = decomposition.Solve(vector, ok);
+		decomposition.Invert(covariance);
+
+		//Converged when no correction is larger than a tenth of its error
+		converged = true;
+		for(size_t label = 0; label < nLabels; ++label){
+			const int index = freeIndex[label];
+			if(index < 0) continue;
+			_inProcessCorrections[label] += corrections(index);
+			_inProcessErrors[label] = std::sqrt(covariance(index, index));
+			if(std::fabs(corrections(index)) > 0.1*_inProcessErrors[label]){
+				converged = false;
+			}
+		}
+		if(converged){
+			streamlog_out(MESSAGE5) << "In process alignment converged after " << iteration+1 << " iterations" << std::endl;
+			break;
+		}
+	}
+	if(!converged){
+		streamlog_out(WARNING5) << "Converge:Fail! The in process alignment did not converge in " << maxIterations << " iterations. The results of the last iteration are written." << std::endl;
+	}
+	streamlog_out(DEBUG2) << "EUTelMillepede::solveInProcess------------------------------------END" << std::endl;
+	return false;
+}
+
+//Same layout as the pede results file, so it can be used in place of it by parseMilleOutput()
+void EUTelMillepede::writeResultsFile(){
+	ofstream resultFile(_milleResultFileName.c_str());
+	if (!resultFile.is_open()) {
+		throw(lcio::Exception("Could not open millepede results file. In writeResultsFile()"));
+	}
+	resultFile << " Parameter   ! first 3 elements per line are significant (if used as input)" << std::endl;
+	for(size_t label = 0; label < _inProcessCorrections.size(); ++label){
+		const bool fixed = (_inProcessErrors[label] == 0.);
+		resultFile << right << setw(11) << label+1 << scientific << setprecision(5)
+		           << setw(14) << _inProcessCorrections[label] << setw(14) << (fixed ? -1. : 0.);
+		if(!fixed){
+			resultFile << setw(14) << _inProcessCorrections[label] << setw(14) << _inProcessErrors[label];
+		}
+		resultFile << std::endl;
+	}
+	resultFile.close();
+}
 } // namespace eutelescope
 
 
@@ -16,7 +16,7 @@ namespace eutelescope
  * @param dz propagation distance
  * @return 
  */
-TMatrix EUTelNav::getPropagationJacobianF( float x0, float y0, float z0, float px, float py, float pz, float beamQ, float dz )
+Matrix5d EUTelNav::getPropagationJacobianF( float x0, float y0, float z0, float px, float py, float pz, float beamQ, float dz )
 {
 		// The formulas below are derived from equations of motion of the particle in
 		// magnetic field under assumption |dz| small. Must be valid for |dz| < 10 cm
@@ -68,18 +68,17 @@ TMatrix EUTelNav::getPropagationJacobianF( float x0, float y0, float z0, float p
 		const double dtydinvP0 = k * dz * Ay;
 
 		//Fill-in matrix elements
-		TMatrix jacobianF(5,5);
-		jacobianF.UnitMatrix();
+		Matrix5d jacobianF = Matrix5d::Identity();
 
-		jacobianF[3][1] = dxdtx0;	jacobianF[3][2] = dxdty0;	jacobianF[3][0] = dxdinvP0;
-		jacobianF[4][1] = dydtx0;	jacobianF[4][2] = dydty0;	jacobianF[4][0] = dydinvP0;
-		jacobianF[1][2] = dtxdty0;	jacobianF[1][0] = dtxdinvP0;
-		jacobianF[2][1] = dtydtx0;	jacobianF[2][0] = dtydinvP0;
+		jacobianF(3,1) = dxdtx0;	jacobianF(3,2) = dxdty0;	jacobianF(3,0) = dxdinvP0;
+		jacobianF(4,1) = dydtx0;	jacobianF(4,2) = dydty0;	jacobianF(4,0) = dydinvP0;
+		jacobianF(1,2) = dtxdty0;	jacobianF(1,0) = dtxdinvP0;
+		jacobianF(2,1) = dtydtx0;	jacobianF(2,0) = dtydinvP0;
 
 		if( streamlog_level(DEBUG0) )
 		{
 				streamlog_out( DEBUG0 ) << "Propagation jacobian: " << std::endl;
-				jacobianF.Print();
+				streamlog_out( DEBUG0 ) << jacobianF << std::endl;
 		}
 		return jacobianF;
 
@@ -94,7 +93,7 @@ TMatrix EUTelNav::getPropagationJacobianF( float x0, float y0, float z0, float p
  * This is a simple transform our x becomes their(curvilinear y), our y becomes their z and z becomes x
  * However, this is ok since we never directly access the curvilinear system. It is only a bridge between two local systems.
  */ 
-TMatrixD EUTelNav::getLocalToCurvilinearTransformMatrix(TVector3 globalMomentum, int  planeID, float charge)
+Matrix5d EUTelNav::getLocalToCurvilinearTransformMatrix(TVector3 globalMomentum, int  planeID, float charge)
 {
 		const gear::BField& Bfield = geo::gGeometry().getMagneticField();
 
@@ -138,8 +137,7 @@ TMatrixD EUTelNav::getLocalToCurvilinearTransformMatrix(TVector3 globalMomentum,
 		TVector3 JTelescopeFrame;
 
 		///This is the EUTelescope local z direction.
-		//314 is the number we chose to specify a scattering plane.
-		if(planeID != 314)
+		if(planeID != SCATTER_IDENTIFIER)
 		{ 
 				ITelescopeFrame = geo::gGeometry().siPlaneNormal(planeID);       
 				KTelescopeFrame = geo::gGeometry().siPlaneXAxis(planeID);	
@@ -178,8 +176,7 @@ TMatrixD EUTelNav::getLocalToCurvilinearTransformMatrix(TVector3 globalMomentum,
 		const double UDotK = U.Dot(K);
 		const double UDotN = U.Dot(N);
 	
-		TMatrix jacobian(5,5);
-		jacobian.Zero();
+		Matrix5d jacobian = Matrix5d::Zero();
 	
 		/*	Matrix has following (X) entries set:
  		 *	X 0 0 0 0
@@ -190,23 +187,23 @@ TMatrixD EUTelNav::getLocalToCurvilinearTransformMatrix(TVector3 globalMomentum,
 		 */ 	
 
 		//First Row
-		jacobian[0][0]=1;
+		jacobian(0,0)=1;
 		//Second Row 
-		jacobian[1][1]=TDotI*VDotJ;
-		jacobian[1][2]=TDotI*VDotK;
-		jacobian[1][3]=-alpha*Q*TDotJ*VDotN;
-		jacobian[1][4]=-alpha*Q*TDotK*VDotN;
+		jacobian(1,1)=TDotI*VDotJ;
+		jacobian(1,2)=TDotI*VDotK;
+		jacobian(1,3)=-alpha*Q*TDotJ*VDotN;
+		jacobian(1,4)=-alpha*Q*TDotK*VDotN;
 		//Third Row
-		jacobian[2][1]=(TDotI*UDotJ)/cosLambda;
-		jacobian[2][2]=(TDotI*UDotK)/cosLambda;
-		jacobian[2][3]=(-alpha*Q*TDotJ*UDotN)/cosLambda;
-		jacobian[2][4]=(-alpha*Q*TDotK*UDotN)/cosLambda;
+		jacobian(2,1)=(TDotI*UDotJ)/cosLambda;
+		jacobian(2,2)=(TDotI*UDotK)/cosLambda;
+		jacobian(2,3)=(-alpha*Q*TDotJ*UDotN)/cosLambda;
+		jacobian(2,4)=(-alpha*Q*TDotK*UDotN)/cosLambda;
 		//Forth Row
-		jacobian[3][3]=UDotJ;
-		jacobian[3][4]=UDotK;
+		jacobian(3,3)=UDotJ;
+		jacobian(3,4)=UDotK;
 		//Fifth Row		
-		jacobian[4][3]=VDotJ;
-		jacobian[4][4]=VDotK;
+		jacobian(4,3)=VDotJ;
+		jacobian(4,4)=VDotK;
 		
 		return jacobian;
 }
@@ -217,52 +214,52 @@ TMatrixD EUTelNav::getLocalToCurvilinearTransformMatrix(TVector3 globalMomentum,
  */
 
 
-TMatrixD EUTelNav::getMeasToGlobal(TVector3 t1w, int  planeID)
+Matrix5d EUTelNav::getMeasToGlobal(TVector3 t1w, int  planeID)
 {
 //	std::cout<<"Plane ID " << planeID <<std::endl;
-	TMatrixD transM2l(5,5);
-	transM2l.UnitMatrix();
-	std::vector<double> slope;
-	slope.push_back(t1w[0]/t1w[2]); slope.push_back(t1w[1]/t1w[2]);
-	double norm = std::sqrt(pow(slope.at(0),2) + pow(slope.at(1),2) + 1);//This works since we have in the curvinlinear frame (dx/dz)^2 +(dy/dz)^2 +1 so time through by dz^2
+	Matrix5d transM2l = Matrix5d::Identity();
+	const double slope[2] = { t1w[0]/t1w[2], t1w[1]/t1w[2] };
+	double norm = std::sqrt(pow(slope[0],2) + pow(slope[1],2) + 1);//This works since we have in the curvinlinear frame (dx/dz)^2 +(dy/dz)^2 +1 so time through by dz^2
 	TVector3 direction;
-	direction[0] = (slope.at(0)/norm); direction[1] =(slope.at(1)/norm);	direction[2] = (1.0/norm);
-	TMatrixD xyDir(2, 3);
-	xyDir[0][0] = 1; xyDir[0][1]=0.0; xyDir[0][2]=-slope.at(0);  
-	xyDir[1][0] = 0; xyDir[1][1]=1.0; xyDir[1][2]=-slope.at(1);  
-	TMatrixD TRotMatrix(3,3);
-	TRotMatrix	=  geo::gGeometry().getRotMatrix( planeID );
+	direction[0] = (slope[0]/norm); direction[1] =(slope[1]/norm);	direction[2] = (1.0/norm);
+	Eigen::Matrix<double, 2, 3> xyDir;
+	xyDir << 1, 0.0, -slope[0],
+	         0, 1.0, -slope[1];
+	//The rotation comes from the cached plane transformation. Scattering planes are not rotated.
+	Eigen::Matrix3d TRotMatrix = Eigen::Matrix3d::Identity();
+	if(planeID != SCATTER_IDENTIFIER){
+		const double* transform = geo::gGeometry().getPlaneTransform(planeID);
+		TRotMatrix << transform[0], transform[1], transform[2],
+		              transform[3], transform[4], transform[5],
+		              transform[6], transform[7], transform[8];
+	}
 	TVector3 normalVec;
-	normalVec[0] = TRotMatrix[0][2];	normalVec[1] = TRotMatrix[1][2];	normalVec[2] = TRotMatrix[2][2];
+	normalVec[0] = TRotMatrix(0,2);	normalVec[1] = TRotMatrix(1,2);	normalVec[2] = TRotMatrix(2,2);
 	double cosInc = direction*normalVec;
 //	std::cout<<"Here is cosInc " << cosInc <<std::endl;
-	TMatrixD measDir(3,2);
-	measDir[0][0] = TRotMatrix[0][0];	measDir[0][1] = TRotMatrix[0][1];
-	measDir[1][0] = TRotMatrix[1][0];	measDir[1][1] = TRotMatrix[1][1];
-	measDir[2][0] = TRotMatrix[2][0];	measDir[2][1] = TRotMatrix[2][1];
+	Eigen::Matrix<double, 3, 2> measDir = TRotMatrix.block<3,2>(0,0);
     streamlog_out( DEBUG0 ) << "CALCULATE LOCAL TO GLOBAL STATE TRANSFORMATION... " << std::endl;
     streamlog_out( DEBUG0 ) << "Inputs... " << std::endl;
 
     streamlog_out( DEBUG0 ) << "The (X,Y)-axis of the global frame relative to the local  " << std::endl;
-    streamlog_message( DEBUG0, measDir.Print();, std::endl; );
+    streamlog_out( DEBUG0 ) << measDir << std::endl;
     streamlog_out( DEBUG0 ) << "The propagator (unit axis) (Dx,Dy)   " << std::endl;
-    streamlog_message( DEBUG0, xyDir.Print();, std::endl; );
+    streamlog_out( DEBUG0 ) << xyDir << std::endl;
     double scaleFactor = cosInc/direction[2];
     streamlog_out( DEBUG0 ) << "Scale factor (s) " << scaleFactor << std::endl;
-	TMatrixD proM2l(2,2);
-	proM2l = xyDir*measDir; 
+	Eigen::Matrix2d proM2l = xyDir*measDir; 
     streamlog_out( DEBUG0 ) << "Propagators... " << std::endl;
 
     streamlog_out( DEBUG0 ) << "PROJECTION MATRIX (shifts) (Dx,Dy)x(X,Y)" << std::endl;
-    streamlog_message( DEBUG0, proM2l.Print();, std::endl; );
+    streamlog_out( DEBUG0 ) << proM2l << std::endl;
     streamlog_out( DEBUG0 ) << "PROJECTION MATRIX (incidence) s(Dx,Dy)x(X,Y) " << std::endl;
-    TMatrixD proM2lInc = scaleFactor*proM2l;
-    streamlog_message( DEBUG0, proM2lInc.Print();, std::endl; );
+    Eigen::Matrix2d proM2lInc = scaleFactor*proM2l;
+    streamlog_out( DEBUG0 ) << proM2lInc << std::endl;
 
-	transM2l.SetSub(1,1,proM2lInc);
-	transM2l.SetSub(3,3,proM2l);
+	transM2l.block<2,2>(1,1) = proM2lInc;
+	transM2l.block<2,2>(3,3) = proM2l;
     streamlog_out( DEBUG0 ) << "OUTPUT:(Local to Global): " << std::endl;
-    streamlog_message( DEBUG0, transM2l.Print();, std::endl; );
+    streamlog_out( DEBUG0 ) << transM2l << std::endl;
 
 	return transM2l;
 }
@@ -273,14 +270,13 @@ TMatrixD EUTelNav::getMeasToGlobal(TVector3 t1w, int  planeID)
  * \return Jacobain 5x5 which links the two states 
  */
 
-TMatrixD EUTelNav::getPropagationJacobianGlobalToGlobal(float ds, TVector3 t1w)
+Matrix5d EUTelNav::getPropagationJacobianGlobalToGlobal(float ds, TVector3 t1w)
 {
 	t1w.Unit();
-	std::vector<double> slope;
-	slope.push_back(t1w[0]/t1w[2]); slope.push_back(t1w[1]/t1w[2]);
-	double norm = std::sqrt(pow(slope.at(0),2) + pow(slope.at(1),2) + 1);//not this works since we have in the curvinlinear frame (dx/dz)^2 +(dy/dz)^2 +1 so time through by dz^2
+	const double slope[2] = { t1w[0]/t1w[2], t1w[1]/t1w[2] };
+	double norm = std::sqrt(pow(slope[0],2) + pow(slope[1],2) + 1);//not this works since we have in the curvinlinear frame (dx/dz)^2 +(dy/dz)^2 +1 so time through by dz^2
 	TVector3 direction;
-	direction[0] = (slope.at(0)/norm); direction[1] =(slope.at(1)/norm);	direction[2] = (1.0/norm);
+	direction[0] = (slope[0]/norm); direction[1] =(slope[1]/norm);	direction[2] = (1.0/norm);
 //	std::cout <<"DIRECTION: "<< direction[0] <<"   " << direction[1]<< "  "<< direction[2] <<std::endl;
 	double sinLambda = direction[2]; 
 	const gear::BField& Bfield = geo::gGeometry().getMagneticField();
@@ -294,45 +290,29 @@ TMatrixD EUTelNav::getPropagationJacobianGlobalToGlobal(float ds, TVector3 t1w)
 	TVector3 b(Bx, By, Bz);
 	TVector3 BxT = b.Cross(direction);
 //	std::cout << "BxT" << BxT[0] << "  ,  " <<  BxT[1] <<"   ,  " <<BxT[2] << std::endl;
-	TMatrixD xyDir(2, 3);
+	Eigen::Matrix<double, 2, 3> xyDir;
 //    streamlog_out( DEBUG0 ) << "CALCULATE GLOBAL TO GLOBAL STATE TRANSFORMATION... " << std::endl;
 
-	xyDir[0][0] = 1.0; xyDir[0][1]=0.0; xyDir[0][2]=-slope.at(0);  
-	xyDir[1][0] = 0; xyDir[1][1]=1.0; xyDir[1][2]=-slope.at(1);  
-//    streamlog_out( DEBUG0 ) << "The propagator (Dx,Dy)   " << std::endl;
- //   streamlog_message( DEBUG0, xyDir.Print();, std::endl; );
-
-
-	TMatrixD bFac(2,1);
-	TMatrixD BxTMatrix(3,1);
-	BxTMatrix.Zero();
-	BxTMatrix[0][0] =BxT[0];	BxTMatrix[1][0] =BxT[1];	BxTMatrix[2][0] =BxT[2]; 
- 
-	bFac = -0.0002998 * (xyDir*BxTMatrix); 
-//	std::cout <<std::scientific<< "bFac" << bFac[0][0] << "  ,  " <<  bFac[1][0] << std::endl;
-	TMatrixD ajac(5, 5);
-	ajac.UnitMatrix();
+	xyDir << 1.0, 0.0, -slope[0],
+	         0,   1.0, -slope[1];
+
+	Eigen::Vector3d BxTVec(BxT[0], BxT[1], BxT[2]);
+	Eigen::Vector2d bFac = -0.0002998 * (xyDir*BxTVec); 
+//	std::cout <<std::scientific<< "bFac" << bFac(0) << "  ,  " <<  bFac(1) << std::endl;
+	Matrix5d ajac = Matrix5d::Identity();
 	if(b.Mag() < 0.001 ){
-			ajac[3][2] = ds * std::sqrt(t1w[0] * t1w[0] + t1w[2] * t1w[2]);
-			ajac[4][1] = ds;
+			ajac(3,2) = ds * std::sqrt(t1w[0] * t1w[0] + t1w[2] * t1w[2]);
+			ajac(4,1) = ds;
 	}else{
-		ajac[1][0] = bFac[0][0]*ds/sinLambda;
-//		std::cout<<"Jacobian entries;" << ajac[1][0] << std::endl;
-//		std::cout<<"1,0 " << ajac[1][0] << std::endl;
-		ajac[2][0] = bFac[1][0]*ds/sinLambda;
-//		std::cout<< std::scientific <<"2,0 " << ajac[2][0] << std::endl;
-		ajac[3][0] = 0.5*bFac[0][0]*ds*ds;
-//		std::cout<<"3,0 " << ajac[3][0] << std::endl;
-		ajac[4][0] = 0.5*bFac[1][0]*ds*ds;
-//		std::cout<< std::scientific  <<"4,0 " << ajac[4][0] << std::endl;
-		ajac[3][1] = ds*sinLambda; 
-//		std::cout<<"3,1 " << ajac[3][1] << std::endl;
-		ajac[4][2] = ds*sinLambda; 
-//		std::cout<<"4,2 " << ajac[4][2] << std::endl;
-
+		ajac(1,0) = bFac(0)*ds/sinLambda;
+		ajac(2,0) = bFac(1)*ds/sinLambda;
+		ajac(3,0) = 0.5*bFac(0)*ds*ds;
+		ajac(4,0) = 0.5*bFac(1)*ds*ds;
+		ajac(3,1) = ds*sinLambda; 
+		ajac(4,2) = ds*sinLambda; 
 	}
     streamlog_out( DEBUG0 ) << "Global to Global jacobian: " << std::endl;
-    streamlog_message( DEBUG0, ajac.Print();, std::endl; );
+    streamlog_out( DEBUG0 ) << ajac << std::endl;
 	return ajac;
 }
 
@@ -343,7 +323,7 @@ TMatrixD EUTelNav::getPropagationJacobianGlobalToGlobal(float ds, TVector3 t1w)
  * This is ok since we never access the curvilinear system directly, but always through the local system which is defined 
  * in the local frame of the telescope; i.e Telescope x becomes y, y becomes z and z becomes x.
  */
-TMatrixD EUTelNav::getPropagationJacobianCurvilinear(float ds, float qbyp, TVector3 t1w, TVector3 t2w)
+Matrix5d EUTelNav::getPropagationJacobianCurvilinear(float ds, float qbyp, TVector3 t1w, TVector3 t2w)
 {
 		//This is needed to change to claus's coordinate system
 		TVector3 t1(t1w[2],t1w[1],t1w[0]);
@@ -384,10 +364,9 @@ TMatrixD EUTelNav::getPropagationJacobianCurvilinear(float ds, float qbyp, TVect
 		streamlog_out(DEBUG0)<<"The unit Magnetic field  "<< std::endl; 
 		streamlog_message( DEBUG0, b.Print();, std::endl; );
 		
-		TMatrixD ajac(5, 5);
+		Matrix5d ajac = Matrix5d::Identity();
 		//This is b*c. speed of light in 1 nanosecond
 		TVector3 bc = b*0.3*pow(10,-3);     //CHANGE HERE.
-		ajac.UnitMatrix(); 
 		
 		// -|B*c|
 		const double qp = -bc.Mag();
@@ -398,8 +377,8 @@ TMatrixD EUTelNav::getPropagationJacobianCurvilinear(float ds, float qbyp, TVect
 		//if q is zero -> line, otherwise a helix
 		if (q == 0.)
 		{
-				ajac[3][2] = ds * sqrt(t1[0] * t1[0] + t1[1] * t1[1]);
-				ajac[4][1] = ds;
+				ajac(3,2) = ds * sqrt(t1[0] * t1[0] + t1[1] * t1[1]);
+				ajac(4,1) = ds;
 		}
 		else
 		{
@@ -455,34 +434,34 @@ TMatrixD EUTelNav::getPropagationJacobianCurvilinear(float ds, float qbyp, TVect
 				const double an2u1 = an2.Dot(u1), an2v1 = an2.Dot(v1);
 				// jacobian
 				// 1/P
-				ajac[0][0] = 1.;
+				ajac(0,0) = 1.;
 				// Lambda
-				ajac[1][0] = -qp * anv * t2dx;
-				ajac[1][1] = cost * v1v2 + sint * hv1v2 + omcost * hnv1 * hnv2 + anv * (-sint * t2v1 + omcost * an2v1 - gamma * tmsint * hnv1);
-				ajac[1][2] = cosl1
+				ajac(1,0) = -qp * anv * t2dx;
+				ajac(1,1) = cost * v1v2 + sint * hv1v2 + omcost * hnv1 * hnv2 + anv * (-sint * t2v1 + omcost * an2v1 - gamma * tmsint * hnv1);
+				ajac(1,2) = cosl1
 						* (cost * u1v2 + sint * hu1v2 + omcost * hnu1 * hnv2 + anv * (-sint * t2u1 + omcost * an2u1 - gamma * tmsint * hnu1));
-				ajac[1][3] = -q * anv * t2u1;
-				ajac[1][4] = -q * anv * t2v1;
+				ajac(1,3) = -q * anv * t2u1;
+				ajac(1,4) = -q * anv * t2v1;
 				// Phi
-				ajac[2][0] = -qp * anu * t2dx * cosl2Inv;
-				ajac[2][1] = cosl2Inv
+				ajac(2,0) = -qp * anu * t2dx * cosl2Inv;
+				ajac(2,1) = cosl2Inv
 						* (cost * v1u2 + sint * hv1u2 + omcost * hnv1 * hnu2 + anu * (-sint * t2v1 + omcost * an2v1 - gamma * tmsint * hnv1));
-				ajac[2][2] = cosl2Inv * cosl1
+				ajac(2,2) = cosl2Inv * cosl1
 						* (cost * u1u2 + sint * hu1u2 + omcost * hnu1 * hnu2 + anu * (-sint * t2u1 + omcost * an2u1 - gamma * tmsint * hnu1));
-				ajac[2][3] = -q * anu * t2u1 * cosl2Inv;
-				ajac[2][4] = -q * anu * t2v1 * cosl2Inv;
+				ajac(2,3) = -q * anu * t2u1 * cosl2Inv;
+				ajac(2,4) = -q * anu * t2v1 * cosl2Inv;
 				// Xt
-				ajac[3][0] = pav * u2dx;
-				ajac[3][1] = (sint * v1u2 + omcost * hv1u2 + tmsint * hnu2 * hnv1) / q;
-				ajac[3][2] = (sint * u1u2 + omcost * hu1u2 + tmsint * hnu2 * hnu1) * cosl1 / q;
-				ajac[3][3] = u1u2;
-				ajac[3][4] = v1u2;
+				ajac(3,0) = pav * u2dx;
+				ajac(3,1) = (sint * v1u2 + omcost * hv1u2 + tmsint * hnu2 * hnv1) / q;
+				ajac(3,2) = (sint * u1u2 + omcost * hu1u2 + tmsint * hnu2 * hnu1) * cosl1 / q;
+				ajac(3,3) = u1u2;
+				ajac(3,4) = v1u2;
 				// Yt
-				ajac[4][0] = pav * v2dx;
-				ajac[4][1] = (sint * v1v2 + omcost * hv1v2 + tmsint * hnv2 * hnv1) / q;
-				ajac[4][2] = (sint * u1v2 + omcost * hu1v2 + tmsint * hnv2 * hnu1) * cosl1 / q;
-				ajac[4][3] = u1v2;
-				ajac[4][4] = v1v2;
+				ajac(4,0) = pav * v2dx;
+				ajac(4,1) = (sint * v1v2 + omcost * hv1v2 + tmsint * hnv2 * hnv1) / q;
+				ajac(4,2) = (sint * u1v2 + omcost * hu1v2 + tmsint * hnv2 * hnu1) * cosl1 / q;
+				ajac(4,3) = u1v2;
+				ajac(4,4) = v1v2;
 		}
 		return ajac;
 }
@@ -543,7 +522,7 @@ TVector3 EUTelNav::getMomentumfromArcLengthLocal(TVector3 pVec, TVector3 pos, fl
 	//TO DO: This transform is used also in state. Can make generic transform like this for both.
 	double globalVec[] = { newMomentum[0],newMomentum[1],newMomentum[2] };
 	double localVec[3];
-	if(planeID != 314){
+	if(planeID != SCATTER_IDENTIFIER){
 	geo::gGeometry().master2LocalVec( planeID ,globalVec, localVec );
 	pVecUnitLocal[0] = localVec[0]; 	pVecUnitLocal[1] = localVec[1]; 	pVecUnitLocal[2] = localVec[2]; 
 	}else{
@@ -679,9 +658,17 @@ bool EUTelNav::findIntersectionWithCertainID(	float x0, float y0, float z0,
 
 	//Is the new point within the sensor. If not then we may have to propagate a little bit further to enter.
  	double pos[3] = {newPos[0],newPos[1],newPos[2]};
-	int sensorIDCheck = geo::gGeometry().getSensorID(pos); 
 	bool foundIntersection = false;
-	if(sensorIDCheck == nextPlaneID){
+	bool isInsideSensor = false;
+	if( geo::gGeometry().useAnalyticNavigation() )
+	{
+		isInsideSensor = geo::gGeometry().isPointInsidePlane( nextPlaneID, pos );
+	}
+	else
+	{
+		isInsideSensor = ( geo::gGeometry().getSensorID(pos) == nextPlaneID );
+	}
+	if(isInsideSensor){
 		streamlog_out( DEBUG3 ) << "INTERSECTION FOUND! " << std::endl;
 		foundIntersection = true;
 		outputPosition[0] = newPos[0];
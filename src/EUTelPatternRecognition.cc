@@ -17,10 +17,24 @@ _numberOfTracksAfterPruneCut(0),
 _allowedMissingHits(0),
 _AllowedSharedHitsOnTrackCandidate(0),
 _beamE(-1.),
-_beamQ(-1.)
+_beamQ(-1.),
+_threadPool(NULL)
 {}
 EUTelPatternRecognition::~EUTelPatternRecognition()  
-{}
+{
+	delete _threadPool;
+}
+
+//Seeds are propagated on this many threads. The calling thread is one of them.
+void EUTelPatternRecognition::setNumberOfThreads(int numberOfThreads)
+{
+	delete _threadPool;
+	_threadPool = NULL;
+	if(numberOfThreads > 1)
+	{
+		_threadPool = new EUTelThreadPool(numberOfThreads);
+	}
+}
 
 
 std::vector<EUTelTrack>& EUTelPatternRecognition::getTracks()
@@ -48,8 +62,10 @@ std::vector<EUTelTrack>& EUTelPatternRecognition::getTracks()
 //}
 
 //This is the work horse of the class. Using seeds it propagates the track forward using equations of motion. This can be with or without magnetic field.
-void EUTelPatternRecognition::propagateForwardFromSeedState(EUTelState& stateInput, EUTelTrack& track)
+//Returns the number of hits added to the seed. Only local variables and the track are written to, so different seeds can be propagated at the same time.
+int EUTelPatternRecognition::propagateForwardFromSeedState(EUTelState& stateInput, EUTelTrack& track)
 {
+	int numberOfHitsAdded = 0;
     streamlog_out ( DEBUG1 ) << "Initial Seed: "<< std::endl;
     stateInput.print();
 
@@ -59,7 +75,7 @@ void EUTelPatternRecognition::propagateForwardFromSeedState(EUTelState& stateInp
 	EUTelState state = stateInput;
 	
 	if(rad == 0 ){ //If the estimated radiation length is 0 then we do not use the track.
-		return;
+		return numberOfHitsAdded;
 	}
 	//Here we loop through all the planes not excluded. We begin at the seed which might not be the first. Then we stop before the last plane, since we do not want to propagate anymore
 	bool firstLoop =true;//This is needed so we get the arclength to the next state on the first. Completing the state and adding.
@@ -123,50 +139,27 @@ void EUTelPatternRecognition::propagateForwardFromSeedState(EUTelState& stateInp
             track.print();
 		}
 		//So we have intersection lets create a new state
-		newState.setDimensionSize(_planeDimensions[newSensorID]);//We set this since we need this information for later processors
+		newState.setDimensionSize(_planeDimensions.at(newSensorID));//We set this since we need this information for later processors
 		newState.setLocation(newSensorID);
 		newState.setPositionGlobal(globalIntersection);
 		newState.setLocalMomentumGlobalMomentum(momentumAtIntersection);
         state = newState;//Set state here ready to propagate. It does not need hit information to do this.
 
-		if(_mapHitsVecPerPlane[geo::gGeometry().sensorZOrderToIDWithoutExcludedPlanes().at(i+1)].empty()){
+		if(_mapHitsVecPerPlane.at(geo::gGeometry().sensorZOrderToIDWithoutExcludedPlanes().at(i+1)).empty()){
 			streamlog_out(DEBUG5) << "There are no hits on the plane with this state. Add state to track as it is and move on." << std::endl;
 //			track.setState(newState); 
 //			state = newState;
 			continue;
 		}
-		EVENT::TrackerHit* closestHit = const_cast<EVENT::TrackerHit*>( findClosestHit(newState)); //This will look for the closest hit but not if it is within the excepted range		
-		double distance;
-		if(newState.getDimensionSize() == 2)
-		{
-			//This distance could be 2D or 1D depending on if you have a strip or pixel sensor. 
-			//Norm2Sqr does not square root for some reason.
-			distance = sqrt(computeResidual( newState, closestHit ).Norm2Sqr());
-		}
-		else if(newState.getDimensionSize() == 1)
-		{
-			//If strip sensor then use only displacement along strips, which should be x axis.
-			distance = computeResidual( newState, closestHit )[0];
-		}
-		else
-		{
-			throw(lcio::Exception( "The closest hit is not on a pixel or strip sensor. Since the dimensionality if less than 1 or greater than 2."));
-		}
-
-		const double DCA = getXYPredictionPrecision(newState);
-
-		streamlog_out ( DEBUG1 ) <<"At plane: "<<newState.getLocation() << ". Distance between state and hit: "<< distance <<" Must be less than: "<<DCA<< std::endl;
-		streamlog_out(DEBUG0) <<"Closest hit position: " << closestHit->getPosition()[0]<<" "<< closestHit->getPosition()[1]<<"  "<< closestHit->getPosition()[2]<<std::endl;
+		//This will look for the closest hit within the search window around the state
+		double distance = 0;
+		EVENT::TrackerHit* closestHit = const_cast<EVENT::TrackerHit*>( findClosestHit(newState, distance) );
 
-		if ( distance > DCA ) {
-			streamlog_out ( DEBUG1 ) << "Closest hit is outside of search window." << std::endl;
-//			track.setState(newState); 
-//			state = newState;
+		if ( closestHit == NULL ) {
+			streamlog_out ( DEBUG1 ) << "No hit inside of search window " << getXYPredictionPrecision(newState) << " at plane " << newState.getLocation() << std::endl;
 			continue;
 		}	
-		if(closestHit == NULL){
-			throw(lcio::Exception( "The closest hit you are trying to add is NULL. This can not be correct"));
-		}
+		streamlog_out(DEBUG0) <<"Closest hit position: " << closestHit->getPosition()[0]<<" "<< closestHit->getPosition()[1]<<"  "<< closestHit->getPosition()[2]<<std::endl;
 
 		streamlog_out ( DEBUG1 ) << "Found a hit with memory address: " << closestHit<<" and ID of " <<closestHit->id() <<" At a Distance: "<< distance<<" from state." << std::endl;
 		newState.setHit(closestHit);
@@ -176,7 +169,7 @@ void EUTelPatternRecognition::propagateForwardFromSeedState(EUTelState& stateInp
             state.setLocalMomentumGlobalMomentum(momGlobal);
             calcDirection=false;
         }
-		_totalNumberOfHits++;//This is used for test of the processor later.   
+		numberOfHitsAdded++;//This is used for test of the processor later.   
 //		streamlog_out(DEBUG2) << "This is the memory location of the state: "<< newState << std::endl;
 
 //		track.setState(newState);//Need to return this to LCIO object. Loss functionality but retain information 
@@ -191,7 +184,7 @@ void EUTelPatternRecognition::propagateForwardFromSeedState(EUTelState& stateInp
 	setRadLengths(track, mapSensor, mapAir, rad);
     streamlog_out ( DEBUG1 ) << "ADD SCATTERING TO TRACKS: "<< std::endl;
     track.print();
-
+	return numberOfHitsAdded;
 }
 //setRadLengths: This will determine the variance fraction each scatterer will get. Note this comes in two parts. The first is the plane and the next scattering from the air.    
 void EUTelPatternRecognition::setRadLengths(EUTelTrack & track,	std::map<const int,double>  mapSensor, std::map<const int ,double>  mapAir, double rad ){
@@ -426,25 +419,41 @@ void EUTelPatternRecognition::testInitialSeeds(){
 	}
 }
 //Loop through each plane that contains seeds and then each seed. From that seed you then create a track.
+//The seeds are independent, so they are shared over the thread pool if one is set. Each seed has its own slot for the track,
+//therefore the list of tracks is in the same order as with a single thread.
 void EUTelPatternRecognition::findTrackCandidates() {
 	streamlog_out(MESSAGE1) << "EUTelPatternRecognition::findTrackCandidates()" << std::endl;
 	clearTrackAndTrackStates(); //Clear all past track information
+	std::vector<EUTelState*> seeds;
 	for(size_t i = 0 ; i < _mapSensorIDToSeedStatesVec.size(); ++i){
-		std::vector<EUTelState> statesVec =  _mapSensorIDToSeedStatesVec[_createSeedsFromPlanes[i]]; 	
+		std::vector<EUTelState>& statesVec =  _mapSensorIDToSeedStatesVec[_createSeedsFromPlanes[i]]; 	
 		if(statesVec.size() == 0){
 			streamlog_out(MESSAGE5) << "The size of state Vector seeds is zero. try next seed plane"<<std::endl; 
 			continue;
 		}
 		for(size_t j = 0 ; j < statesVec.size() ; ++j){
-			EUTelTrack track;
-			propagateForwardFromSeedState(statesVec[j], track);
-//			streamlog_out ( DEBUG1 ) << "Before adding track to vector "<< std::endl;
-			_tracks.push_back(track);//Here we create a long list of possible tracks
-//			streamlog_out ( DEBUG1 ) << "After adding track to vector "<< std::endl;
-
+			seeds.push_back(&statesVec[j]);
+		}
+	}
 
+	SeedPropagationJob job(*this, seeds);
+	//TGeo navigation and the debug output can not be shared between threads. Then we stay on this thread.
+	if(_threadPool != NULL && geo::gGeometry().useAnalyticNavigation() && !streamlog::out.write<streamlog::DEBUG9>())
+	{
+		geo::gGeometry().cacheAllPlaneTransforms();
+		_threadPool->run(job, seeds.size());
+	}
+	else
+	{
+		for(size_t i = 0 ; i < seeds.size() ; ++i){
+			job.process(i, 0);
 		}
 	}
+
+	for(size_t i = 0 ; i < seeds.size() ; ++i){
+		_tracks.push_back(job.tracks[i]);//Here we create a long list of possible tracks
+		_totalNumberOfHits += job.numberOfHitsAdded[i];
+	}
 	streamlog_out(MESSAGE1) << "EUTelPatternRecognition::findTrackCandidates()------END" << std::endl;
 }
 
@@ -478,9 +487,11 @@ void EUTelPatternRecognition::findTracksWithEnoughHits(){
 }
 //This creates map between plane ID and hits on that plane. 
 //We also order the map correcly with geometry.
+//In the same pass the hits of each plane are sorted by their local x position for findClosestHit.
 void EUTelPatternRecognition::setHitsVecPerPlane()
 {
 	_mapHitsVecPerPlane.clear();
+	_mapHitIndexPerPlane.clear();
 	int numberOfPlanes = geo::gGeometry().sensorZOrderToIDWithoutExcludedPlanes().size();
 	
 	if(numberOfPlanes == 0)
@@ -492,18 +503,34 @@ void EUTelPatternRecognition::setHitsVecPerPlane()
 		throw(lcio::Exception( "The number of hits is zero."));
 	}
 
+	//every plane gets an entry, even without hits
 	for(int i=0 ; i<numberOfPlanes;++i)
 	{
-		EVENT::TrackerHitVec tempHitsVecPlaneX; 
-		for(size_t j=0 ; j<_allHitsVec.size();++j)
-		{
-			if(Utility::getSensorIDfromHit( static_cast<IMPL::TrackerHitImpl*>(_allHitsVec[j]) ) ==  geo::gGeometry().sensorZOrderToIDWithoutExcludedPlanes().at(i))
-			{
-				tempHitsVecPlaneX.push_back(_allHitsVec.at(j));
-			}
-		}
-		_mapHitsVecPerPlane[ geo::gGeometry().sensorZOrderToIDWithoutExcludedPlanes().at(i)] = 	tempHitsVecPlaneX;
+		const int planeID = geo::gGeometry().sensorZOrderToIDWithoutExcludedPlanes().at(i);
+		_mapHitsVecPerPlane[planeID] = EVENT::TrackerHitVec();
+		_mapHitIndexPerPlane[planeID] = std::vector<IndexedHit>();
+	}
+
+	for(size_t j=0 ; j<_allHitsVec.size();++j)
+	{
+		const int planeID = Utility::getSensorIDfromHit( static_cast<IMPL::TrackerHitImpl*>(_allHitsVec[j]) );
+		std::map<int ,EVENT::TrackerHitVec>::iterator planeIt = _mapHitsVecPerPlane.find(planeID);
+		if( planeIt == _mapHitsVecPerPlane.end() ) continue; //excluded plane
+
+		std::vector<IndexedHit>& planeIndex = _mapHitIndexPerPlane[planeID];
+		IndexedHit indexedHit;
+		indexedHit.x = _allHitsVec[j]->getPosition()[0];
+		indexedHit.y = _allHitsVec[j]->getPosition()[1];
+		indexedHit.index = planeIt->second.size();
+		indexedHit.hit = _allHitsVec[j];
+		planeIndex.push_back(indexedHit);
+		planeIt->second.push_back(_allHitsVec[j]);
 	}	
+
+	for(std::map<int, std::vector<IndexedHit> >::iterator it = _mapHitIndexPerPlane.begin(); it != _mapHitIndexPerPlane.end(); ++it)
+	{
+		std::sort(it->second.begin(), it->second.end());
+	}
 }
 
 std::vector<EUTelTrack> EUTelPatternRecognition::getSeedTracks(){
@@ -629,33 +656,45 @@ void EUTelPatternRecognition::testPlaneDimensions(){
      * @return hit closest to the intersection of the track with the sensor plane
      * 
 	 */
-const EVENT::TrackerHit* EUTelPatternRecognition::findClosestHit(EUTelState& state)
+const EVENT::TrackerHit* EUTelPatternRecognition::findClosestHit(EUTelState& state, double& distance)
 {
-	EVENT::TrackerHitVec& hitInPlane = _mapHitsVecPerPlane[state.getLocation()];
-	double maxDistance = std::numeric_limits<double>::max();
-	EVENT::TrackerHitVec::const_iterator itClosestHit;
-	EVENT::TrackerHitVec::const_iterator itHit;
-
-	streamlog_out(DEBUG0) << "N hits in plane " << state.getLocation() << ": " << hitInPlane.size() << std::endl;
+	const std::vector<IndexedHit>& hitIndex = _mapHitIndexPerPlane.at(state.getLocation());
+	const double window = getXYPredictionPrecision(state);
+	const float* statePosition = state.getPosition();
+	const double stateX = statePosition[0];
+	const double stateY = statePosition[1];
+	const int dimension = state.getDimensionSize();
+
+	if(dimension != 1 && dimension != 2){
+		throw(lcio::Exception( "When finding the closest hit to predicted state we find a hit which is not a strip or pixel sensor. Since the dimensionality if less than 1 or greater than 2."));
+	}
 
-	for ( itHit = hitInPlane.begin(); itHit != hitInPlane.end(); ++itHit ) {
-		double distance;
-		if(state.getDimensionSize() == 2){
-			distance = sqrt(computeResidual( state, *itHit ).Norm2Sqr());//This distance could be 2D or 1D depending on if you have a strip or pixel sensor. Norm2Sqr does not square toot for some reason.
-		}else if(state.getDimensionSize() == 1){
-			distance = computeResidual( state, *itHit )[0];//If strip sensor then use only displacement along strips. Which should be x axis.
-		}else{
-			throw(lcio::Exception( "When finding the closest hit to predicted state we find a hit which is not a strip or pixel sensor. Since the dimensionality if less than 1 or greater than 2."));
-		}
-		streamlog_out(DEBUG0) << "Distance^2 between hit and track intersection: " << distance << std::endl;
-		if ( distance < maxDistance ) {
-			itClosestHit = itHit;
-			maxDistance = distance;
+	streamlog_out(DEBUG0) << "N hits in plane " << state.getLocation() << ": " << hitIndex.size() << std::endl;
+
+	//only hits with |x - stateX| <= window can be inside the search window
+	IndexedHit lowest;
+	lowest.x = stateX - window;
+	std::vector<IndexedHit>::const_iterator itHit = std::lower_bound(hitIndex.begin(), hitIndex.end(), lowest);
+
+	const IndexedHit* closest = NULL;
+	double minDistance = std::numeric_limits<double>::max();
+	for( ; itHit != hitIndex.end() && itHit->x <= stateX + window; ++itHit ) {
+		const double dX = itHit->x - stateX;
+		const double dY = itHit->y - stateY;
+		//This distance could be 2D or 1D depending on if you have a strip or pixel sensor. For strips only the displacement along x is used.
+		const double hitDistance = ( dimension == 2 ) ? std::sqrt(dX*dX + dY*dY) : std::fabs(dX);
+		if( hitDistance > window ) continue;
+		//on equal distance the hit stored first wins, as in the plain scan over the plane
+		if( hitDistance < minDistance || ( hitDistance == minDistance && itHit->index < closest->index ) ) {
+			closest = &(*itHit);
+			minDistance = hitDistance;
 		}
 	}
-	streamlog_out(DEBUG0) << "Minimal distance^2 between hit and track intersection: " << maxDistance << std::endl;
+	streamlog_out(DEBUG0) << "Minimal distance between hit and track intersection: " << minDistance << std::endl;
 
-	return *itClosestHit;
+	if( closest == NULL ) return NULL;
+	distance = minDistance;
+	return closest->hit;
 }
 
 //TODO: Need proper error analysis to calculate this rather than providing an answer.  
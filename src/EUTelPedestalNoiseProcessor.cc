@@ -15,6 +15,7 @@
 #include "EUTelEventImpl.h"
 #include "EUTelPedestalNoiseProcessor.h"
 #include "EUTelHistogramManager.h"
+#include "EUTelCalibrationKernels.h"
 #include "EUTELESCOPE.h"
 
 // marlin includes ".h"
@@ -160,6 +161,12 @@ EUTelPedestalNoiseProcessor::EUTelPedestalNoiseProcessor () :Processor("EUTelPed
   registerOptionalParameter ("HitRejectionPreLoop",
                              "Perform a fast first loop to improve the efficiency of hit rejection",
                              _preLoopSwitch, static_cast< bool > ( true ) ) ;
+  registerOptionalParameter ("SinglePassCalculation",
+                             "Read the input only once, using running estimators instead of rewinding for each loop (only MeanRMS)",
+                             _singlePassSwitch, static_cast< bool > ( false ) );
+  registerOptionalParameter ("StreamingReservoirSize",
+                             "Number of events kept in memory for the loops of the single pass calculation",
+                             _reservoirSize, static_cast< int > ( 200 ) );
 
 
   registerProcessorParameter ("FirstEvent",
@@ -236,6 +243,26 @@ void EUTelPedestalNoiseProcessor::init () {
     _maxValue.clear();
   }
 
+  if ( _singlePassSwitch ) {
+    // the pre loop is done on the reservoir
+    _iLoop = 0;
+    if ( _pedestalAlgo != EUTELESCOPE::MEANRMS ) {
+      streamlog_out ( ERROR0 )  << "The " << _pedestalAlgo
+                                << " algorithm cannot be applied in the single pass calculation" << endl
+                                << " Algorithm changed to " << EUTELESCOPE::MEANRMS << endl;
+      _pedestalAlgo = EUTELESCOPE::MEANRMS;
+    }
+    if ( _reservoirSize < 1 ) {
+      streamlog_out ( ERROR0 ) << "StreamingReservoirSize has to be positive, using 1" << endl;
+      _reservoirSize = 1;
+    }
+    _reservoir.clear();
+    _reservoirSkipped.clear();
+    _runningMean.clear();
+    _runningM2.clear();
+    _runningEntries.clear();
+  }
+
 
   // reset all the final arrays
   _pedestal.clear();
@@ -296,6 +323,9 @@ void EUTelPedestalNoiseProcessor::processRunHeader (LCRunHeader * rdr) {
   int additionalLoop = 0;
   if ( _additionalMaskingLoop ) additionalLoop = 1;
 
+  // in the single pass calculation every record is read once
+  const int noOfPasses = _singlePassSwitch ? 1 : _noOfCMIterations + 1 + additionalLoop;
+
   if ( _lastEvent == -1 ) {
     // the user didn't select an upper limit for the event range, so
     // we don't know on how many events the calculation should be done
@@ -307,7 +337,7 @@ void EUTelPedestalNoiseProcessor::processRunHeader (LCRunHeader * rdr) {
       streamlog_out ( WARNING2 )  << "The MaxRecordNumber in the Global section of the steering file has been set to "
                                   << maxRecordNumber << ".\n"
                                   << "This means that in order to properly perform the pedestal calculation the maximum allowed number of events is "
-                                  << maxRecordNumber / ( _noOfCMIterations + 1 + additionalLoop ) << ".\n"
+                                  << maxRecordNumber / noOfPasses << ".\n"
                                   << "Let's hope it is correct and try to continue." << endl;
     }
   } else {
@@ -315,10 +345,10 @@ void EUTelPedestalNoiseProcessor::processRunHeader (LCRunHeader * rdr) {
     // we can compare this number with the maxRecordNumber if
     // different from 0
     if ( maxRecordNumber != 0 ) {
-      if ( (_lastEvent - _firstEvent) * ( _noOfCMIterations + 1 + additionalLoop ) > maxRecordNumber ) {
+      if ( (_lastEvent - _firstEvent) * noOfPasses > maxRecordNumber ) {
         streamlog_out ( ERROR4 ) << "The pedestal calculation should be done on " << _lastEvent - _firstEvent
-                                 << " times " <<  _noOfCMIterations + 1 << " iterations = "
-                                 << (_lastEvent - _firstEvent) * ( _noOfCMIterations + 1 + additionalLoop ) << " records.\n"
+                                 << " times " <<  noOfPasses << " iterations = "
+                                 << (_lastEvent - _firstEvent) * noOfPasses << " records.\n"
                                  << "The global variable MarRecordNumber is limited to " << maxRecordNumber << endl;
         throw InvalidParameterException("MaxRecordNumber");
       }
@@ -425,7 +455,8 @@ void EUTelPedestalNoiseProcessor::processEvent (LCEvent * evt) {
                                << " is of unknown type. Continue considering it as a normal Data Event." << endl;
   }
 
-  if ( _iLoop == -1 ) preLoop( evt );
+  if ( _singlePassSwitch ) singlePassLoop( evt );
+  else if ( _iLoop == -1 ) preLoop( evt );
   else if ( _iLoop == 0 ) firstLoop(evt);
   else if ( _additionalMaskingLoop ) {
     if ( _iLoop == _noOfCMIterations + 1 ) {
@@ -451,6 +482,12 @@ void EUTelPedestalNoiseProcessor::end() {
 
   int additionalLoop = 0;
   if ( _additionalMaskingLoop ) additionalLoop = 1;
+
+  // without EORE and LastEvent the single pass is completed here
+  if ( _singlePassSwitch && !_status.empty() && ( _iLoop < _noOfCMIterations + 1 + additionalLoop ) ) {
+    finalizeSinglePass();
+  }
+
   if ( _iLoop == _noOfCMIterations + 1 + additionalLoop )  {
     streamlog_out ( MESSAGE4 ) << "Successfully finished" << endl;
   }  else {
@@ -1076,129 +1113,13 @@ void EUTelPedestalNoiseProcessor::otherLoop(LCEvent * event) {
         // is that instead of using, as before, a single value of
         // common mode per matrix, we will have a vector of floats
         // containing the common mode correction for each pixel
-        vector< float > commonModeCorVec;
-        commonModeCorVec.clear();
-
-        bool isEventValid = true;
+        FloatVec commonModeCorVec;
         int    skippedPixel = 0;
         int    skippedRow   = 0;
 
         size_t detectorOffset = ( iCol == 0 ) ? 0 : _noOfDetectorVec.at( iCol - 1 );
 
-        if ( _commonModeAlgo == EUTELESCOPE::FULLFRAME ) {
-
-          double pixelSum     = 0.;
-          double commonMode   = 0.;
-          int    goodPixel    = 0;
-          int    iPixel       = 0;
-
-          // start looping on all pixels for hit rejection
-          for (int yPixel = _minY[iDetector + detectorOffset ]; yPixel <= _maxY[iDetector + detectorOffset ]; yPixel++) {
-            for (int xPixel = _minX[iDetector + detectorOffset ]; xPixel <= _maxX[iDetector + detectorOffset ]; xPixel++) {
-              bool isHit  = ( ( adcValues[iPixel] - _pedestal[iDetector + detectorOffset][iPixel] ) > _hitRejectionCut * _noise[iDetector + detectorOffset][iPixel] );
-              bool isGood = ( _status[iDetector + detectorOffset ][iPixel] == EUTELESCOPE::GOODPIXEL );
-              if ( !isHit && isGood ) {
-                pixelSum += adcValues[iPixel] - _pedestal[iDetector + detectorOffset ][iPixel];
-                ++goodPixel;
-              } else if ( isHit ) {
-                ++skippedPixel;
-              }
-              ++iPixel;
-            }
-          }
-
-          if ( ( skippedPixel < _maxNoOfRejectedPixels ) &&
-               ( goodPixel != 0 ) ) {
-
-            commonMode = pixelSum / goodPixel;
-            commonModeCorVec.insert( commonModeCorVec.begin(), iPixel + 1 , commonMode );
-            isEventValid = true;
-
-#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
-              string histoname = _commonModeHistoName + "_d" + to_string( _orderedSensorIDVec.at( iDetector + detectorOffset ) )
-                + "_l" + to_string( _iLoop );
-              AIDA::IHistogram1D * histo = (dynamic_cast<AIDA::IHistogram1D*>(_aidaHistoMap[ histoname ]));
-              if ( histo ) {
-                histo->fill(commonMode);
-              }
-#endif
-
-          } else {
-
-            isEventValid = false;
-
-          }
-
-        } else if ( _commonModeAlgo == EUTELESCOPE::ROWWISE ) {
-
-          int    iPixel       = 0;
-          int    colCounter   = 0;
-          int    rowLength    = _maxX[iDetector + detectorOffset] -  _minX[iDetector + detectorOffset] + 1;
-
-          for (int yPixel = _minY[iDetector + detectorOffset]; yPixel <= _maxY[iDetector + detectorOffset]; yPixel++) {
-
-            double pixelSum           = 0.;
-            double commonMode         = 0.;
-            int    goodPixel          = 0;
-            int    skippedPixelPerRow = 0;
-
-            for ( int xPixel = _minX[iDetector + detectorOffset]; xPixel <= _maxX[iDetector + detectorOffset]; xPixel++) {
-              bool isHit  = ( ( adcValues[iPixel] - _pedestal[iDetector + detectorOffset][iPixel] ) > _hitRejectionCut * _noise[iDetector + detectorOffset][iPixel] );
-              bool isGood = ( _status[iDetector + detectorOffset][iPixel] == EUTELESCOPE::GOODPIXEL );
-              if ( !isHit && isGood ) {
-                pixelSum += adcValues[iPixel] - _pedestal[iDetector + detectorOffset][iPixel];
-                ++goodPixel;
-              } else if ( isHit ) {
-                ++skippedPixelPerRow;
-                ++skippedPixel;
-              }
-              ++iPixel;
-            }
-
-            // we are now at the end of the row, so let's calculate the
-            // common mode
-            if ( ( skippedPixelPerRow < _maxNoOfRejectedPixelPerRow ) &&
-                 ( goodPixel != 0 ) ) {
-              commonMode = pixelSum / goodPixel ;
-              commonModeCorVec.insert( commonModeCorVec.begin() + colCounter * rowLength, rowLength, commonMode );
-
-#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
-              string histoname = _commonModeHistoName + "_d" + to_string( _orderedSensorIDVec.at( iDetector + detectorOffset ) )
-                + "_l" + to_string( _iLoop );
-              AIDA::IHistogram1D * histo = (dynamic_cast<AIDA::IHistogram1D*>(_aidaHistoMap[ histoname ]));
-              if ( histo ) {
-                histo->fill(commonMode);
-              }
-#endif
-
-            } else {
-              commonModeCorVec.insert( commonModeCorVec.begin() + colCounter * rowLength, rowLength, 0. );
-              ++skippedRow;
-            }
-
-            ++colCounter;
-          }
-
-
-          if ( skippedRow < _maxNoOfSkippedRow ) {
-
-            isEventValid = true;
-
-          } else {
-
-            isEventValid = false;
-
-          }
-
-        } else {
-          streamlog_out ( ERROR4 ) << "Unknown common mode algorithm. Using flat null correction" << endl;
-          commonModeCorVec.insert( commonModeCorVec.begin(),
-                                   ( _maxY[iDetector + detectorOffset] - _minY[iDetector + detectorOffset] + 1 ) *
-                                   ( _maxX[iDetector + detectorOffset] - _minX[iDetector + detectorOffset] + 1 ),
-                                   0. );
-          isEventValid = true;
-        }
-
+        bool isEventValid = calculateCommonMode( iDetector + detectorOffset, adcValues, commonModeCorVec, skippedPixel, skippedRow );
 
         if ( isEventValid ) {
 
@@ -1267,6 +1188,96 @@ void EUTelPedestalNoiseProcessor::otherLoop(LCEvent * event) {
 
 }
 
+bool EUTelPedestalNoiseProcessor::calculateCommonMode( size_t iDetector, const ShortVec & adcValues, FloatVec & commonModeCorVec,
+                                                       int & skippedPixel, int & skippedRow ) {
+
+  const int rowLength = _maxX[iDetector] - _minX[iDetector] + 1;
+  const int noOfRows  = _maxY[iDetector] - _minY[iDetector] + 1;
+
+  commonModeCorVec.assign( rowLength * noOfRows, 0. );
+  skippedPixel = 0;
+  skippedRow   = 0;
+
+  const FloatVec & pedestal   = _pedestal[iDetector];
+  const FloatVec & noise      = _noise[iDetector];
+  const ShortVec & status     = _status[iDetector];
+  const short      goodStatus = static_cast< short >( EUTELESCOPE::GOODPIXEL );
+
+  bool isEventValid = true;
+
+  if ( _commonModeAlgo == EUTELESCOPE::FULLFRAME ) {
+
+    // hit rejection and sum over the whole frame
+    int    goodPixel = 0;
+    double pixelSum  = CalibrationKernels::commonModeSum( &adcValues[0], &pedestal[0], &noise[0], &status[0],
+                                                          rowLength * noOfRows, _hitRejectionCut, goodStatus,
+                                                          goodPixel, skippedPixel );
+
+    if ( ( skippedPixel < _maxNoOfRejectedPixels ) &&
+         ( goodPixel != 0 ) ) {
+
+      double commonMode = pixelSum / goodPixel;
+      commonModeCorVec.assign( rowLength * noOfRows, commonMode );
+      isEventValid = true;
+
+#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+      string histoname = _commonModeHistoName + "_d" + to_string( _orderedSensorIDVec.at( iDetector ) )
+        + "_l" + to_string( _iLoop );
+      AIDA::IHistogram1D * histo = (dynamic_cast<AIDA::IHistogram1D*>(_aidaHistoMap[ histoname ]));
+      if ( histo ) {
+        histo->fill(commonMode);
+      }
+#endif
+
+    } else {
+
+      isEventValid = false;
+
+    }
+
+  } else if ( _commonModeAlgo == EUTELESCOPE::ROWWISE ) {
+
+    for ( int iRow = 0; iRow < noOfRows; iRow++ ) {
+
+      const int rowBegin           = iRow * rowLength;
+      int       goodPixel          = 0;
+      int       skippedPixelPerRow = 0;
+      double    pixelSum           = CalibrationKernels::commonModeSum( &adcValues[rowBegin], &pedestal[rowBegin], &noise[rowBegin],
+                                                                        &status[rowBegin], rowLength, _hitRejectionCut, goodStatus,
+                                                                        goodPixel, skippedPixelPerRow );
+      skippedPixel += skippedPixelPerRow;
+
+      // we are now at the end of the row, so let's calculate the
+      // common mode
+      if ( ( skippedPixelPerRow < _maxNoOfRejectedPixelPerRow ) &&
+           ( goodPixel != 0 ) ) {
+        double commonMode = pixelSum / goodPixel ;
+        std::fill( commonModeCorVec.begin() + iRow * rowLength, commonModeCorVec.begin() + ( iRow + 1 ) * rowLength, commonMode );
+
+#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+        string histoname = _commonModeHistoName + "_d" + to_string( _orderedSensorIDVec.at( iDetector ) )
+          + "_l" + to_string( _iLoop );
+        AIDA::IHistogram1D * histo = (dynamic_cast<AIDA::IHistogram1D*>(_aidaHistoMap[ histoname ]));
+        if ( histo ) {
+          histo->fill(commonMode);
+        }
+#endif
+
+      } else {
+        ++skippedRow;
+      }
+    }
+
+    isEventValid = ( skippedRow < _maxNoOfSkippedRow );
+
+  } else {
+    streamlog_out ( ERROR4 ) << "Unknown common mode algorithm. Using flat null correction" << endl;
+    isEventValid = true;
+  }
+
+  return isEventValid;
+}
+
 void EUTelPedestalNoiseProcessor::bookHistos() {
 
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
@@ -1622,28 +1633,8 @@ void EUTelPedestalNoiseProcessor::finalizeProcessor(bool fromMaskingLoop) {
     // here refill the status histoMap
     maskBadPixel();
 
-#if defined(MARLIN_USE_AIDA) || defined(USE_AIDA)
     // fill only the status map histograms
-    string tempHistoName;
-    for (size_t iDetector = 0; iDetector < _noOfDetector; iDetector++) {
-      int iPixel = 0;
-      for (int yPixel = _minY[iDetector]; yPixel <= _maxY[iDetector]; yPixel++) {
-        for (int xPixel = _minX[iDetector]; xPixel <= _maxX[iDetector]; xPixel++) {
-          if ( _histogramSwitch ) {
-            tempHistoName =  _statusMapHistoName + "_d" + to_string( _orderedSensorIDVec.at( iDetector ) ) + "_l" + to_string( _iLoop );
-            if ( AIDA::IHistogram2D * histo = dynamic_cast<AIDA::IHistogram2D*>(_aidaHistoMap[tempHistoName]) ) {
-              histo->fill(static_cast<double>(xPixel), static_cast<double>(yPixel), static_cast<double> (_status[iDetector][iPixel]));
-            } else {
-              streamlog_out ( ERROR1 )  << "Not able to retrieve histogram pointer for " << tempHistoName
-                                        << ".\nDisabling histogramming from now on " << endl;
-              _histogramSwitch = false;
-            }
-            ++iPixel;
-          }
-        }
-      }
-    }
-#endif
+    fillStatusMapHistos();
   }
 
 
@@ -1661,111 +1652,7 @@ void EUTelPedestalNoiseProcessor::finalizeProcessor(bool fromMaskingLoop) {
     // ok this was last loop whatever kind of loop (first, other or
     // additional) it was.
 
-    streamlog_out ( MESSAGE4 ) << "Writing the output condition file" << endl;
-
-    LCWriter * lcWriter = LCFactory::getInstance()->createLCWriter();
-
-    try {
-      lcWriter->open(_outputPedeFileName,LCIO::WRITE_APPEND);
-    } catch (IOException& e) {
-      cerr << e.what() << endl;
-      return;
-    }
-
-    LCEventImpl * event = new LCEventImpl();
-    event->setDetectorName(_detectorName);
-    event->setRunNumber(_iRun);
-
-    LCTime * now = new LCTime;
-    event->setTimeStamp(now->timeStamp());
-    delete now;
-
-
-    LCCollectionVec * pedestalCollection = new LCCollectionVec(LCIO::TRACKERDATA);
-    LCCollectionVec * noiseCollection    = new LCCollectionVec(LCIO::TRACKERDATA);
-    LCCollectionVec * statusCollection   = new LCCollectionVec(LCIO::TRACKERRAWDATA);
-
-    for ( size_t iDetector = 0; iDetector < _noOfDetector; iDetector++) {
-
-      TrackerDataImpl    * pedestalMatrix = new TrackerDataImpl;
-      TrackerDataImpl    * noiseMatrix    = new TrackerDataImpl;
-      TrackerRawDataImpl * statusMatrix   = new TrackerRawDataImpl;
-
-      CellIDEncoder<TrackerDataImpl>    idPedestalEncoder(EUTELESCOPE::MATRIXDEFAULTENCODING, pedestalCollection);
-      CellIDEncoder<TrackerDataImpl>    idNoiseEncoder(EUTELESCOPE::MATRIXDEFAULTENCODING, noiseCollection);
-      CellIDEncoder<TrackerRawDataImpl> idStatusEncoder(EUTELESCOPE::MATRIXDEFAULTENCODING, statusCollection);
-
-      idPedestalEncoder["sensorID"] = _orderedSensorIDVec.at( iDetector );
-      idNoiseEncoder["sensorID"]    = _orderedSensorIDVec.at( iDetector );
-      idStatusEncoder["sensorID"]   = _orderedSensorIDVec.at( iDetector );
-      idPedestalEncoder["xMin"]     = _minX[iDetector];
-      idNoiseEncoder["xMin"]        = _minX[iDetector];
-      idStatusEncoder["xMin"]       = _minX[iDetector];
-      idPedestalEncoder["xMax"]     = _maxX[iDetector];
-      idNoiseEncoder["xMax"]        = _maxX[iDetector];
-      idStatusEncoder["xMax"]       = _maxX[iDetector];
-      idPedestalEncoder["yMin"]     = _minY[iDetector];
-      idNoiseEncoder["yMin"]        = _minY[iDetector];
-      idStatusEncoder["yMin"]       = _minY[iDetector];
-      idPedestalEncoder["yMax"]     = _maxY[iDetector];
-      idNoiseEncoder["yMax"]        = _maxY[iDetector];
-      idStatusEncoder["yMax"]       = _maxY[iDetector];
-      idPedestalEncoder.setCellID(pedestalMatrix);
-      idNoiseEncoder.setCellID(noiseMatrix);
-      idStatusEncoder.setCellID(statusMatrix);
-
-      pedestalMatrix->setChargeValues(_pedestal[iDetector]);
-      noiseMatrix->setChargeValues(_noise[iDetector]);
-      statusMatrix->setADCValues(_status[iDetector]);
-
-      pedestalCollection->push_back(pedestalMatrix);
-      noiseCollection->push_back(noiseMatrix);
-      statusCollection->push_back(statusMatrix);
-
-      if ( _asciiOutputSwitch ) {
-        if ( iDetector == 0 ) streamlog_out ( MESSAGE4 ) << "Writing the ASCII pedestal files" << endl;
-        stringstream ss;
-        ss << _outputPedeFileName << "-b" << iDetector << ".dat";
-        ofstream asciiPedeFile(ss.str().c_str());
-        asciiPedeFile << "# Pedestal and noise for board number " << iDetector << endl
-                      << "# calculated from run " << _outputPedeFileName << endl;
-
-        const int subMatrixWidth = 3;
-        const int xPixelWidth    = 4;
-        const int yPixelWidth    = 4;
-        const int pedeWidth      = 15;
-        const int noiseWidth     = 15;
-        const int statusWidth    = 3;
-        const int precision      = 8;
-
-        int iPixel = 0;
-        for (int yPixel = _minY[iDetector]; yPixel <= _maxY[iDetector]; yPixel++) {
-          for (int xPixel = _minX[iDetector]; xPixel <= _maxX[iDetector]; xPixel++) {
-            asciiPedeFile << setiosflags(ios::left)
-                          << setw(subMatrixWidth) << iDetector
-                          << setw(xPixelWidth)    << xPixel
-                          << setw(yPixelWidth)    << yPixel
-                          << resetiosflags(ios::left) << setiosflags(ios::fixed) << setprecision(precision)
-                          << setw(pedeWidth)      << _pedestal[iDetector][iPixel]
-                          << setw(noiseWidth)     << _noise[iDetector][iPixel]
-                          << resetiosflags(ios::fixed)
-                          << setw(statusWidth)    << _status[iDetector][iPixel]
-                          << endl;
-            ++iPixel;
-          }
-        }
-        asciiPedeFile.close();
-      }
-    }
-
-    event->addCollection(pedestalCollection, _pedestalCollectionName);
-    event->addCollection(noiseCollection, _noiseCollectionName);
-    event->addCollection(statusCollection, _statusCollectionName);
-
-    lcWriter->writeEvent(event);
-    delete event;
-
-    lcWriter->close();
+    writeOutputFile();
 
     throw StopProcessingException(this);
     setReturnValue("IsPedestalFinished", true);
@@ -1821,6 +1708,142 @@ void EUTelPedestalNoiseProcessor::finalizeProcessor(bool fromMaskingLoop) {
   }
 }
 
+void EUTelPedestalNoiseProcessor::fillStatusMapHistos() {
+
+#if defined(MARLIN_USE_AIDA) || defined(USE_AIDA)
+  string tempHistoName;
+  for (size_t iDetector = 0; iDetector < _noOfDetector; iDetector++) {
+    int iPixel = 0;
+    for (int yPixel = _minY[iDetector]; yPixel <= _maxY[iDetector]; yPixel++) {
+      for (int xPixel = _minX[iDetector]; xPixel <= _maxX[iDetector]; xPixel++) {
+        if ( _histogramSwitch ) {
+          tempHistoName =  _statusMapHistoName + "_d" + to_string( _orderedSensorIDVec.at( iDetector ) ) + "_l" + to_string( _iLoop );
+          if ( AIDA::IHistogram2D * histo = dynamic_cast<AIDA::IHistogram2D*>(_aidaHistoMap[tempHistoName]) ) {
+            histo->fill(static_cast<double>(xPixel), static_cast<double>(yPixel), static_cast<double> (_status[iDetector][iPixel]));
+          } else {
+            streamlog_out ( ERROR1 )  << "Not able to retrieve histogram pointer for " << tempHistoName
+                                      << ".\nDisabling histogramming from now on " << endl;
+            _histogramSwitch = false;
+          }
+          ++iPixel;
+        }
+      }
+    }
+  }
+#endif
+
+}
+
+void EUTelPedestalNoiseProcessor::writeOutputFile() {
+
+  streamlog_out ( MESSAGE4 ) << "Writing the output condition file" << endl;
+
+  LCWriter * lcWriter = LCFactory::getInstance()->createLCWriter();
+
+  try {
+    lcWriter->open(_outputPedeFileName,LCIO::WRITE_APPEND);
+  } catch (IOException& e) {
+    cerr << e.what() << endl;
+    return;
+  }
+
+  LCEventImpl * event = new LCEventImpl();
+  event->setDetectorName(_detectorName);
+  event->setRunNumber(_iRun);
+
+  LCTime * now = new LCTime;
+  event->setTimeStamp(now->timeStamp());
+  delete now;
+
+
+  LCCollectionVec * pedestalCollection = new LCCollectionVec(LCIO::TRACKERDATA);
+  LCCollectionVec * noiseCollection    = new LCCollectionVec(LCIO::TRACKERDATA);
+  LCCollectionVec * statusCollection   = new LCCollectionVec(LCIO::TRACKERRAWDATA);
+
+  for ( size_t iDetector = 0; iDetector < _noOfDetector; iDetector++) {
+
+    TrackerDataImpl    * pedestalMatrix = new TrackerDataImpl;
+    TrackerDataImpl    * noiseMatrix    = new TrackerDataImpl;
+    TrackerRawDataImpl * statusMatrix   = new TrackerRawDataImpl;
+
+    CellIDEncoder<TrackerDataImpl>    idPedestalEncoder(EUTELESCOPE::MATRIXDEFAULTENCODING, pedestalCollection);
+    CellIDEncoder<TrackerDataImpl>    idNoiseEncoder(EUTELESCOPE::MATRIXDEFAULTENCODING, noiseCollection);
+    CellIDEncoder<TrackerRawDataImpl> idStatusEncoder(EUTELESCOPE::MATRIXDEFAULTENCODING, statusCollection);
+
+    idPedestalEncoder["sensorID"] = _orderedSensorIDVec.at( iDetector );
+    idNoiseEncoder["sensorID"]    = _orderedSensorIDVec.at( iDetector );
+    idStatusEncoder["sensorID"]   = _orderedSensorIDVec.at( iDetector );
+    idPedestalEncoder["xMin"]     = _minX[iDetector];
+    idNoiseEncoder["xMin"]        = _minX[iDetector];
+    idStatusEncoder["xMin"]       = _minX[iDetector];
+    idPedestalEncoder["xMax"]     = _maxX[iDetector];
+    idNoiseEncoder["xMax"]        = _maxX[iDetector];
+    idStatusEncoder["xMax"]       = _maxX[iDetector];
+    idPedestalEncoder["yMin"]     = _minY[iDetector];
+    idNoiseEncoder["yMin"]        = _minY[iDetector];
+    idStatusEncoder["yMin"]       = _minY[iDetector];
+    idPedestalEncoder["yMax"]     = _maxY[iDetector];
+    idNoiseEncoder["yMax"]        = _maxY[iDetector];
+    idStatusEncoder["yMax"]       = _maxY[iDetector];
+    idPedestalEncoder.setCellID(pedestalMatrix);
+    idNoiseEncoder.setCellID(noiseMatrix);
+    idStatusEncoder.setCellID(statusMatrix);
+
+    pedestalMatrix->setChargeValues(_pedestal[iDetector]);
+    noiseMatrix->setChargeValues(_noise[iDetector]);
+    statusMatrix->setADCValues(_status[iDetector]);
+
+    pedestalCollection->push_back(pedestalMatrix);
+    noiseCollection->push_back(noiseMatrix);
+    statusCollection->push_back(statusMatrix);
+
+    if ( _asciiOutputSwitch ) {
+      if ( iDetector == 0 ) streamlog_out ( MESSAGE4 ) << "Writing the ASCII pedestal files" << endl;
+      stringstream ss;
+      ss << _outputPedeFileName << "-b" << iDetector << ".dat";
+      ofstream asciiPedeFile(ss.str().c_str());
+      asciiPedeFile << "# Pedestal and noise for board number " << iDetector << endl
+                    << "# calculated from run " << _outputPedeFileName << endl;
+
+      const int subMatrixWidth = 3;
+      const int xPixelWidth    = 4;
+      const int yPixelWidth    = 4;
+      const int pedeWidth      = 15;
+      const int noiseWidth     = 15;
+      const int statusWidth    = 3;
+      const int precision      = 8;
+
+      int iPixel = 0;
+      for (int yPixel = _minY[iDetector]; yPixel <= _maxY[iDetector]; yPixel++) {
+        for (int xPixel = _minX[iDetector]; xPixel <= _maxX[iDetector]; xPixel++) {
+          asciiPedeFile << setiosflags(ios::left)
+                        << setw(subMatrixWidth) << iDetector
+                        << setw(xPixelWidth)    << xPixel
+                        << setw(yPixelWidth)    << yPixel
+                        << resetiosflags(ios::left) << setiosflags(ios::fixed) << setprecision(precision)
+                        << setw(pedeWidth)      << _pedestal[iDetector][iPixel]
+                        << setw(noiseWidth)     << _noise[iDetector][iPixel]
+                        << resetiosflags(ios::fixed)
+                        << setw(statusWidth)    << _status[iDetector][iPixel]
+                        << endl;
+          ++iPixel;
+        }
+      }
+      asciiPedeFile.close();
+    }
+  }
+
+  event->addCollection(pedestalCollection, _pedestalCollectionName);
+  event->addCollection(noiseCollection, _noiseCollectionName);
+  event->addCollection(statusCollection, _statusCollectionName);
+
+  lcWriter->writeEvent(event);
+  delete event;
+
+  lcWriter->close();
+
+}
+
 void EUTelPedestalNoiseProcessor::additionalMaskingLoop(LCEvent * event) {
 
   EUTelEventImpl * evt = static_cast<EUTelEventImpl*> (event);
@@ -1850,36 +1873,314 @@ void EUTelPedestalNoiseProcessor::additionalMaskingLoop(LCEvent * event) {
       for ( size_t iDetector = 0; iDetector < collectionVec->size(); iDetector++) {
         // get the TrackerRawData object from the collection for this detector
         TrackerRawData *trackerRawData = dynamic_cast < TrackerRawData * >(collectionVec->getElementAt (iDetector));
-        ShortVec adcValues = trackerRawData->getADCValues ();
-        for ( unsigned int iPixel = 0 ; iPixel < adcValues.size(); iPixel++ ) {
-          if ( _status[iDetector + detectorOffset][iPixel] == EUTELESCOPE::GOODPIXEL ) {
-            float correctedValue = adcValues[iPixel] - _pedestal[iDetector + detectorOffset][iPixel];
-            float threshold      = _noise[iDetector + detectorOffset][iPixel] * 3.0 ;
+        countFiringPixels( iDetector + detectorOffset, trackerRawData->getADCValues() );
+      }
+    } catch (DataNotAvailableException& e) {
+      streamlog_out ( WARNING2 ) << "No input collection " << _rawDataCollectionNameVec.at( iCol ) << " is not available in the current event" << endl;
+    }
+    ++_iEvt;
+  }
+}
+
+
+void EUTelPedestalNoiseProcessor::countFiringPixels( size_t iDetector, const ShortVec & adcValues ) {
+
+  if ( adcValues.empty() ) return;
+
+  CalibrationKernels::countAboveThreshold( &adcValues[0], &_pedestal[iDetector][0], &_noise[iDetector][0],
+                                           &_status[iDetector][0], adcValues.size(), 3.0, static_cast< short >( EUTELESCOPE::GOODPIXEL ),
+                                           &_hitCounter[iDetector][0] );
+
 #if defined(MARLIN_USE_AIDA) || defined(USE_AIDA)
-            if ( _histogramSwitch  && iPixel == 1 + (adcValues.size() / 10)) {
-              string tempHistoName = _aPixelHistoName + "_d" + to_string( _orderedSensorIDVec.at( iDetector  + detectorOffset ) ) + "_l" + to_string( _iLoop ) ;
-              if ( AIDA::IHistogram1D * histo = dynamic_cast< AIDA::IHistogram1D*> ( _aidaHistoMap[ tempHistoName ] ) )
-                histo->fill( correctedValue );
-              else {
-                streamlog_out ( ERROR1 )  << "Not able to retrieve histogram pointer for " << tempHistoName
-                                          << ".\nDisabling histogramming from now on " << endl;
-                _histogramSwitch = false;
-              }
-            }
+  // the signal of a single pixel is monitored
+  const unsigned int iPixel = 1 + (adcValues.size() / 10);
+  if ( _histogramSwitch && iPixel < adcValues.size() && _status[iDetector][iPixel] == EUTELESCOPE::GOODPIXEL ) {
+    float correctedValue = adcValues[iPixel] - _pedestal[iDetector][iPixel];
+    string tempHistoName = _aPixelHistoName + "_d" + to_string( _orderedSensorIDVec.at( iDetector ) ) + "_l" + to_string( _iLoop ) ;
+    if ( AIDA::IHistogram1D * histo = dynamic_cast< AIDA::IHistogram1D*> ( _aidaHistoMap[ tempHistoName ] ) )
+      histo->fill( correctedValue );
+    else {
+      streamlog_out ( ERROR1 )  << "Not able to retrieve histogram pointer for " << tempHistoName
+                                << ".\nDisabling histogramming from now on " << endl;
+      _histogramSwitch = false;
+    }
+  }
 #endif
-            if ( correctedValue > threshold ) {
-              _hitCounter[iDetector + detectorOffset][iPixel]++;
-            }
-          }
-        }
+}
+
+void EUTelPedestalNoiseProcessor::singlePassLoop( LCEvent * event ) {
+
+  EUTelEventImpl * evt = static_cast<EUTelEventImpl*> (event);
+
+  // same conditions as in the other loops, but there is nothing to
+  // rewind at the end
+  if ( ( evt->getEventType() == kEORE ) ||
+       ( ( _lastEvent != -1 ) && ( _iEvt >= _lastEvent ) ) ) {
+    // all data events were before FirstEvent, nothing has been booked
+    if ( _status.empty() ) {
+      streamlog_out ( ERROR4 ) << "No events have been processed, check FirstEvent and LastEvent." << endl;
+      throw StopProcessingException(this);
+    }
+    streamlog_out ( DEBUG4 ) << "Last event reached: calling finalizeSinglePass()." << endl;
+    finalizeSinglePass();
+    throw StopProcessingException(this);
+  }
+
+  if ( _iEvt < _firstEvent ) {
+    ++_iEvt;
+    throw SkipEventException(this);
+  }
+
+  if ( isFirstEvent() ) {
+
+    for ( size_t iDetector = 0; iDetector < _noOfDetector; ++iDetector ) {
+      const size_t noOfPixels = ( _maxX[iDetector] - _minX[iDetector] + 1 ) * ( _maxY[iDetector] - _minY[iDetector] + 1 );
+      _status.push_back( ShortVec( noOfPixels, EUTELESCOPE::GOODPIXEL ) );
+      if ( _additionalMaskingLoop ) _hitCounter.push_back( ShortVec( noOfPixels, 0 ) );
+    }
+
+    bookHistos();
+
+    _isFirstEvent = false;
+  }
+
+  // the signals of all detectors of this event
+  vector< ShortVec > frames( _noOfDetector );
+  size_t detectorOffset = 0;
+  for ( size_t iCol = 0 ; iCol < _rawDataCollectionNameVec.size(); ++iCol ) {
+
+    try {
+      LCCollectionVec *collectionVec = dynamic_cast < LCCollectionVec * >(evt->getCollection (_rawDataCollectionNameVec.at( iCol )));
+      for ( size_t iDetector = 0; iDetector < collectionVec->size(); iDetector++) {
+        TrackerRawData *trackerRawData = dynamic_cast < TrackerRawData * >(collectionVec->getElementAt (iDetector));
+        frames[ iDetector + detectorOffset ] = trackerRawData->getADCValues();
       }
     } catch (DataNotAvailableException& e) {
       streamlog_out ( WARNING2 ) << "No input collection " << _rawDataCollectionNameVec.at( iCol ) << " is not available in the current event" << endl;
     }
-    ++_iEvt;
+    detectorOffset += _noOfDetectorVec.at( iCol );
+  }
+
+  if ( _pedestal.empty() ) {
+
+    // still filling the reservoir
+    _reservoir.push_back( vector< ShortVec >() );
+    _reservoir.back().swap( frames );
+    if ( _reservoir.size() == static_cast< size_t >( _reservoirSize ) ) {
+      bootstrapFromReservoir();
+    }
+
+  } else {
+
+    bool isEventValid = true;
+    for ( size_t iDetector = 0; iDetector < _noOfDetector; ++iDetector ) {
+      if ( frames[iDetector].size() != _status[iDetector].size() ) continue;
+      if ( ! streamFrame( iDetector, frames[iDetector], true ) ) {
+        streamlog_out ( DEBUG2 ) << "Event " << _iEvt << " on detector " << _orderedSensorIDVec.at( iDetector )
+                                 << " rejected by the common mode calculation" << endl;
+        isEventValid = false;
+      }
+    }
+    if ( ! isEventValid ) _skippedEventList.push_back( _iEvt );
+
+  }
+
+  ++_iEvt;
+}
+
+void EUTelPedestalNoiseProcessor::bootstrapFromReservoir() {
+
+  const size_t noOfEvents = _reservoir.size();
+  streamlog_out ( MESSAGE4 ) << "Calculating the first estimation on the " << noOfEvents << " events in memory" << endl;
+
+  _pedestal.resize( _noOfDetector );
+  _noise.resize( _noOfDetector );
+  _runningMean.resize( _noOfDetector );
+  _runningM2.resize( _noOfDetector );
+  _runningEntries.resize( _noOfDetector );
+  _reservoirSkipped.assign( noOfEvents, false );
+
+  // position of the maximum and minimum signal of each pixel, these
+  // are not used in the first loop
+  vector< IntVec > maxValuePos( _noOfDetector );
+  vector< IntVec > minValuePos( _noOfDetector );
+
+  for ( size_t iDetector = 0; iDetector < _noOfDetector; ++iDetector ) {
+    const size_t noOfPixels = _status[iDetector].size();
+    _pedestal[iDetector].assign( noOfPixels, 0. );
+    _noise[iDetector].assign( noOfPixels, 0. );
+    _runningMean[iDetector].assign( noOfPixels, 0. );
+    _runningM2[iDetector].assign( noOfPixels, 0. );
+    _runningEntries[iDetector].assign( noOfPixels, 0 );
+    maxValuePos[iDetector].assign( noOfPixels, -1 );
+    minValuePos[iDetector].assign( noOfPixels, -1 );
+
+    if ( _preLoopSwitch && noOfEvents > 2 ) {
+      ShortVec maxValue( noOfPixels, numeric_limits< short >::min() );
+      ShortVec minValue( noOfPixels, numeric_limits< short >::max() );
+      for ( size_t iEvent = 0; iEvent < noOfEvents; ++iEvent ) {
+        const ShortVec & adcValues = _reservoir[iEvent][iDetector];
+        if ( adcValues.size() != noOfPixels ) continue;
+        for ( size_t iPixel = 0; iPixel < noOfPixels; ++iPixel ) {
+          if ( adcValues[iPixel] > maxValue[iPixel] ) {
+            maxValue[iPixel]    = adcValues[iPixel];
+            maxValuePos[iDetector][iPixel] = iEvent;
+          }
+          if ( adcValues[iPixel] < minValue[iPixel] ) {
+            minValue[iPixel]    = adcValues[iPixel];
+            minValuePos[iDetector][iPixel] = iEvent;
+          }
+        }
+      }
+    }
+  }
+
+  // first loop: mean and RMS of each pixel
+  for ( size_t iEvent = 0; iEvent < noOfEvents; ++iEvent ) {
+    for ( size_t iDetector = 0; iDetector < _noOfDetector; ++iDetector ) {
+      const ShortVec & adcValues = _reservoir[iEvent][iDetector];
+      if ( adcValues.size() != _status[iDetector].size() ) continue;
+      for ( size_t iPixel = 0; iPixel < adcValues.size(); ++iPixel ) {
+        if ( ( maxValuePos[iDetector][iPixel] == static_cast< int >( iEvent ) ) ||
+             ( minValuePos[iDetector][iPixel] == static_cast< int >( iEvent ) ) ) continue;
+        addToRunningEstimate( _runningEntries[iDetector][iPixel], _runningMean[iDetector][iPixel],
+                              _runningM2[iDetector][iPixel], adcValues[iPixel] );
+      }
+    }
+  }
+  copyRunningEstimates();
+
+  // common mode corrected loops
+  while ( _iLoop < _noOfCMIterations ) {
+
+    maskBadPixel();
+    fillHistos();
+    ++_iLoop;
+
+    seedRunningEstimates();
+    for ( size_t iEvent = 0; iEvent < noOfEvents; ++iEvent ) {
+      bool isEventValid = true;
+      for ( size_t iDetector = 0; iDetector < _noOfDetector; ++iDetector ) {
+        const ShortVec & adcValues = _reservoir[iEvent][iDetector];
+        if ( adcValues.size() != _status[iDetector].size() ) continue;
+        if ( ! streamFrame( iDetector, adcValues, false ) ) isEventValid = false;
+      }
+      _reservoirSkipped[iEvent] = ! isEventValid;
+    }
+    copyRunningEstimates();
+  }
+
+  for ( size_t iEvent = 0; iEvent < noOfEvents; ++iEvent ) {
+    if ( _reservoirSkipped[iEvent] ) _skippedEventList.push_back( _firstEvent + iEvent );
+  }
+
+  // the running estimators of the last loop are continued by the
+  // following events
+}
+
+bool EUTelPedestalNoiseProcessor::streamFrame( size_t iDetector, const ShortVec & adcValues, bool updateEstimates ) {
+
+  FloatVec commonModeCorVec;
+  if ( _iLoop > 0 ) {
+    int skippedPixel = 0;
+    int skippedRow   = 0;
+    if ( ! calculateCommonMode( iDetector, adcValues, commonModeCorVec, skippedPixel, skippedRow ) ) return false;
+  } else {
+    commonModeCorVec.assign( adcValues.size(), 0. );
+  }
+
+  const ShortVec   & status   = _status[iDetector];
+  FloatVec         & pedestal = _pedestal[iDetector];
+  FloatVec         & noise    = _noise[iDetector];
+  vector< double > & mean     = _runningMean[iDetector];
+  vector< double > & m2       = _runningM2[iDetector];
+  IntVec           & entries  = _runningEntries[iDetector];
+
+  for ( size_t iPixel = 0; iPixel < adcValues.size(); ++iPixel ) {
+    if ( status[iPixel] != EUTELESCOPE::GOODPIXEL ) continue;
+
+    // hit rejection against the current estimation
+    const double pedeCorrected = adcValues[iPixel] - commonModeCorVec[iPixel];
+    if ( std::abs( pedeCorrected - pedestal[iPixel] ) >= _hitRejectionCut * noise[iPixel] ) continue;
+
+    addToRunningEstimate( entries[iPixel], mean[iPixel], m2[iPixel], pedeCorrected );
+    if ( updateEstimates ) {
+      pedestal[iPixel] = mean[iPixel];
+      noise[iPixel]    = sqrt( m2[iPixel] / entries[iPixel] );
+    }
   }
+
+  return true;
 }
 
+void EUTelPedestalNoiseProcessor::copyRunningEstimates() {
+
+  for ( size_t iDetector = 0; iDetector < _noOfDetector; ++iDetector ) {
+    for ( size_t iPixel = 0; iPixel < _runningEntries[iDetector].size(); ++iPixel ) {
+      if ( _runningEntries[iDetector][iPixel] == 0 ) continue;
+      _pedestal[iDetector][iPixel] = _runningMean[iDetector][iPixel];
+      _noise[iDetector][iPixel]    = sqrt( _runningM2[iDetector][iPixel] / _runningEntries[iDetector][iPixel] );
+    }
+  }
+}
+
+void EUTelPedestalNoiseProcessor::seedRunningEstimates() {
+
+  for ( size_t iDetector = 0; iDetector < _noOfDetector; ++iDetector ) {
+    const size_t noOfPixels = _pedestal[iDetector].size();
+    _runningEntries[iDetector].assign( noOfPixels, 1 );
+    for ( size_t iPixel = 0; iPixel < noOfPixels; ++iPixel ) {
+      _runningMean[iDetector][iPixel] = _pedestal[iDetector][iPixel];
+      _runningM2[iDetector][iPixel]   = _noise[iDetector][iPixel] * _noise[iDetector][iPixel];
+    }
+  }
+}
+
+void EUTelPedestalNoiseProcessor::finalizeSinglePass() {
+
+  // the input had less events than the reservoir size
+  if ( _pedestal.empty() ) bootstrapFromReservoir();
+
+  copyRunningEstimates();
+
+  _skippedEventList.sort();
+  streamlog_out( MESSAGE4 ) << "Skipped " << _skippedEventList.size() << " event because of common mode ("
+                            << static_cast< double > ( _skippedEventList.size() ) / _iEvt * 100
+                            << "%)" << endl;
+
+  maskBadPixel();
+  fillHistos();
+  ++_iLoop;
+
+  if ( _additionalMaskingLoop ) {
+
+    // the firing frequency is measured on the events in memory
+    int noOfUsedEvents = 0;
+    for ( size_t iEvent = 0; iEvent < _reservoir.size(); ++iEvent ) {
+      if ( _reservoirSkipped[iEvent] ) continue;
+      ++noOfUsedEvents;
+      for ( size_t iDetector = 0; iDetector < _noOfDetector; ++iDetector ) {
+        if ( _reservoir[iEvent][iDetector].size() != _status[iDetector].size() ) continue;
+        countFiringPixels( iDetector, _reservoir[iEvent][iDetector] );
+      }
+    }
+
+    if ( noOfUsedEvents > 0 ) {
+      // maskBadPixel normalises the firing frequency to _iEvt
+      _iEvt = noOfUsedEvents;
+      maskBadPixel();
+      fillStatusMapHistos();
+    } else {
+      streamlog_out ( WARNING2 ) << "No event in memory passed the common mode, skipping the additional masking loop" << endl;
+    }
+    ++_iLoop;
+  }
+
+  writeOutputFile();
+  setReturnValue("IsPedestalFinished", true);
+
+  _reservoir.clear();
+}
 
 void EUTelPedestalNoiseProcessor::setBadPixelAlgoSwitches() {
 
@@ -207,55 +207,13 @@ void  EUTelPreAlign::FillHotPixelMap(LCEvent *event)
 
   if( _hotPixelCollectionName.empty()) return;
 
-  LCCollectionVec *hotPixelCollectionVec = 0;
-  try 
+  if( _hotPixelMask.load( event, _hotPixelCollectionName ) )
     {
-      hotPixelCollectionVec = static_cast< LCCollectionVec* > ( event->getCollection( _hotPixelCollectionName  ) );
       streamlog_out ( DEBUG5 ) << "Hotpixel database " << _hotPixelCollectionName.c_str() << " found" << endl; 
     }
-  catch (...)
+  else
     {
       streamlog_out ( WARNING5 ) << "Hotpixel database " << _hotPixelCollectionName.c_str() << " not found" << endl; 
-      return;
-    }
-
-  CellIDDecoder<TrackerDataImpl> cellDecoder( hotPixelCollectionVec );
-	
-  for(int i=0; i<  hotPixelCollectionVec->getNumberOfElements(); i++)
-    {
-      TrackerDataImpl* hotPixelData = dynamic_cast< TrackerDataImpl *> ( hotPixelCollectionVec->getElementAt( i ) );
-      SparsePixelType  type         = static_cast<SparsePixelType> (static_cast<int> (cellDecoder( hotPixelData )["sparsePixelType"]));
-
-      int sensorID              = static_cast<int > ( cellDecoder( hotPixelData )["sensorID"] );
-
-      if( type  ==  kEUTelGenericSparsePixel )
-	{  
-	  auto_ptr<EUTelSparseClusterImpl< EUTelGenericSparsePixel > > m26Data( new EUTelSparseClusterImpl< EUTelGenericSparsePixel >   ( hotPixelData ) );
-
-	  std::vector<EUTelGenericSparsePixel*> m26PixelVec;
-	  EUTelGenericSparsePixel m26Pixel;
-	  //Push all single Pixels of one plane in the m26PixelVec
-
-	  for(  unsigned int iPixel = 0; iPixel < m26Data->size(); iPixel++ ) 
-	    {
-              std::vector<int> m26ColVec();
-              m26Data->getSparsePixelAt( iPixel, &m26Pixel);
-
-              try
-		{
-		  _hotPixelMap[sensorID].push_back(std::make_pair(m26Pixel.getXCoord(), m26Pixel.getYCoord()));
-		}
-              catch(...)
-		{
-		  streamlog_out ( ERROR5 ) << " cannot add pixel to hotpixel map! SensorID: "  << sensorID << ", X:" << m26Pixel.getXCoord() << ", Y:" << m26Pixel.getYCoord() << endl; 
-		  abort();
-		}
-	    }
-	}          
-      else
-	{
-	  _UsefullHotPixelCollectionFound = 0;
-	}  	
     }
 }
 
@@ -373,71 +331,17 @@ bool EUTelPreAlign::hitContainsHotPixels( TrackerHitImpl   * hit)
 {
 
   // if no hot pixel map was loaded, just return here
-  if( _hotPixelMap.size() == 0) return 0;
+  if( _hotPixelMask.empty() ) return false;
 
-  try
+  if ( hit->getType() != kEUTelSparseClusterImpl ) 
     {
-      LCObjectVec clusterVector = hit->getRawHits();
-
-      if ( hit->getType() == kEUTelSparseClusterImpl ) 
-	{
-	  TrackerDataImpl * clusterFrame = static_cast<TrackerDataImpl*> ( clusterVector[0] );
-	  eutelescope::EUTelSparseClusterImpl< eutelescope::EUTelGenericSparsePixel > *cluster = new eutelescope::EUTelSparseClusterImpl< eutelescope::EUTelGenericSparsePixel >(clusterFrame);
-
-	  int sensorID = cluster->getDetectorID();
-
-	  for ( unsigned int iPixel = 0; iPixel < cluster->size(); iPixel++ ) 
-	    {
-	      EUTelGenericSparsePixel m26Pixel;
-	      cluster->getSparsePixelAt( iPixel, &m26Pixel);
-	      {
-		try{
-		  if( std::find(_hotPixelMap.at(sensorID).begin(), 
-				_hotPixelMap.at(sensorID).end(),
-				std::make_pair(m26Pixel.getXCoord(),m26Pixel.getYCoord()))
-		      != _hotPixelMap.at(sensorID).end()){ 
-		    delete cluster;                        			  
-		    return true; // if TRUE  this hit will be skipped
-		  }
-		}
-		catch(const std::out_of_range& oor){
-		  streamlog_out(DEBUG0) << " Could not find hot pixel map for sensor ID " 
-					<< sensorID << ": " << oor.what() << endl;
-		}
-	      }
-	    }
-
-	  delete cluster;
-	  return 0;
-	} 
-      else if ( hit->getType() == kEUTelBrickedClusterImpl ) 
-	{
-
-	  // fixed cluster implementation. Remember it
-	  //  can come from
-	  //  both RAW and ZS data
-   
-	  streamlog_out ( WARNING5 ) << " Hit type kEUTelBrickedClusterImpl is not implemented in hotPixel finder method, all pixels are considered for PreAlignment." <<  endl;
-
-	} 
-      else if ( hit->getType() == kEUTelDFFClusterImpl ) 
-	{
-
-	  // fixed cluster implementation. Remember it can come from
-	  // both RAW and ZS data
-	  streamlog_out ( WARNING5 ) << " Hit type kEUTelDFFClusterImpl is not implemented in hotPixel finder method, all pixels are considered for PreAlignment." <<  endl;
-	} 
-      else if ( hit->getType() == kEUTelFFClusterImpl ) 
-	{
+      streamlog_out ( WARNING5 ) << " Hit type " << hit->getType() << " is not implemented in hotPixel finder method, all pixels are considered for PreAlignment." <<  endl;
+      return false;
+    }
 
-	  // fixed cluster implementation. Remember it can come from
-	  // both RAW and ZS data
-	  streamlog_out ( WARNING5 ) << " Hit type kEUTelFFClusterImpl is not implemented in hotPixel finder method, all pixels are considered for PreAlignment." <<  endl;
-	} 
-      else
-	{
-	  streamlog_out ( WARNING5 ) << " Hit type is not known and is not implemented in hotPixel finder method, all pixels are considered for PreAlignment." <<  endl;
-	}
+  try
+    {
+      return _hotPixelMask.hitContainsMaskedPixel( hit );
     }
   catch (exception& e)
     {
@@ -445,14 +349,11 @@ bool EUTelPreAlign::hitContainsHotPixels( TrackerHitImpl   * hit)
     }
   catch(...)
     { 
-      // if anything went wrong in the above return FALSE, meaning do not skip this hit
-    
       streamlog_out(ERROR4) << "something went wrong in EUTelPreAlign::hitContainsHotPixels " << endl;
-      return 0;
     }
 
-  // if none of the above worked return FALSE, meaning do not skip this hit
-  return 0;
+  // if anything went wrong in the above return FALSE, meaning do not skip this hit
+  return false;
 }
       
 void EUTelPreAlign::end()
@@ -15,6 +15,9 @@ _alignmentMode(7),
 _beamQ(-1),
 _eBeam(4),
 _createBinary(true),
+_inProcessAlignment(false),
+_inProcessIterations(10),
+_inProcessChi2NdfCut(10.),
 _mEstimatorType()
 {
   // TrackerHit input collection
@@ -42,6 +45,12 @@ _mEstimatorType()
 
   registerOptionalParameter("CreateBinary", "Should we create a binary file for millepede containing the data that millepede needs  ", _createBinary, bool(true));
 
+  registerOptionalParameter("InProcessAlignment", "Keep the measurements of the tracks in memory and iterate the alignment in process, instead of writing the binary and running pede. The tracks are straight lines without scattering. GBLMEstimatorType and PedeSteeringAdditionalCmds are not used then", _inProcessAlignment, bool(false));
+
+  registerOptionalParameter("InProcessIterations", "Maximum number of iterations of the in process alignment, at least 1", _inProcessIterations, static_cast<int> (10));
+
+  registerOptionalParameter("InProcessChi2NdfCut", "Tracks with a larger chi2/ndf are rejected from the second iteration of the in process alignment on. 0 keeps all tracks", _inProcessChi2NdfCut, static_cast<double> (10.));
+
   registerOptionalParameter("xResolutionPlane", "x resolution of planes given in Planes", _SteeringxResolutions, FloatVec());
   registerOptionalParameter("yResolutionPlane", "y resolution of planes given in Planes", _SteeringyResolutions, FloatVec());
 
@@ -101,6 +110,18 @@ void EUTelProcessorGBLAlign::init() {
 		_Mille->setResultsFileName(_milleResultFileName);
 		_Mille->testUserInput();
 		_Mille->printFixedPlanes();
+		if(_inProcessAlignment){
+			if(_inProcessIterations < 1){
+				throw(lcio::Exception("InProcessIterations must be at least 1 for the in process alignment."));
+			}
+			//The in process alignment neither fits with GBL nor runs pede
+			if(!_mEstimatorType.empty()){
+				streamlog_out(WARNING5) << "GBLMEstimatorType is ignored by the in process alignment, there is no outlier down-weighting." << std::endl;
+			}
+			if(!_pedeSteerAddCmds.empty()){
+				streamlog_out(WARNING5) << "PedeSteeringAdditionalCmds are ignored by the in process alignment, they only go to the pede steering file." << std::endl;
+			}
+		}
 		Fitter->setMEstimatorType(_mEstimatorType);//Outliers are hits that do not appear to follow errors which are Gaussian. We want to downweight the effect these hits have on the fit.
 		Fitter->setParamterIdXResolutionVec(_SteeringxResolutions);//We set the accuracy of the residual information since we have no correct hit error analysis yet.
 		Fitter->setParamterIdYResolutionVec(_SteeringyResolutions);
@@ -168,6 +189,18 @@ void EUTelProcessorGBLAlign::processEvent(LCEvent * evt){
             std::vector<EUTelTrack> tracks = reader.getTracks(evt, _trackCandidatesInputCollectionName);
             for (size_t iTrack = 0; iTrack < tracks.size(); ++iTrack) {
                 _totalTrackCount++;
+                if(_inProcessAlignment){
+                    //Only the measurements are kept, no GBL trajectory is needed
+                    std::vector<EUTelState> measurementStates;
+                    for(size_t iState = 0; iState < tracks.at(iTrack).getStates().size(); ++iState){
+                        EUTelState state = tracks.at(iTrack).getStates().at(iState);
+                        if(!state.getStateHasHit()) continue;
+                        _trackFitter->setMeasurementCov(state);
+                        measurementStates.push_back(state);
+                    }
+                    _Mille->storeTrack(measurementStates);
+                    continue;
+                }
                 _trackFitter->resetPerTrack(); //Here we reset the label that connects state to GBL point to 1 again. Also we set the list of states->labels to 0
                 EUTelTrack track = tracks.at(iTrack);
     //			float chi = track.getChi2();
@@ -230,6 +263,15 @@ void EUTelProcessorGBLAlign::end(){
 	//The millepede class contains all the functions related to manipulation of steering files, results files from millepede and the scripts related to editing these file.
 	//It also controls the running of millepede. 
 	_Mille->writeMilleSteeringFile(_pedeSteerAddCmds);//This will create the initial steering file. This can then be accessed via the string member variable:_milleSteeringFilename
+	if(_inProcessAlignment){
+		//The stored tracks are aligned without pede. The results file it writes is used as the one of pede.
+		streamlog_out (MESSAGE9) <<"IN PROCESS ALIGNMENT WITH "<< _Mille->getNumberOfStoredTracks() <<" STORED TRACKS"<< std::endl;
+		if(!_Mille->solveInProcess(_inProcessIterations, _inProcessChi2NdfCut)){
+			_Mille->writeResultsFile();
+			_Mille->parseMilleOutput(_alignmentConstantLCIOFile, _gear_aligned_file);
+		}
+		return;
+	}
 	bool tooManyRejects = 	_Mille->runPede();//This will run millepede and create the initial results file. We automatically line to this through the string variable._milleResultFileName.
 	if(!tooManyRejects){//Check that the intial input fit is successful. We need this for the initial reasonable results file.
 		streamlog_out (MESSAGE9) <<"FIRST ATTEMPT WITH INITIAL INPUT PARAMETERS. NOW TRY TO CONVERGE.......................................  "<< std::endl;
@@ -54,7 +54,11 @@ _beamQ(-1),
 _eBeam(4),
 _trackCandidatesInputCollectionName("Default_input"),
 _tracksOutputCollectionName("Default_output"),
-_mEstimatorType() //This is used by the GBL software for outliers down weighting
+_mEstimatorType(), //This is used by the GBL software for outliers down weighting
+_trackFitter(NULL),
+_numberOfThreads(1),
+_trackFitters(),
+_threadPool(NULL)
 {
 	// Processor description
 	_description = "EUTelProcessorGBLTrackFit this will fit gbl tracks and output them into LCIO file.";
@@ -73,6 +77,8 @@ _mEstimatorType() //This is used by the GBL software for outliers down weighting
 	//This is the estimated resolution of the planes and DUT in x/y direction
   registerOptionalParameter("xResolutionPlane", "x resolution of planes given in Planes", _SteeringxResolutions, FloatVec());
   registerOptionalParameter("yResolutionPlane", "y resolution of planes given in Planes", _SteeringyResolutions, FloatVec());
+	//The tracks of an event are independent until they are written out. They can be fitted concurrently, each thread with its own fitter.
+  registerOptionalParameter("NumberOfThreads", "Number of threads fitting the tracks of an event", _numberOfThreads, static_cast<int>(1));
 }
 
 void EUTelProcessorGBLTrackFit::init() {
@@ -86,16 +92,18 @@ void EUTelProcessorGBLTrackFit::init() {
 		std::string name("test.root");
 		geo::gGeometry().initializeTGeoDescription(name,false);
 		// Initialize GBL fitter. This is the class that does all the work. Seems to me a good practice for the most part create a class that does the work. Since then you can use the same functions in another processor.
-		EUTelGBLFitter* Fitter = new EUTelGBLFitter();
-		Fitter->setBeamCharge(_beamQ);
-		Fitter->setBeamEnergy(_eBeam);
-		Fitter->setMEstimatorType(_mEstimatorType);//As said before this is to do with how we deal with outliers and the function we use to weight them.
-		Fitter->setParamterIdXResolutionVec(_SteeringxResolutions);
-		Fitter->setParamterIdYResolutionVec(_SteeringyResolutions);
-		Fitter->testUserInput();
-		_trackFitter = Fitter;
-		if (!_trackFitter) {
-			throw(lcio::Exception("Could not create instance of fitter class."));
+		// Every thread gets its own fitter, since a fitter keeps the state of the track it works on.
+		for(size_t i = 0; i < _trackFitters.size(); ++i){
+			delete _trackFitters.at(i);
+		}
+		_trackFitters.clear();
+		for(int i = 0; i < std::max(_numberOfThreads, 1); i++){
+			_trackFitters.push_back(createFitter());
+		}
+		_trackFitter = _trackFitters.front();
+		if(_numberOfThreads > 1){
+			_threadPool = new EUTelThreadPool(_numberOfThreads);
+			streamlog_out(MESSAGE5) << "Fit tracks on " << _threadPool->getNumberOfThreads() << " threads" << std::endl;
 		}
 		//Create millepede output
 //		_Mille  = new EUTelMillepede(); 
@@ -117,6 +125,17 @@ void EUTelProcessorGBLTrackFit::init() {
 	}
 }
 
+EUTelGBLFitter* EUTelProcessorGBLTrackFit::createFitter() {
+	EUTelGBLFitter* Fitter = new EUTelGBLFitter();
+	Fitter->setBeamCharge(_beamQ);
+	Fitter->setBeamEnergy(_eBeam);
+	Fitter->setMEstimatorType(_mEstimatorType);//As said before this is to do with how we deal with outliers and the function we use to weight them.
+	Fitter->setParamterIdXResolutionVec(_SteeringxResolutions);
+	Fitter->setParamterIdYResolutionVec(_SteeringyResolutions);
+	Fitter->testUserInput();
+	return Fitter;
+}
+
 void EUTelProcessorGBLTrackFit::processRunHeader(LCRunHeader * run) {
 	std::auto_ptr<EUTelRunHeaderImpl> header(new EUTelRunHeaderImpl(run));
 	header->addProcessor(type());
@@ -148,58 +167,41 @@ void EUTelProcessorGBLTrackFit::processEvent(LCEvent* evt){
 		}
         EUTelReaderGenericLCIO reader = EUTelReaderGenericLCIO();
         std::vector<EUTelTrack> tracks = reader.getTracks(evt, _trackCandidatesInputCollectionName );
+		//The tracks are fitted first. The results are then used in track order, so the output does not depend on the number of threads.
+		std::vector<TrackFitResult> results(tracks.size());
+		TrackFitJob job(_trackFitters, tracks, results);
+		//The debug output can not be shared between threads. Then we stay on this thread.
+		if(_threadPool != NULL && !streamlog::out.write<streamlog::DEBUG9>()){
+			geo::gGeometry().cacheAllPlaneTransforms();
+			_threadPool->run(job, tracks.size());
+		}else{
+			for (size_t iTrack = 0; iTrack < tracks.size(); iTrack++) {
+				job.process(iTrack, 0);
+			}
+		}
 		std::vector<EUTelTrack> allTracksForThisEvent;//GBL will analysis the track one at a time. However we want to save to lcio per event.
-		for (size_t iTrack = 0; iTrack < tracks.size(); iTrack++) {
-			EUTelTrack track = tracks.at(iTrack); 
-            streamlog_out(DEBUG1)<<"Found "<<tracks.size()<<" tracks for event " << evt->getEventNumber() << "  This is track:  " << iTrack <<std::endl;
-            track.print();
-			streamlog_out(DEBUG1) << "//////////////////////////////////// " << std::endl;
-			_trackFitter->resetPerTrack(); //Here we reset the label that connects state to GBL point to 1 again. Also we set the list of states->labels to 0
-			_trackFitter->testTrack(track);//Check the track has states and hits  
-			std::vector< gbl::GblPoint > pointList;
-			_trackFitter->setInformationForGBLPointList(track, pointList);//Here we describe the whole setup. Geometry, scattering, data...
-			const gear::BField& B = geo::gGeometry().getMagneticField();//We need this to determine if we should fit a curve or a straight line.
-			const double Bmag = B.at( TVector3(0.,0.,0.) ).r2();
-			_trackFitter->setPairMeasurementStateAndPointLabelVec(pointList);//This will create a link between the states that have a hit associated with them and the GBL label that is associated with the state.
-			gbl::GblTrajectory* traj = 0;
-			//Here we create the trajectory from the points created by setInformationForGBLPointList. This will take the points and propagation jacobian and split this into smaller matrices to describe the problem in terms of offsets. Here is the difference between GBL and other fitting algorithms.  
-			if ( Bmag < 1.E-6 ) {
-				traj = new gbl::GblTrajectory( pointList, false ); 
-			}else {
-				traj = new gbl::GblTrajectory( pointList, true );
+		for (size_t iTrack = 0; iTrack < results.size(); iTrack++) {
+			TrackFitResult& result = results.at(iTrack);
+			if(!result.error.empty()){
+				throw(result.error);
 			}
-			_trackFitter->setPairAnyStateAndPointLabelVec(traj);//This will create a link between any state and it's GBL point label. 
-			double  chi2=0; 
-			int ndf=0;
-			int ierr=0;
-			_trackFitter->computeTrajectoryAndFit(traj, &chi2,&ndf, ierr);//This will do the minimisation of the chi2 and produce the most probable trajectory.
-			if(ierr == 0 ){
-				streamlog_out(DEBUG5) << "Ierr is: " << ierr << " Entering loop to update track information " << std::endl;
-				//If the fit succeeded then write into the binary file.
-//				traj->milleOut(*(_Mille->_milleGBL));
+			const double chi2 = result.chi2;
+			const int ndf = result.ndf;
+			if(result.ierr == 0 ){
 				static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_chi2CandidateHistName ] ) -> fill( (chi2)/(ndf));
 				static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_fitsuccessHistName ] ) -> fill(1.0);
 				if(chi2 ==0 or ndf ==0){
 					throw(lcio::Exception("Your fitted track has zero degrees of freedom or a chi2 of 0.")); 	
 					}
-				track.setChi2(chi2);
-				track.setNdf(ndf);
 				_chi2NdfVec.push_back(chi2/static_cast<float>(ndf));
-				std::map<int, std::vector<double> >  mapSensorIDToCorrectionVec;//This is not used now. However it maybe useful to be able to access the corrections that GBL makes to the original track. Since if this is too large then GBL may give th wrong trajectory. Since all the equations are only to first order. 
-				_trackFitter->updateTrackFromGBLTrajectory(traj,track,mapSensorIDToCorrectionVec);
-				std::map< int, std::map< float, float > >  SensorResidual; 
-				std::map< int, std::map< float, float > >  SensorResidualError; 
-				std::map< int, int> planes;
-				_trackFitter->getResidualOfTrackandHits(traj, pointList,track, SensorResidual, SensorResidualError, planes);
 				if(chi2/static_cast<float>(ndf) < 5){
-				  plotResidual(SensorResidual,SensorResidualError, planes);//TO DO: Need to fix how we histogram.
+				  plotResidual(result.sensorResidual, result.sensorResidualError, result.planes);//TO DO: Need to fix how we histogram.
 				}
 			}else{
-				streamlog_out(DEBUG5) << "Ierr is: " << ierr << " Do not update track information " << std::endl;
 				static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_fitsuccessHistName ] ) -> fill(0.0);
 				continue;//We continue so we don't add an empty track
 			}	
-			allTracksForThisEvent.push_back(track);
+			allTracksForThisEvent.push_back(result.track);
 			}//END OF LOOP FOR ALL TRACKS IN AN EVENT
 			outputLCIO(evt, allTracksForThisEvent); 
 			allTracksForThisEvent.clear();//We clear this so we don't add the same track twice
@@ -226,6 +228,37 @@ void EUTelProcessorGBLTrackFit::processEvent(LCEvent* evt){
 }
 
 
+//This must not touch anything but the fitter and the result, since it runs concurrently for the tracks of an event.
+void EUTelProcessorGBLTrackFit::fitTrack(EUTelGBLFitter& fitter, TrackFitResult& result){
+	EUTelTrack& track = result.track;
+	streamlog_out(DEBUG1) << "//////////////////////////////////// " << std::endl;
+	track.print();
+	fitter.resetPerTrack(); //Here we reset the label that connects state to GBL point to 1 again. Also we set the list of states->labels to 0
+	fitter.testTrack(track);//Check the track has states and hits  
+	std::vector< gbl::GblPoint > pointList;
+	fitter.setInformationForGBLPointList(track, pointList);//Here we describe the whole setup. Geometry, scattering, data...
+	const gear::BField& B = geo::gGeometry().getMagneticField();//We need this to determine if we should fit a curve or a straight line.
+	const double Bmag = B.at( TVector3(0.,0.,0.) ).r2();
+	fitter.setPairMeasurementStateAndPointLabelVec(pointList);//This will create a link between the states that have a hit associated with them and the GBL label that is associated with the state.
+	//Here we create the trajectory from the points created by setInformationForGBLPointList. This will take the points and propagation jacobian and split this into smaller matrices to describe the problem in terms of offsets. Here is the difference between GBL and other fitting algorithms.  
+	std::auto_ptr<gbl::GblTrajectory> traj( new gbl::GblTrajectory( pointList, Bmag >= 1.E-6 ) );
+	fitter.setPairAnyStateAndPointLabelVec(traj.get());//This will create a link between any state and it's GBL point label. 
+	fitter.computeTrajectoryAndFit(traj.get(), &result.chi2, &result.ndf, result.ierr);//This will do the minimisation of the chi2 and produce the most probable trajectory.
+	if(result.ierr == 0 ){
+		streamlog_out(DEBUG5) << "Ierr is: " << result.ierr << " Entering loop to update track information " << std::endl;
+		if(result.chi2 ==0 or result.ndf ==0){
+			return;//Reported while the results are merged.
+		}
+		track.setChi2(result.chi2);
+		track.setNdf(result.ndf);
+		std::map<int, std::vector<double> >  mapSensorIDToCorrectionVec;//This is not used now. However it maybe useful to be able to access the corrections that GBL makes to the original track. Since if this is too large then GBL may give th wrong trajectory. Since all the equations are only to first order. 
+		fitter.updateTrackFromGBLTrajectory(traj.get(),track,mapSensorIDToCorrectionVec);
+		fitter.getResidualOfTrackandHits(traj.get(), pointList,track, result.sensorResidual, result.sensorResidualError, result.planes);
+	}else{
+		streamlog_out(DEBUG5) << "Ierr is: " << result.ierr << " Do not update track information " << std::endl;
+	}
+}
+
 //TO DO:This is a very stupid way to histogram but will add new class to do this is long run 
 void EUTelProcessorGBLTrackFit::plotResidual(std::map< int, std::map<float, float > >  & sensorResidual, std::map< int, std::map<float, float > >  & sensorResidualError, std::map< int, int > & planes){
 	//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////Residual plot
@@ -321,6 +354,12 @@ void EUTelProcessorGBLTrackFit::end() {
 	}
 	//TO DO: We really should have a better way to look track per track	and see if the correction is too large. 
 	std::vector<double> correctionTotal = _trackFitter->getCorrectionsTotal();
+	for(size_t i = 1; i < _trackFitters.size(); ++i){
+		std::vector<double> correctionThread = _trackFitters.at(i)->getCorrectionsTotal();
+		for(size_t j = 0; j < correctionTotal.size(); ++j){
+			correctionTotal.at(j) += correctionThread.at(j);
+		}
+	}
 	streamlog_out(MESSAGE9)<<"This is the average correction for omega: " <<correctionTotal.at(0)/sizeFittedTracks<<std::endl;	
 	streamlog_out(MESSAGE9)<<"This is the average correction for local xz inclination: " <<correctionTotal.at(1)/sizeFittedTracks<<std::endl;	
 	streamlog_out(MESSAGE9)<<"This is the average correction for local yz inclination: " <<correctionTotal.at(2)/sizeFittedTracks<<std::endl;	
@@ -330,6 +369,14 @@ void EUTelProcessorGBLTrackFit::end() {
   float average = total/sizeFittedTracks;
 	streamlog_out(MESSAGE9) << "This is the average chi2 -"<< average <<std::endl;
 
+	delete _threadPool;
+	_threadPool = NULL;
+	for(size_t i = 0; i < _trackFitters.size(); ++i){
+		delete _trackFitters.at(i);
+	}
+	_trackFitters.clear();
+	_trackFitter = NULL;
+
 }
 
 #endif // USE_GBL
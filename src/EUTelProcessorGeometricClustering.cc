@@ -85,7 +85,8 @@ EUTelProcessorGeometricClustering::EUTelProcessorGeometricClustering():
   _isGeometryReady(false),
   _sensorIDVec(),
   _zsInputDataCollectionVec(NULL),
-  _pulseCollectionVec(NULL)
+  _pulseCollectionVec(NULL),
+  _pixelGeometryTableMap()
  {
   
   // modify processor description
@@ -335,8 +336,18 @@ void EUTelProcessorGeometricClustering::geometricClustering(LCEvent * evt, LCCol
 
 			streamlog_out ( DEBUG2 ) << "Processing sparse data on detector " << sensorID << " with " << sparseData->size() << " pixels " << std::endl;
 
+			//the geometry of all pixels of this plane is computed once and then only looked up
+			std::map<int, PixelGeometryTable>::iterator tableIt = _pixelGeometryTableMap.find( sensorID );
+			if( tableIt == _pixelGeometryTableMap.end() )
+			{
+				tableIt = _pixelGeometryTableMap.insert( std::make_pair( sensorID, PixelGeometryTable() ) ).first;
+				buildPixelGeometryTable( planePath, geoDescr, tableIt->second );
+			}
+			const PixelGeometryTable& pixelTable = tableIt->second;
+
 			int hitPixelsInEvent = sparseData->size();
 			std::vector<EUTelGeometricPixel> hitPixelVec;
+			hitPixelVec.reserve( hitPixelsInEvent );
 			EUTelGenericSparsePixel* genericPixel = new EUTelGenericSparsePixel;
 
 			//This for-loop loads all the hits of the given event and detector plane and stores them as GeometricPixels
@@ -346,47 +357,19 @@ void EUTelProcessorGeometricClustering::geometricClustering(LCEvent * evt, LCCol
 				sparseData->getSparsePixelAt( i, genericPixel );
 				EUTelGeometricPixel hitPixel( *genericPixel );
 
-				//And get the path to the given pixel
-				std::string pixelPath = geoDescr->getPixName(hitPixel.getXCoord(), hitPixel.getYCoord());
-
-				//Then navigate to this pixel with the TGeo manager
-				geo::gGeometry()._geoManager->cd( (planePath+pixelPath).c_str() );
-
-				//get the imbedding box
-				TGeoShape* currentShape =  geo::gGeometry()._geoManager->GetCurrentVolume()->GetShape();
-				TGeoBBox* bbox = dynamic_cast<TGeoBBox*>( currentShape );
-				//store the dimensions of this box in the GeometricPixel
-				hitPixel.setBoundaryX( bbox->GetDX() );
-				hitPixel.setBoundaryY( bbox->GetDY() );
-
-				//Get how deep the node description goes (this is how often we have to transform to get coordinates in the local plane coordinate system)
-				std::vector<std::string> split = Utility::stringSplit( planePath+pixelPath , "/", false);
-
-				//Three recursions for the telescope/plane
-				int recursionDepth = split.size() - 3;
-
-				//The do the transformation
-				Double_t origin_pt[3] = {0,0,0};
-				Double_t transformed1_pt[3];
-				Double_t transformed2_pt[3];
-				gGeoManager->GetCurrentNode()->LocalToMaster(origin_pt, transformed1_pt);
-
-				transformed2_pt[0] = transformed1_pt[0];
-				transformed2_pt[1] = transformed1_pt[1];
-				transformed2_pt[2] = transformed1_pt[2];
-
-				//transform into local plane coordinate system
-				for(int i = 1 ; i < recursionDepth; ++i)
+				//Look up the position and the dimensions of the pixel in the plane local frame
+				float posX, posY, boundaryX, boundaryY;
+				if( !pixelTable.getPixelGeometry( hitPixel.getXCoord(), hitPixel.getYCoord(), posX, posY, boundaryX, boundaryY ) )
 				{
-					gGeoManager->GetMother(i)->LocalToMaster(transformed1_pt, transformed2_pt);
-					transformed1_pt[0] = transformed2_pt[0];
-					transformed1_pt[1] = transformed2_pt[1];
-					transformed1_pt[2] = transformed2_pt[2];
+					//pixel outside of the declared index range, ask TGeo directly
+					computePixelGeometry( planePath, geoDescr, hitPixel.getXCoord(), hitPixel.getYCoord(), posX, posY, boundaryX, boundaryY );
 				}
 
-				//store all the position information in the GeometricPixel
-				hitPixel.setPosX( transformed2_pt[0] );
-				hitPixel.setPosY( transformed2_pt[1] );
+				//store all the geometry information in the GeometricPixel
+				hitPixel.setBoundaryX( boundaryX );
+				hitPixel.setBoundaryY( boundaryY );
+				hitPixel.setPosX( posX );
+				hitPixel.setPosY( posY );
 				//and push this pixel back
 				hitPixelVec.push_back( hitPixel );
 			}		
@@ -520,6 +503,76 @@ void EUTelProcessorGeometricClustering::geometricClustering(LCEvent * evt, LCCol
 	}
 }
 
+void EUTelProcessorGeometricClustering::computePixelGeometry(const std::string& planePath, geo::EUTelGenericPixGeoDescr* geoDescr, int xCoord, int yCoord, 
+								float& posX, float& posY, float& boundaryX, float& boundaryY) const
+{
+	//Get the path to the given pixel
+	std::string pixelPath = geoDescr->getPixName( xCoord, yCoord );
+
+	//Then navigate to this pixel with the TGeo manager
+	geo::gGeometry()._geoManager->cd( (planePath+pixelPath).c_str() );
+
+	//get the imbedding box
+	TGeoShape* currentShape =  geo::gGeometry()._geoManager->GetCurrentVolume()->GetShape();
+	TGeoBBox* bbox = dynamic_cast<TGeoBBox*>( currentShape );
+	//store the dimensions of this box
+	boundaryX = bbox->GetDX();
+	boundaryY = bbox->GetDY();
+
+	//Get how deep the node description goes (this is how often we have to transform to get coordinates in the local plane coordinate system)
+	std::vector<std::string> split = Utility::stringSplit( planePath+pixelPath , "/", false);
+
+	//Three recursions for the telescope/plane
+	int recursionDepth = split.size() - 3;
+
+	//The do the transformation
+	Double_t origin_pt[3] = {0,0,0};
+	Double_t transformed1_pt[3];
+	Double_t transformed2_pt[3];
+	gGeoManager->GetCurrentNode()->LocalToMaster(origin_pt, transformed1_pt);
+
+	transformed2_pt[0] = transformed1_pt[0];
+	transformed2_pt[1] = transformed1_pt[1];
+	transformed2_pt[2] = transformed1_pt[2];
+
+	//transform into local plane coordinate system
+	for(int i = 1 ; i < recursionDepth; ++i)
+	{
+		gGeoManager->GetMother(i)->LocalToMaster(transformed1_pt, transformed2_pt);
+		transformed1_pt[0] = transformed2_pt[0];
+		transformed1_pt[1] = transformed2_pt[1];
+		transformed1_pt[2] = transformed2_pt[2];
+	}
+
+	posX = transformed2_pt[0];
+	posY = transformed2_pt[1];
+}
+
+void EUTelProcessorGeometricClustering::buildPixelGeometryTable(const std::string& planePath, geo::EUTelGenericPixGeoDescr* geoDescr, PixelGeometryTable& table) const
+{
+	int minX, minY, maxX, maxY;
+	minX = minY = maxX = maxY = 0;
+	geoDescr->getPixelIndexRange( minX, maxX, minY, maxY );
+
+	table.minX = minX;
+	table.minY = minY;
+	table.sizeX = maxX - minX + 1;
+	table.sizeY = maxY - minY + 1;
+	table.geometry.assign( 4*static_cast<size_t>(table.sizeX)*static_cast<size_t>(table.sizeY), 0.0f );
+
+	streamlog_out ( MESSAGE4 ) << "Building pixel geometry table for plane " << planePath << " with " 
+				   << table.sizeX << "x" << table.sizeY << " pixels" << std::endl;
+
+	for( int y = minY; y <= maxY; ++y )
+	{
+		for( int x = minX; x <= maxX; ++x )
+		{
+			float* entry = &table.geometry[ 4*table.getIndex(x, y) ];
+			computePixelGeometry( planePath, geoDescr, x, y, entry[0], entry[1], entry[2], entry[3] );
+		}
+	}
+}
+
 void EUTelProcessorGeometricClustering::check (LCEvent * /* evt */) {
   // nothing to check here - could be used to fill check plots in reconstruction processor
 }
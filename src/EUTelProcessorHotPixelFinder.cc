@@ -134,10 +134,9 @@ void EUTelProcessorHotPixelFinder::init ()
   // reset the vector with the firing frequency
   _firingFreqVec.clear();
 
-  // reset hotpixel map vectors
-  _hitIndexMapVec.clear();
-  _inverse_hitIndexMapVec.clear();
-  _pixelMapVec.clear();
+  // reset the pixel decoders and the number of accumulated events
+  _matrixDecoderVec.clear();
+  _noOfAccumulatedEvents = 0;
 
 }
 
@@ -237,13 +236,9 @@ void EUTelProcessorHotPixelFinder::HotPixelFinder(EUTelEventImpl  *evt)
 
     // get the collections of interest from the event.
     LCCollectionVec * zsInputCollectionVec  = dynamic_cast < LCCollectionVec * > (evt->getCollection( _zsDataCollectionName ));
-    LCCollectionVec * statusCollectionVec   = dynamic_cast < LCCollectionVec * > (evt->getCollection( _statusCollectionName ));
-    LCCollectionVec * noiseCollectionVec    = dynamic_cast < LCCollectionVec * > (evt->getCollection( _noiseCollectionName ));
 
     // prepare some decoders
     CellIDDecoder<TrackerDataImpl> cellDecoder( zsInputCollectionVec );
-    CellIDDecoder<TrackerDataImpl> statusDecoder( statusCollectionVec );
-    CellIDDecoder<TrackerDataImpl> noiseDecoder( noiseCollectionVec );
 
 
     for ( unsigned int iDetector = 0 ; iDetector < zsInputCollectionVec->size(); iDetector++ ) 
@@ -260,78 +255,49 @@ void EUTelProcessorHotPixelFinder::HotPixelFinder(EUTelEventImpl  *evt)
           std::cout << " pixel is not of Geneneric type " << std::endl ;
         }
 
-        int _sensorID            = static_cast<int > ( cellDecoder( zsData )["sensorID"] );
-        int  sensorID            = _sensorID;
-
+        int sensorID = static_cast<int > ( cellDecoder( zsData )["sensorID"] );
 
         //if this is an excluded sensor go to the next element
 
         bool foundexcludedsensor = false;
         for(size_t j = 0; j < _ExcludedPlanes.size(); ++j)
         {
-            if(_ExcludedPlanes[j] == _sensorID)
+            if(_ExcludedPlanes[j] == sensorID)
             {
                 foundexcludedsensor = true;
             }
         }
         if(foundexcludedsensor)  continue;
 
-        // get the noise and the status matrix with the right detectorID
-        TrackerRawDataImpl * status = 0;
-
-        // the noise map. we only need this map for decoding issues.
-        TrackerDataImpl    * noise  = 0;
-   
-        // get the noise and the status matrix with the right detectorID
-        status = dynamic_cast<TrackerRawDataImpl*>(statusCollectionVec->getElementAt( _ancillaryIndexMap[ sensorID ] ));        
-        vector< short > statusVec = status->adcValues();
-
-        //the noise map. we only need this map for decoding issues.
-        noise  = dynamic_cast<TrackerDataImpl*>   (noiseCollectionVec->getElementAt( _ancillaryIndexMap[ sensorID ] ));
-
-        // prepare the matrix decoder
-        EUTelMatrixDecoder matrixDecoder( noiseDecoder , noise );
+        // the counters are kept in the order of the ancillary collections
+        map< int, int >::const_iterator ancillaryIter = _ancillaryIndexMap.find( sensorID );
+        if( ancillaryIter == _ancillaryIndexMap.end() || ancillaryIter->second >= static_cast< int >( _firingFreqVec.size() ) )
+        {
+            streamlog_out ( WARNING2 ) << "Sensor " << sensorID << " is not in the status collection, its pixels are not counted" << endl;
+            continue;
+        }
+        const EUTelMatrixDecoder & matrixDecoder = _matrixDecoderVec[ ancillaryIter->second ];
+        vector< unsigned int > & firingCounter   = _firingFreqVec[ ancillaryIter->second ];
 
         // now prepare the EUTelescope interface to sparsified data.  
-        // what's the point of this one ?
         auto_ptr<EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel > > sparseData(new EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel> ( zsData ));
 
-        streamlog_out ( DEBUG1 ) << "Processing sparse data on detector " << _sensorID << " with "
+        streamlog_out ( DEBUG1 ) << "Processing sparse data on detector " << sensorID << " with "
                                  << sparseData->size() << " pixels " << endl;
-        
+
+        EUTelGenericSparsePixel sparsePixel;
         for ( unsigned int iPixel = 0; iPixel < sparseData->size(); iPixel++ ) 
         {
             // loop over all pixels in the sparseData object.      
-            EUTelGenericSparsePixel *sparsePixel =  new EUTelGenericSparsePixel() ;
-
-            sparseData->getSparsePixelAt( iPixel, sparsePixel );
-            int decoded_XY_index = matrixDecoder.getIndexFromXY( sparsePixel->getXCoord(), sparsePixel->getYCoord() ); // unique pixel index !!
-
-            if( _hitIndexMapVec[iDetector].find( decoded_XY_index ) == _hitIndexMapVec[iDetector].end() )
+            sparseData->getSparsePixelAt( iPixel, &sparsePixel );
+            if( sparsePixel.getXCoord() < matrixDecoder.getMinX() || sparsePixel.getXCoord() > matrixDecoder.getMaxX() ||
+                sparsePixel.getYCoord() < matrixDecoder.getMinY() || sparsePixel.getYCoord() > matrixDecoder.getMaxY() )
             {
-                int old_size = status->adcValues().size();
-                // increment
-              
-                int new_size     = old_size + 1 ;
-                int last_element = old_size;
-              
-                status->adcValues().resize( new_size  );
-                _hitIndexMapVec[iDetector].insert ( make_pair ( decoded_XY_index, last_element ) );
-                _inverse_hitIndexMapVec[iDetector].insert ( make_pair ( last_element, decoded_XY_index ) );
-
-              
-                status->adcValues()[ last_element ] = EUTELESCOPE::HITPIXEL ;  // adcValues is a vector, there fore must address the elements incrementally
-                
-                _pixelMapVec[iDetector].insert ( make_pair( decoded_XY_index, sparsePixel ) );                     // one more map, get the pixel point bny its unique index
-//                printf("--last_element:%7d;  pixel %7d, index %7d, pointer %7d %7d \n",
-//                        last_element, iPixel, decoded_XY_index, _pixelMapVec[iDetector][ decoded_XY_index]->getXCoord(), _pixelMapVec[iDetector][ decoded_XY_index]->getYCoord()  );
-            }
-            else
-            {
-//                printf("idet: %5d, status: %p, addressing known pixel decoded: %7d  orig: %7d  status->size:%7d\n", 
-//                        iDetector, status, decoded_XY_index, _hitIndexMapVec[iDetector][ decoded_XY_index ], status->adcValues().size()  );
-                status->adcValues()[ _hitIndexMapVec[iDetector][ decoded_XY_index]  ] = EUTELESCOPE::HITPIXEL ;
+                streamlog_out ( WARNING2 ) << "Pixel " << sparsePixel.getXCoord() << "," << sparsePixel.getYCoord()
+                                           << " of sensor " << sensorID << " is outside of the sensor range" << endl;
+                continue;
             }
+            ++firingCounter[ matrixDecoder.getIndexFromXY( sparsePixel.getXCoord(), sparsePixel.getYCoord() ) ];
         }
     }    
 
@@ -383,24 +349,21 @@ void EUTelProcessorHotPixelFinder::processEvent (LCEvent * event)
         initializeGeometry( event );
 
         _firingFreqVec.clear();
-        if( getBuildHotPixelDatabase() != 0 )
-        {
-            _hitIndexMapVec.clear();
-            _inverse_hitIndexMapVec.clear();
-            _pixelMapVec.clear();
-        }
+        _matrixDecoderVec.clear();
         
         for ( int iDetector = 0; iDetector < statusCollectionVec->getNumberOfElements() ; iDetector++) 
         {  
            streamlog_out ( MESSAGE5 ) << " First event :: adding Detector " << iDetector << endl;          
+           int sensorID = _sensorIDVec.at( iDetector );
+           _matrixDecoderVec.push_back( EUTelMatrixDecoder( _maxX[ sensorID ] - _minX[ sensorID ] + 1, _maxY[ sensorID ] - _minY[ sensorID ] + 1,
+                                                            _minX[ sensorID ], _minY[ sensorID ] ) );
            _firingFreqVec.resize( iDetector+1 );
            
+           // one counter per pixel of the matrix, allocated once for the whole run
            if( getBuildHotPixelDatabase() != 0 )
-            {
-                if(static_cast< int >( _hitIndexMapVec.size()) < iDetector+1 )            _hitIndexMapVec.resize(iDetector+1);
-                if( static_cast< int >(_inverse_hitIndexMapVec.size()) < iDetector+1 )    _inverse_hitIndexMapVec.resize(iDetector+1);
-                if( static_cast< int >(_pixelMapVec.size()) < iDetector+1 )               _pixelMapVec.resize(iDetector+1);
-            }
+           {
+               _firingFreqVec[ iDetector ].assign( ( _maxX[ sensorID ] - _minX[ sensorID ] + 1 ) * ( _maxY[ sensorID ] - _minY[ sensorID ] + 1 ), 0 );
+           }
         }
         
         _isFirstEvent = false;
@@ -409,56 +372,30 @@ void EUTelProcessorHotPixelFinder::processEvent (LCEvent * event)
     if( getBuildHotPixelDatabase() != 0 )
     {
         HotPixelFinder(evt);
+        ++_noOfAccumulatedEvents;
     }
-
-     
-    
-    for ( int iDetector = 0; iDetector < statusCollectionVec->getNumberOfElements() ; iDetector++) 
+    else
     {
-        TrackerRawDataImpl * status = dynamic_cast< TrackerRawDataImpl * > ( statusCollectionVec->getElementAt( iDetector ) );
-        if( _firingFreqVec[iDetector].size() < status->getADCValues().size() )
+        // count the pixels flagged as hit in the status collection
+        for ( int iDetector = 0; iDetector < statusCollectionVec->getNumberOfElements() ; iDetector++) 
         {
-            _firingFreqVec[iDetector].resize( status->getADCValues().size() )  ;
-        }
-    }
-    
+            TrackerRawDataImpl * status = dynamic_cast< TrackerRawDataImpl * > ( statusCollectionVec->getElementAt( iDetector ) );
+            vector< short > & statusVec = status->adcValues();
+            if( _firingFreqVec[iDetector].size() < statusVec.size() )
+            {
+                _firingFreqVec[iDetector].resize( statusVec.size() )  ;
+            }
 
-    for ( int iDetector = 0; iDetector < statusCollectionVec->getNumberOfElements() ; iDetector++) 
-    {
-        TrackerRawDataImpl * status = dynamic_cast< TrackerRawDataImpl * > ( statusCollectionVec->getElementAt( iDetector ) );
-        vector< short > statusVec = status->adcValues();
-        streamlog_out ( DEBUG3 ) << 
-            " freq loop: idet=" << iDetector << 
-            " statusVec.size=" <<  statusVec.size() << endl;
+            streamlog_out ( DEBUG3 ) << 
+                " freq loop: idet=" << iDetector << 
+                " statusVec.size=" <<  statusVec.size() << endl;
         
-        // some incremental index value to status of each pixel 
-        for ( unsigned int index = 0; index < statusVec.size(); index++ ) 
-        {
-            streamlog_out ( DEBUG3 )  << 
-                " index "<< index << 
-                " all " << statusVec.size() << 
-                " statusVec[index]: " <<  statusVec[index] << 
-                " hit:" << EUTELESCOPE::HITPIXEL << endl;
-            streamlog_out ( DEBUG3)  << 
-                " get index " << index << 
-                " (tot " << statusVec.size() << ")" <<
-                " (orig decoded_XY_index = " << _inverse_hitIndexMapVec[iDetector][index] <<
-                " freq " << _firingFreqVec[iDetector][index] <<
-                " status " <<  statusVec[ index ]  << endl;
-            
-           if( statusVec[ index ] == EUTELESCOPE::HITPIXEL ) 
+            for ( unsigned int index = 0; index < statusVec.size(); index++ ) 
             {
-                _firingFreqVec[ iDetector ][ index ] += 1;
-                status->adcValues()[ index ] = EUTELESCOPE::GOODPIXEL;
-                if( _firingFreqVec[ iDetector ][ index ]  > 1   )
+                if( statusVec[ index ] == EUTELESCOPE::HITPIXEL ) 
                 {
-                    streamlog_out ( DEBUG3) << 
-                        " idet: " << iDetector <<
-                        " get index " << index <<
-                        " (tot " << statusVec.size() << ")" <<
-                        " (orig decoded_XY_index = " <<  _inverse_hitIndexMapVec[iDetector][index] << 
-                        " freq: " <<  _firingFreqVec[ iDetector ][ index ] <<
-                        " statusVec[index]: " <<  statusVec[ index ]  << endl;
+                    _firingFreqVec[ iDetector ][ index ] += 1;
+                    statusVec[ index ] = EUTELESCOPE::GOODPIXEL;
                 }
             }
         }
@@ -483,6 +420,11 @@ void EUTelProcessorHotPixelFinder::processEvent (LCEvent * event)
 
 void EUTelProcessorHotPixelFinder::end() {
 
+  if( getBuildHotPixelDatabase() != 0 && _noOfAccumulatedEvents > 0 )
+  {
+      HotPixelDBWriter();
+  }
+
   streamlog_out ( MESSAGE4 ) << "Successfully finished" << endl;
   streamlog_out ( MESSAGE4 ) << printSummary() << endl;
 
@@ -551,17 +493,21 @@ void EUTelProcessorHotPixelFinder::check( LCEvent * event )
                 }
 
                 TrackerRawDataImpl * status = dynamic_cast< TrackerRawDataImpl * > ( statusCollectionVec->getElementAt( iDetector ) );
-                vector< short > statusVec = status->adcValues();
                 unsigned short killerCounter = 0;
+
+                // the database counters accumulate over the whole run and
+                // are not related to the pixels of the status collection
+                const bool buildDB = getBuildHotPixelDatabase() != 0;
+                const double noOfEvents = buildDB ? static_cast< double >( _noOfAccumulatedEvents ) : static_cast< double >( _iEvt );
                 
                 for ( unsigned int iPixel = 0; iPixel < _firingFreqVec[iDetector].size(); iPixel++ ) 
                 {
-                    if ( _firingFreqVec[iDetector][ iPixel ] / ( static_cast< double >( _iEvt ) ) > _maxAllowedFiringFreq ) 
+                    if ( _firingFreqVec[iDetector][ iPixel ] / noOfEvents > _maxAllowedFiringFreq ) 
                     {
                         streamlog_out ( DEBUG5 ) << " Pixel " << iPixel << " on detector " << _sensorIDVec.at( iDetector )
-                            << " is firing too often (" << _firingFreqVec[iDetector][iPixel] / (static_cast< double >( _iEvt ) )
+                            << " is firing too often (" << _firingFreqVec[iDetector][iPixel] / noOfEvents
                             << "). Masking it now on! " << endl;
-                        status->adcValues()[ iPixel ] = EUTELESCOPE::FIRINGPIXEL;
+                        if( !buildDB ) status->adcValues()[ iPixel ] = EUTELESCOPE::FIRINGPIXEL;
                         ++killerCounter;
                    }
                 }
@@ -577,11 +523,6 @@ void EUTelProcessorHotPixelFinder::check( LCEvent * event )
       // increment the cycle number
       ++_iCycle;
 
-      if( getBuildHotPixelDatabase() != 0 )
-      {
-          HotPixelDBWriter(event );
-      }
-
       // reset the _iEvt counter
       _iEvt = 0;
 
@@ -593,7 +534,7 @@ void EUTelProcessorHotPixelFinder::check( LCEvent * event )
 }
 
 
-void EUTelProcessorHotPixelFinder::HotPixelDBWriter(LCEvent *input_event)
+void EUTelProcessorHotPixelFinder::HotPixelDBWriter()
 {    
 //    lccd::DBInterface dbinterface =  lccd::DBInterface("m26", false);
 //    lccd::LCCDTimeStamp timestampe= lccd::LCCDTimeStamp();
@@ -603,10 +544,6 @@ void EUTelProcessorHotPixelFinder::HotPixelDBWriter(LCEvent *input_event)
     streamlog_out ( MESSAGE5 ) << "EUTelProcessorHotPixelFinder::HotPixelDBWriter " << endl;
     streamlog_out ( MESSAGE5 ) << "writing out hot pixel db into " << _hotpixelDBFile.c_str() << endl;
 
-    // create data decoder
-    LCCollectionVec * statusCollectionVec = dynamic_cast< LCCollectionVec * > ( input_event->getCollection( _statusCollectionName ) );
-    CellIDDecoder<TrackerRawDataImpl > decoder( statusCollectionVec );
-
     // reopen the LCIO file this time in append mode
     LCWriter * lcWriter = LCFactory::getInstance()->createLCWriter();
     LCReader * lcReader = LCFactory::getInstance()->createLCReader();
@@ -714,16 +651,18 @@ void EUTelProcessorHotPixelFinder::HotPixelDBWriter(LCEvent *input_event)
 
 
 
+    // a pixel is hot above this number of hits
+    const double maxFiringCount = _maxAllowedFiringFreq * static_cast< double >( _noOfAccumulatedEvents );
+
     for ( unsigned int iDetector = 0; iDetector < _firingFreqVec.size(); iDetector++ ) 
     {
-        TrackerRawDataImpl * status = dynamic_cast< TrackerRawDataImpl * > ( statusCollectionVec->getElementAt( iDetector ) );
-        int sensorID = decoder( status ) [ "sensorID" ] ;
+        int sensorID = _sensorIDVec.at( iDetector );
         streamlog_out ( MESSAGE5 ) <<
                                  " iDetector : " << iDetector  <<
                                  " sensorID : " << sensorID  <<
                                   endl;
 
-        vector< short > statusVec  = status->adcValues();
+        const EUTelMatrixDecoder & matrixDecoder = _matrixDecoderVec[ iDetector ];
          
         CellIDEncoder< TrackerDataImpl > hotPixelEncoder  ( eutelescope::EUTELESCOPE::ZSDATADEFAULTENCODING, hotPixelCollection  );
         hotPixelEncoder["sensorID"]        = sensorID;
@@ -737,21 +676,20 @@ void EUTelProcessorHotPixelFinder::HotPixelDBWriter(LCEvent *input_event)
         std::auto_ptr< eutelescope::EUTelTrackerDataInterfacerImpl< eutelescope::EUTelGenericSparsePixel > >
             sparseFrame( new eutelescope::EUTelTrackerDataInterfacerImpl< eutelescope::EUTelGenericSparsePixel > ( currentFrame.get() ) );
 
+        EUTelGenericSparsePixel hotPixel;
         for ( unsigned int iPixel = 0; iPixel < _firingFreqVec[iDetector].size(); iPixel++ ) 
         {
-            int decoded_XY_index = _inverse_hitIndexMapVec[iDetector][iPixel];
-
-            if ( decoded_XY_index > 0 &&  statusVec[ iPixel ] == EUTELESCOPE::FIRINGPIXEL )                
+            if ( _firingFreqVec[iDetector][ iPixel ] > maxFiringCount )
             {
+                 hotPixel.setXCoord( matrixDecoder.getXFromIndex( iPixel ) );
+                 hotPixel.setYCoord( matrixDecoder.getYFromIndex( iPixel ) );
                  streamlog_out ( MESSAGE5 ) <<
                      " writing out idet: " << iDetector <<
-                     " ipixel: " << iPixel <<
-                     " statusVec: " << statusVec[ iPixel ]  <<
-                     " decoded_XY_index " << decoded_XY_index <<
-                     " fired " <<   _firingFreqVec[iDetector][ iPixel ]  / ( static_cast< double >( _iEvt ) ) <<
+                     " pixel: " << hotPixel.getXCoord() << "," << hotPixel.getYCoord() <<
+                     " fired " <<   _firingFreqVec[iDetector][ iPixel ]  / ( static_cast< double >( _noOfAccumulatedEvents ) ) <<
                      " allowed = " << _maxAllowedFiringFreq << 
                      endl; 
-                 sparseFrame->addSparsePixel( _pixelMapVec[iDetector][ decoded_XY_index] );                
+                 sparseFrame->addSparsePixel( &hotPixel );
             }
         }
 
@@ -839,22 +777,16 @@ void EUTelProcessorHotPixelFinder::bookAndFillHistos()
                                                                 nBin, min, max );
     firing1DHisto->setTitle("Firing frequency distribution");
 
-    int iPixel = 0;
+    const EUTelMatrixDecoder & matrixDecoder = _matrixDecoderVec[ iDetector ];
+    const double noOfEvents = ( getBuildHotPixelDatabase() != 0 ) ? static_cast< double >( _noOfAccumulatedEvents ) : static_cast< double >( _noOfEventPerCycle );
 
-  //  streamlog_out( MESSAGE5 ) << " iDetector " << iDetector << "  _firingFreqVec.size = " <<  _firingFreqVec.size() << endl;
-    
-    for (int yPixel = _minY[_sensorIDVec.at( iDetector)]; yPixel <= _maxY[_sensorIDVec.at( iDetector)]; yPixel++) 
+    for ( unsigned int iPixel = 0; iPixel < _firingFreqVec[ iDetector ].size(); iPixel++ ) 
     {
-      for (int xPixel = _minX[_sensorIDVec.at( iDetector)]; xPixel <= _maxX[_sensorIDVec.at( iDetector)]; xPixel++) 
-      {
-          //streamlog_out( MESSAGE5 ) << " iPixel = " << iPixel << " _firingFreqVec[ iDetector ].size()= " << _firingFreqVec[ iDetector ].size() <<  endl; 
-          if(  iDetector < static_cast< int >(_firingFreqVec.size()) &&  static_cast< int >(_firingFreqVec[ iDetector ].size()) > 0  &&  _firingFreqVec[ iDetector ][ iPixel ] > 0 )
-          {
-              firing2DHisto->fill(xPixel, yPixel, _firingFreqVec[ iDetector ][ iPixel ] );
-              firing1DHisto->fill( _firingFreqVec[ iDetector ][ iPixel ] / ( static_cast< double >( _noOfEventPerCycle ) ) );
-              ++iPixel;
-          }
-      }
+        if( _firingFreqVec[ iDetector ][ iPixel ] > 0 )
+        {
+            firing2DHisto->fill( matrixDecoder.getXFromIndex( iPixel ), matrixDecoder.getYFromIndex( iPixel ), _firingFreqVec[ iDetector ][ iPixel ] );
+            firing1DHisto->fill( _firingFreqVec[ iDetector ][ iPixel ] / noOfEvents );
+        }
     }
   }
   
@@ -35,7 +35,10 @@ _AllowedSharedHitsOnTrackCandidate(0),
 _nProcessedRuns(0),
 _nProcessedEvents(0),
 _eBeam(-1.),
-_qBeam(-1.)
+_qBeam(-1.),
+_useMaterialBudgetCache(false),
+_materialBudgetCacheBinSize(1.),
+_numberOfThreads(1)
 {
 	//The standard description that comes with every processor 
 	_description = "EUTelProcessorPatternRecognition preforms track pattern recognition.";
@@ -83,6 +86,14 @@ _qBeam(-1.)
 	//This specifies if the planes are strip or pixel sensors.
 	registerOptionalParameter("planeDimensions", "This is a number 1(strip sensor) or 2(pixel sensor) to identify the type of detector. Must be in z order and include all planes.", _planeDimension, IntVec());
 
+	//The radiation length seen by a seed only depends on where it starts on the telescope. Interpolating from a grid avoids tracing through TGeo for every seed.
+	registerOptionalParameter("UseMaterialBudgetCache", "Interpolate the radiation lengths from a per plane grid instead of tracing each seed through the geometry", _useMaterialBudgetCache, bool(false));
+
+	registerOptionalParameter("MaterialBudgetCacheBinSize", "Grid spacing of the material budget cache [mm]", _materialBudgetCacheBinSize, double(1.0));
+
+	//Each seed is propagated independently, so they can be shared over several threads. The track candidates come out in the same order.
+	registerOptionalParameter("NumberOfThreads", "Number of threads used to propagate the seeds of an event", _numberOfThreads, static_cast<int> (1));
+
 }
 //This is the inital function that Marlin will run only once when we run jobsub
 void EUTelProcessorPatternRecognition::init(){
@@ -95,6 +106,7 @@ void EUTelProcessorPatternRecognition::init(){
 		
 		geo::gGeometry().initialisePlanesToExcluded(_excludePlanes);//We specify the excluded planes here since this is rather generic and can be used by other processors
 		geo::gGeometry().setInitialDisplacementToFirstPlane(_initialDisplacement);//We specify this here so we can access it throughout this processor. 
+		geo::gGeometry().setMaterialBudgetCache(_useMaterialBudgetCache, _materialBudgetCacheBinSize);
 		
 		streamlog_out(MESSAGE5) << "These are the planes you will create a state from. Mass inbetween states will be turned to scatterers in GBLTrackProcessor." << std::endl;
 		for(size_t i =0 ; i < geo::gGeometry().sensorZOrderToIDWithoutExcludedPlanes().size(); ++i)
@@ -111,6 +123,7 @@ void EUTelProcessorPatternRecognition::init(){
 		_trackFitter->setPlanesToCreateSeedsFrom(_createSeedsFromPlanes);
 		_trackFitter->setBeamMomentum(_eBeam);
 		_trackFitter->setBeamCharge(_qBeam);
+		_trackFitter->setNumberOfThreads(_numberOfThreads);
 		_trackFitter->setPlaneDimensionsVec(_planeDimension);//This is to set if each plane is a strip/pixel sensor. 
 		_trackFitter->setAutoPlanestoCreateSeedsFrom();//If the user has not specified which planes to seed from the the first plane is used
 		_trackFitter->testUserInput();//Here we check that the user has provided the correct data. This is the most likey place to throw and exception.
@@ -57,6 +57,7 @@
 #include <memory>
 #include <iostream>
 #include <cmath>
+#include <algorithm>
 
 using namespace lcio;
 using namespace marlin;
@@ -333,6 +334,7 @@ void EUTelProcessorSparseClustering::sparseClustering(LCEvent* evt, LCCollection
 
 			int hitPixelsInEvent = sparseData->size();
 			std::vector<EUTelGenericSparsePixel> hitPixelVec;
+			hitPixelVec.reserve( hitPixelsInEvent );
 			EUTelGenericSparsePixel* pixel = new EUTelGenericSparsePixel;
 
 			//This for-loop loads all the hits of the given event and detector plane and stores them
@@ -346,63 +348,23 @@ void EUTelProcessorSparseClustering::sparseClustering(LCEvent* evt, LCCollection
 				hitPixelVec.push_back( hitPixel );
 			}	
 
-			std::vector<EUTelGenericSparsePixel> newlyAdded;
-			//We now cluster those hits together
-			while( !hitPixelVec.empty() )
+			//We now cluster those hits together, each entry holds the indices of the pixels
+			//in hitPixelVec in the order they were attached to the cluster
+			std::vector< std::vector<size_t> > clusterIndexVec;
+			groupPixels( hitPixelVec, clusterIndexVec );
+
+			for( std::vector< std::vector<size_t> >::const_iterator clusterIt = clusterIndexVec.begin(); clusterIt != clusterIndexVec.end(); ++clusterIt )
 			{
                            	// prepare a TrackerData to store the cluster candidate
 				std::auto_ptr< TrackerDataImpl > zsCluster ( new TrackerDataImpl );
 				// prepare a reimplementation of sparsified cluster
 				std::auto_ptr<EUTelSparseClusterImpl<EUTelGenericSparsePixel > > sparseCluster ( new EUTelSparseClusterImpl<EUTelGenericSparsePixel>( zsCluster.get() ) );
 
-				//First we need to take any pixel, so let's take the first one
-				//Add it to the cluster as well as the newly added pixels
-				newlyAdded.push_back( hitPixelVec.front() );
-				sparseCluster->addSparsePixel( &(hitPixelVec.front()) );
-				//And remove it from the original collection
-				hitPixelVec.erase( hitPixelVec.begin() );
-
-				//Now process all newly added pixels, initially this is the just previously added one
-				//but in the process of neighbour finding we continue to add new pixels
-				while( !newlyAdded.empty() )
+				for( std::vector<size_t>::const_iterator indexIt = clusterIt->begin(); indexIt != clusterIt->end(); ++indexIt )
 				{
-					bool newlyDone = true;
-					int  x1, x2, y1, y2, dX, dY;
-
-					//check against all pixels in the hitPixelVec
-					for( std::vector<EUTelGenericSparsePixel>::iterator hitVec = hitPixelVec.begin(); hitVec != hitPixelVec.end(); ++hitVec )
-					{
-						//get the relevant infos from the newly added pixel
-						x1 = newlyAdded.front().getXCoord();
-						y1 = newlyAdded.front().getYCoord();
-
-						//and the pixel we test against
-						x2 = hitVec->getXCoord();
-						y2 = hitVec->getYCoord();
-
-						dX = x1 - x2;
-						dY = y1 - y2;
-						int distance = dX*dX+dY*dY;
-						//if they pass the spatial and temporal cuts, we add them
-						if( distance <= _sparseMinDistanceSquared )
-						{
-							//add them to the cluster as well as to the newly added ones
-							newlyAdded.push_back( *hitVec );
-							sparseCluster->addSparsePixel( &(*hitVec) );
-							//and remove it from the original collection
-							hitPixelVec.erase( hitVec );
-							//for the pixel we test there might be other neighbours, we still have to check
-							newlyDone = false;
-							break;
-						}
-					}
-
-					//if no neighbours are found, we can delete the pixel from the newly added
-					//we tested against _ALL_ non cluster pixels, there are no other pixels
-					//which could be neighbours
-					if(newlyDone) newlyAdded.erase( newlyAdded.begin() );
+					sparseCluster->addSparsePixel( &(hitPixelVec[*indexIt]) );
 				}
-				
+
 				//Now we need to process the found cluster
 				if (  sparseCluster->size() > 0 )
 				{
@@ -461,6 +423,88 @@ void EUTelProcessorSparseClustering::sparseClustering(LCEvent* evt, LCCollection
 
 
 
+void EUTelProcessorSparseClustering::groupPixels(const std::vector<EUTelGenericSparsePixel>& hitPixelVec, std::vector< std::vector<size_t> >& clusterIndexVec) const
+{
+	clusterIndexVec.clear();
+	const size_t nPixels = hitPixelVec.size();
+	if( nPixels == 0 ) return;
+
+	//a negative cut can never be fulfilled, every pixel is a cluster on its own
+	if( _sparseMinDistanceSquared < 0 )
+	{
+		clusterIndexVec.resize( nPixels );
+		for( size_t i = 0; i < nPixels; ++i ) clusterIndexVec[i].push_back( i );
+		return;
+	}
+
+	//largest coordinate difference along one axis which can still pass the cut
+	int maxDelta = 0;
+	while( (maxDelta+1)*(maxDelta+1) <= _sparseMinDistanceSquared ) ++maxDelta;
+
+	//sorted index: the upper 32 bits encode (x,y), the lower 32 bits the position in hitPixelVec,
+	//so all pixels of one column form a contiguous range sorted by y
+	std::vector<unsigned long long> sortedKeys;
+	sortedKeys.reserve( nPixels );
+	for( size_t i = 0; i < nPixels; ++i )
+	{
+		unsigned long long xKey = static_cast<unsigned long long>( hitPixelVec[i].getXCoord() + 32768 );
+		unsigned long long yKey = static_cast<unsigned long long>( hitPixelVec[i].getYCoord() + 32768 );
+		sortedKeys.push_back( (((xKey << 16) | yKey) << 32) | static_cast<unsigned long long>(i) );
+	}
+	std::sort( sortedKeys.begin(), sortedKeys.end() );
+
+	std::vector<bool> isClustered( nPixels, false );
+	std::vector<size_t> neighbours;
+
+	//the clusters are seeded in the order of the input pixels and grown breadth first,
+	//neighbours of a pixel are attached in their input order
+	for( size_t seed = 0; seed < nPixels; ++seed )
+	{
+		if( isClustered[seed] ) continue;
+
+		clusterIndexVec.push_back( std::vector<size_t>() );
+		std::vector<size_t>& cluster = clusterIndexVec.back();
+		cluster.push_back( seed );
+		isClustered[seed] = true;
+
+		for( size_t head = 0; head < cluster.size(); ++head )
+		{
+			const int x1 = hitPixelVec[ cluster[head] ].getXCoord();
+			const int y1 = hitPixelVec[ cluster[head] ].getYCoord();
+			neighbours.clear();
+
+			for( int dX = -maxDelta; dX <= maxDelta; ++dX )
+			{
+				const int x2 = x1 + dX;
+				if( x2 < -32768 || x2 > 32767 ) continue;
+
+				int maxDeltaY = 0;
+				while( dX*dX + (maxDeltaY+1)*(maxDeltaY+1) <= _sparseMinDistanceSquared ) ++maxDeltaY;
+				const int yLow  = std::max( y1 - maxDeltaY, -32768 );
+				const int yHigh = std::min( y1 + maxDeltaY,  32767 );
+
+				const unsigned long long xKey = static_cast<unsigned long long>( x2 + 32768 );
+				const unsigned long long lowKey  = ((xKey << 16) | static_cast<unsigned long long>( yLow + 32768 )) << 32;
+				const unsigned long long highKey = ((((xKey << 16) | static_cast<unsigned long long>( yHigh + 32768 )) << 32) | 0xFFFFFFFFULL);
+
+				std::vector<unsigned long long>::const_iterator keyIt = std::lower_bound( sortedKeys.begin(), sortedKeys.end(), lowKey );
+				for( ; keyIt != sortedKeys.end() && *keyIt <= highKey; ++keyIt )
+				{
+					const size_t index = static_cast<size_t>( *keyIt & 0xFFFFFFFFULL );
+					if( !isClustered[index] ) neighbours.push_back( index );
+				}
+			}
+
+			std::sort( neighbours.begin(), neighbours.end() );
+			for( std::vector<size_t>::const_iterator it = neighbours.begin(); it != neighbours.end(); ++it )
+			{
+				isClustered[*it] = true;
+				cluster.push_back( *it );
+			}
+		}
+	}
+}
+
 void EUTelProcessorSparseClustering::check (LCEvent * /* evt */) {
   // nothing to check here - could be used to fill check plots in reconstruction processor
 }
@@ -68,9 +68,9 @@ TVector3 EUTelState::getPositionGlobal() const {
 	TVector3 posGlobalVec(posGlobal[0],posGlobal[1],posGlobal[2]);
 	return posGlobalVec;
 }
-TVectorD EUTelState::getStateVec(){ 
+Vector5d EUTelState::getStateVec(){ 
 	streamlog_out( DEBUG1 ) << "EUTelState::getTrackStateVec()------------------------BEGIN" << std::endl;
-	TVectorD stateVec(5);
+	Vector5d stateVec;
 	stateVec[0] = -1.0/getMomLocal().Mag();
 	stateVec[1] = getMomLocalX()/getMomLocalZ();
 	stateVec[2] = getMomLocalY()/getMomLocalZ(); 
@@ -124,12 +124,11 @@ TMatrixDSym EUTelState::getScatteringVarianceInLocalFrame(float  variance){
 
 	return precisionMatrix;
 }
-TMatrixDSym EUTelState::getStateCov() const {
+Matrix5d EUTelState::getStateCov() const {
 
 //	streamlog_out( DEBUG1 ) << "EUTelState::getTrackStateCov()----------------------------BEGIN" << std::endl;
-	TMatrixDSym C(5);   
+	Matrix5d C = Matrix5d::Zero();   
 //	const EVENT::FloatVec& trkCov = getCovMatrix();        
-	C.Zero();
             
 //	C[0][0] = trkCov[0]; 
 //	C[1][0] = trkCov[1];  C[1][1] = trkCov[2]; 
@@ -155,13 +154,9 @@ void EUTelState::getCombinedHitAndStateCovMatrixInLocalFrame( double (&cov)[4] )
 	cov[2] = _covCombinedMatrix[2];
 	cov[3] = _covCombinedMatrix[3];
 }
-TMatrixD EUTelState::getProjectionMatrix() const {
-	TMatrixD projection(5,5);
-	projection.Zero();
-	TMatrixD proM2l(2, 2);
-	proM2l.UnitMatrix();
-	projection.SetSub(3, 3, proM2l);
-	return proM2l;
+Eigen::Matrix2d EUTelState::getProjectionMatrix() const {
+	//The measurement is (x,y) of the local frame, so it projects directly onto the last two state parameters
+	return Eigen::Matrix2d::Identity();
 }
 TVector3 EUTelState::getMomLocal(){
 	TVector3 pVecUnitLocal;
@@ -341,14 +336,6 @@ TVector3 EUTelState::getMomGlobal() const {
 //THIS IS ASSOCIATED SO THE AIR INFRONT OF A SENSOR IS ASSOCIATED WITH IT.
 //EXCLUDED PLANES ARE REDUCED TO MORE RADIATION LENGTH IN FRONT OF A NON EXCLUDED PLANE.
 float EUTelState::computeRadLengthsToEnd( std::map<const int,double> & mapSensor, std::map<const int ,double> & mapAir){
-	//Get the ID of the last sensor
-	int lastPlaneID = 	geo::gGeometry().sensorZOrderToIDWithoutExcludedPlanes().at( geo::gGeometry().sensorZOrderToIDWithoutExcludedPlanes().size()-1 );
-	float intersectionPoint[3];
-	TVector3 momentumAtIntersection;
-	float arcLength;
-	int holder; //This is used to return the plane which is found.
-	//DETERMINE INTERSECTION ON LAST PLANE USING STATE INFORMATION.
-	findIntersectionWithCertainID(lastPlaneID, intersectionPoint, momentumAtIntersection,arcLength,holder );
 	TVector3 gPos =  getPositionGlobal();
 	//TO DO: At the moment we just use a straight through the sensor in all enviroments. The code is designed to extend this to any straight line but we see some addition of extra radiation length beyond what is expect. This will have to be looked into but not a huge issue at the moment.
 	//NOTE THE Z VALUE FOR THESE ARE NOT USED IN calculateTotalRadiationLengthAndWeights
@@ -356,7 +343,8 @@ float EUTelState::computeRadLengthsToEnd( std::map<const int,double> & mapSensor
 	const double end[]   = {gPos[0],gPos[1],gPos[2]+0.025};//Must make sure we add all silicon.
 	//NOW WE CALCULATE THE RADIATION LENGTH FOR THE FULL FLIGHT AND THEN SPLIT THESE INTO LINEAR  COMMPONENTS FOR SCATTERING ESTIMATION. 
 	//We will return the radiation lengths associate with the planes and air. Note excluded planes volume should be added to the air in front of non excluded planes. 
-	float rad =	geo::gGeometry().calculateTotalRadiationLengthAndWeights( start,end,  mapSensor, mapAir);
+	//With the material budget cache switched on this is interpolated from precomputed values of this plane.
+	float rad =	geo::gGeometry().getRadiationLengthsToEnd( getLocation(), start,end,  mapSensor, mapAir);
 	return rad;
 }
 
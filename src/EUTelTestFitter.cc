@@ -181,6 +181,7 @@ EUTelTestFitter::EUTelTestFitter()
   _nominalErrorX(NULL),
   _nominalFitArrayY(NULL),
   _nominalErrorY(NULL),
+  _maskFitArrays(),
   _noOfEventWOInputHit(0),
   _noOfEventWOTrack(0),
   _noOfTracks(0),
@@ -852,6 +853,10 @@ void EUTelTestFitter::processRunHeader( LCRunHeader* runHeader) {
 
   _nRun++ ;
 
+  // Fit matrices are calculated again for each run
+
+  _maskFitArrays.clear();
+
   // Decode and print out Run Header information - just a check
 
   int runNr = runHeader->getRunNumber();
@@ -1396,6 +1401,19 @@ void EUTelTestFitter::processEvent( LCEvent * event ) {
 
     double chi2min  = numeric_limits<double >::max();
 
+    // Lowest chi2 of the tracks stored so far; when only the best
+    // track is kept, hypotheses which can not beat it are skipped
+
+    double chi2best = numeric_limits<double >::max();
+
+    // Lowest partial chi2 of the hypotheses cut by the prefix fit; it
+    // is a lower bound of their track chi2 and stands in for chi2min
+    // in the firstChi2 histogram when they were the best ones
+
+    double chi2pruned = numeric_limits<double >::max();
+
+    double missingPenalty = (_nActivePlanes-nFiredPlanes)*_missingHitPenalty ;
+
     // Loop over fit possibilities
     // Start from one-hit track to allow for "smart" skipping of wrong matches
 
@@ -1449,6 +1467,24 @@ void EUTelTestFitter::processEvent( LCEvent * event ) {
 
       double lastSlopeX=0.;
       double lastSlopeY=0.;
+
+      // Fit to the hits selected in the planes decoded so far. Adding
+      // hits can only increase its chi2, so once it is above the limit
+      // all hypotheses sharing these hits are skipped without fitting.
+      // Value >=0 gives the plane at which the hypothesis was rejected
+
+      PrefixFit prefixFitX;
+      PrefixFit prefixFitY;
+
+      InitPrefixFit(prefixFitX,_beamSlopeX);
+      InitPrefixFit(prefixFitY,_beamSlopeY);
+
+      double chi2Limit = _chi2Max;
+      if(!_searchMultipleTracks && chi2best < chi2Limit) chi2Limit = chi2best;
+
+      int firstPrefixCut = -1;
+      int nNotUsed = 0;
+      int nSkipped = 0;
  
       // Fill position and error arrays for this hit configuration
 
@@ -1517,11 +1553,48 @@ void EUTelTestFitter::processEvent( LCEvent * event ) {
           {
             nleft++;        // Counts number of planes with missing
 			    // hits after the last hit
+            nNotUsed++;
+            if(_planeHits[ipl]>0) nSkipped++;
+          }
+        }
+
+        AddPrefixFitPlane(prefixFitX, ipl, _planeX[ipl], _planeEx[ipl]);
+        AddPrefixFitPlane(prefixFitY, ipl, _planeY[ipl], _planeEy[ipl]);
+
+        if(_isActive[ipl])
+        {
+          // Too many planes without hit for an accepted track
+
+          if(nNotUsed > _allowMissingHits || nSkipped > _allowSkipHits)
+          {
+            firstPrefixCut = ipl;
+            break;
+          }
+
+          if(nChoiceFired >= 2 && nleft == 0)
+          {
+            double prefixChi2 = GetPrefixFitChi2(prefixFitX) + GetPrefixFitChi2(prefixFitY)
+              + missingPenalty + nSkipped*_skipHitPenalty;
+
+            if(prefixChi2 >= chi2Limit)
+            {
+              if(prefixChi2 < chi2pruned) chi2pruned = prefixChi2;
+              firstPrefixCut = ipl;
+              break;
+            }
           }
         }
       }
       // End of plane loop (decoding fit hypothesis)
 
+      // Skip all hypotheses with the same hits up to the rejected plane
+
+      if(firstPrefixCut >= 0)
+      {
+        ichoice -= ichoice % _planeMod[firstPrefixCut];
+        continue;
+      }
+
 
       // Check number of selected hits
       // =============================
@@ -1577,7 +1650,8 @@ void EUTelTestFitter::processEvent( LCEvent * event ) {
       {
         choiceChi2 = NominalFit();
       } else {
-        if(_useNominalResolution && _beamSlopeX==_beamSlopeY) choiceChi2 = SingleFit();
+        if(_useNominalResolution && _nTelPlanes <= numeric_limits<unsigned long>::digits) choiceChi2 = MaskFit();
+        else if(_useNominalResolution && _beamSlopeX==_beamSlopeY) choiceChi2 = SingleFit();
         else choiceChi2 = MatrixFit();
       }
 
@@ -1643,6 +1717,8 @@ void EUTelTestFitter::processEvent( LCEvent * event ) {
 
         fittedChi2.insert( make_pair( trackChi2, nFittedTracks ));
 
+        if(trackChi2 < chi2best) chi2best = trackChi2;
+
         fittedPenalty.push_back(penalty); 
         fittedFired.push_back(nChoiceFired);
 
@@ -1699,7 +1775,9 @@ if(jhit>=0){
     // End of loop over track possibilities
 
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
-    (dynamic_cast<AIDA::IHistogram1D*> ( _aidaHistoMap[_firstChi2HistoName]))->fill(log10(chi2min));
+    // Pruned hypotheses are at least at chi2Limit, so below Chi2Max
+    // this is the exact best chi2 and above it a lower bound
+    (dynamic_cast<AIDA::IHistogram1D*> ( _aidaHistoMap[_firstChi2HistoName]))->fill(log10(chi2min < chi2pruned ? chi2min : chi2pruned));
 #endif
 
     if(nFittedTracks==0) {
@@ -2524,6 +2602,71 @@ double EUTelTestFitter::NominalFit()
 }
 
 
+double EUTelTestFitter::MaskFit()
+{
+  unsigned long mask = 0;
+
+  for(int ipl=0; ipl<_nTelPlanes;ipl++)
+    if(_isActive[ipl] && _planeEx[ipl]>0.) mask |= 1UL << ipl ;
+
+  std::map<unsigned long, std::vector<double> >::iterator maskFit = _maskFitArrays.find(mask);
+
+  if(maskFit == _maskFitArrays.end())
+    {
+      // First track with this hit pattern: invert fit matrix
+
+      for(int ipl=0; ipl<_nTelPlanes;ipl++)
+        {
+          _fitX[ipl]=0. ;
+          _fitEx[ipl]=_planeEx[ipl];
+        }
+
+      std::vector<double> & fitArray = _maskFitArrays[mask];
+
+      if(DoAnalFit(_fitX,_fitEx)==0)
+        fitArray.assign(_fitArray, _fitArray + _nTelPlanes*_nTelPlanes);
+
+      maskFit = _maskFitArrays.find(mask);
+    }
+
+  const std::vector<double> & fitArray = maskFit->second;
+
+  if(fitArray.empty()) return -1. ;
+
+  for(int ipl=0; ipl<_nTelPlanes;ipl++)
+    {
+      _fitEx[ipl]=_fitEy[ipl]=sqrt(fitArray[ipl+ipl*_nTelPlanes]);
+
+      _fitX[ipl]=0. ;
+      _fitY[ipl]=0. ;
+
+      for(int jpl=0; jpl<_nTelPlanes;jpl++)
+        if(_planeEx[jpl]>0.)
+          {
+            _fitX[ipl]+=fitArray[ipl+jpl*_nTelPlanes]*_planeX[jpl]/_planeEx[jpl]/_planeEx[jpl];
+            _fitY[ipl]+=fitArray[ipl+jpl*_nTelPlanes]*_planeY[jpl]/_planeEy[jpl]/_planeEy[jpl];
+          }
+
+      // Correction for beam slope
+
+      if(_useBeamConstraint && _beamSlopeX!=0.)
+        {
+          _fitX[ipl]-=fitArray[ipl]*_beamSlopeX*_planeDist[0]*_planeScat[0];
+          _fitX[ipl]+=fitArray[ipl+_nTelPlanes]*_beamSlopeX*_planeDist[0]*_planeScat[0];
+        }
+
+      if(_useBeamConstraint && _beamSlopeY!=0.)
+        {
+          _fitY[ipl]-=fitArray[ipl]*_beamSlopeY*_planeDist[0]*_planeScat[0];
+          _fitY[ipl]+=fitArray[ipl+_nTelPlanes]*_beamSlopeY*_planeDist[0]*_planeScat[0];
+        }
+    }
+
+  double chi2=GetFitChi2();
+
+  return chi2 ;
+}
+
 int EUTelTestFitter::DoAnalFit(double * pos, double *err, double slope)
 {
   for(int ipl=0; ipl<_nTelPlanes;ipl++)
@@ -2678,6 +2821,110 @@ double EUTelTestFitter::GetFitChi2()
 
 
 
+void EUTelTestFitter::InitPrefixFit(PrefixFit & fit, double slope) const
+{
+  fit.m00 = fit.m01 = fit.m11 = 0. ;
+  fit.r0  = fit.r1  = fit.c   = 0. ;
+
+  // Beam constraint acts on the positions in the first two planes,
+  // which are the ones not yet eliminated
+
+  if(_useBeamConstraint)
+    {
+      double scat = _planeScat[0]*_planeDist[0]*_planeDist[0] ;
+
+      fit.m00 =  scat ;
+      fit.m01 = -scat ;
+      fit.m11 =  scat ;
+      fit.r0  = -slope*_planeDist[0]*_planeScat[0] ;
+      fit.r1  =  slope*_planeDist[0]*_planeScat[0] ;
+      fit.c   =  slope*slope*_planeScat[0] ;
+    }
+}
+
+void EUTelTestFitter::AddPrefixFitPlane(PrefixFit & fit, int ipl, double pos, double err) const
+{
+  // Measurement in plane ipl
+
+  if(_isActive[ipl] && err>0.)
+    {
+      double weight = 1./err/err ;
+
+      fit.m00 += weight ;
+      fit.r0  += weight*pos ;
+      fit.c   += weight*pos*pos ;
+    }
+
+  // Scattering in plane ipl+1 couples positions in planes ipl, ipl+1
+  // and ipl+2 (same terms as in DoAnalFit)
+
+  double n00 = fit.m00 ;
+  double n01 = fit.m01 ;
+  double n11 = fit.m11 ;
+  double n02 = 0., n12 = 0., n22 = 0. ;
+
+  if(ipl < _nTelPlanes-2)
+    {
+      double v0 =  _planeDist[ipl] ;
+      double v1 = -(_planeDist[ipl+1]+_planeDist[ipl]) ;
+      double v2 =  _planeDist[ipl+1] ;
+      double scat = _planeScat[ipl+1] ;
+
+      n00 += scat*v0*v0 ;
+      n01 += scat*v0*v1 ;
+      n02 += scat*v0*v2 ;
+      n11 += scat*v1*v1 ;
+      n12 += scat*v1*v2 ;
+      n22 += scat*v2*v2 ;
+    }
+
+  // Eliminate position in plane ipl
+
+  if(n00 > 0.)
+    {
+      double inv = 1./n00 ;
+
+      fit.m00 = n11 - n01*n01*inv ;
+      fit.m01 = n12 - n01*n02*inv ;
+      fit.m11 = n22 - n02*n02*inv ;
+      fit.c  -= fit.r0*fit.r0*inv ;
+      double r0 = fit.r0 ;
+      fit.r0  = fit.r1 - n01*r0*inv ;
+      fit.r1  = -n02*r0*inv ;
+    }
+  else
+    {
+      fit.m00 = n11 ;
+      fit.m01 = n12 ;
+      fit.m11 = n22 ;
+      fit.r0  = fit.r1 ;
+      fit.r1  = 0. ;
+    }
+}
+
+double EUTelTestFitter::GetPrefixFitChi2(const PrefixFit & fit) const
+{
+  // Minimum of the remaining quadratic form in the positions of the
+  // next two planes. Directions not constrained by the measurements
+  // (zero pivot) do not contribute.
+
+  double chi2 = fit.c ;
+  double m11  = fit.m11 ;
+  double r1   = fit.r1 ;
+
+  if(fit.m00 > 0.)
+    {
+      chi2 -= fit.r0*fit.r0/fit.m00 ;
+      m11  -= fit.m01*fit.m01/fit.m00 ;
+      r1   -= fit.m01*fit.r0/fit.m00 ;
+    }
+
+  if(m11 > 1.e-9*fit.m11)
+    chi2 -= r1*r1/m11 ;
+
+  return chi2 ;
+}
+
 int EUTelTestFitter::GaussjSolve(double *alfa,double *beta,int n)
 {
   int *ipiv;
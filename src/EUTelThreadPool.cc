@@ -0,0 +1,174 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelThreadPool.h"
+
+// lcio includes <.h>
+#include <Exceptions.h>
+
+// marlin includes ".h"
+#include "streamlog/streamlog.h"
+
+// ROOT includes ".h"
+#include "RVersion.h"
+#include "TROOT.h"
+
+// system includes <>
+#include <exception>
+#include <sstream>
+
+using namespace eutelescope;
+
+EUTelThreadPool::EUTelThreadPool( int nThreads ) :
+  _workers(),
+  _mutex(),
+  _startCondition(),
+  _doneCondition(),
+  _job(NULL),
+  _nItems(0),
+  _nextItem(0),
+  _generation(0),
+  _nBusy(0),
+  _nIndexedWorkers(0),
+  _shutdown(false),
+  _failed(false),
+  _error()
+{
+  pthread_mutex_init( &_mutex, NULL );
+  pthread_cond_init( &_startCondition, NULL );
+  pthread_cond_init( &_doneCondition, NULL );
+
+  if( nThreads > 1 ) {
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,0,0)
+    // ROOT objects like TVectorD are created and destroyed inside the jobs
+    ROOT::EnableThreadSafety();
+#endif
+    for( int i = 1; i < nThreads; ++i ) {
+      pthread_t thread;
+      if( pthread_create( &thread, NULL, workerEntry, this ) != 0 ) {
+        streamlog_out( WARNING ) << "Could only start " << i << " of " << nThreads << " threads" << std::endl;
+        break;
+      }
+      _workers.push_back( thread );
+    }
+  }
+}
+
+EUTelThreadPool::~EUTelThreadPool() {
+  pthread_mutex_lock( &_mutex );
+  _shutdown = true;
+  pthread_cond_broadcast( &_startCondition );
+  pthread_mutex_unlock( &_mutex );
+
+  for( size_t i = 0; i < _workers.size(); ++i ) {
+    pthread_join( _workers[i], NULL );
+  }
+
+  pthread_cond_destroy( &_doneCondition );
+  pthread_cond_destroy( &_startCondition );
+  pthread_mutex_destroy( &_mutex );
+}
+
+void EUTelThreadPool::run( Job& job, size_t nItems ) {
+  if( nItems == 0 ) return;
+
+  pthread_mutex_lock( &_mutex );
+  _job = &job;
+  _nItems = nItems;
+  _nextItem = 0;
+  _failed = false;
+  _error.clear();
+  _nBusy = _workers.size();
+  ++_generation;
+  pthread_cond_broadcast( &_startCondition );
+  pthread_mutex_unlock( &_mutex );
+
+  processItems( 0 );
+
+  pthread_mutex_lock( &_mutex );
+  while( _nBusy > 0 ) {
+    pthread_cond_wait( &_doneCondition, &_mutex );
+  }
+  _job = NULL;
+  const bool failed = _failed;
+  const std::string error = _error;
+  pthread_mutex_unlock( &_mutex );
+
+  if( failed ) {
+    throw lcio::Exception( error );
+  }
+}
+
+void* EUTelThreadPool::workerEntry( void* pool ) {
+  static_cast<EUTelThreadPool*>( pool )->workerLoop();
+  return NULL;
+}
+
+void EUTelThreadPool::workerLoop() {
+  unsigned long seenGeneration = 0;
+
+  pthread_mutex_lock( &_mutex );
+  const int thread = ++_nIndexedWorkers;
+  while( true ) {
+    while( !_shutdown && _generation == seenGeneration ) {
+      pthread_cond_wait( &_startCondition, &_mutex );
+    }
+    if( _shutdown ) break;
+    seenGeneration = _generation;
+    pthread_mutex_unlock( &_mutex );
+
+    processItems( thread );
+
+    pthread_mutex_lock( &_mutex );
+    if( --_nBusy == 0 ) {
+      pthread_cond_signal( &_doneCondition );
+    }
+  }
+  pthread_mutex_unlock( &_mutex );
+}
+
+void EUTelThreadPool::processItems( int thread ) {
+  while( true ) {
+    pthread_mutex_lock( &_mutex );
+    if( _failed || _nextItem >= _nItems ) {
+      pthread_mutex_unlock( &_mutex );
+      return;
+    }
+    const size_t item = _nextItem++;
+    pthread_mutex_unlock( &_mutex );
+
+    try {
+      _job->process( item, thread );
+    }
+    catch( lcio::Exception& e ) {
+      setError( e.what() );
+    }
+    catch( std::exception& e ) {
+      setError( e.what() );
+    }
+    catch( std::string& e ) {
+      setError( e );
+    }
+    catch( ... ) {
+      std::stringstream ss;
+      ss << "Unknown exception while processing item " << item << " in a worker thread";
+      setError( ss.str() );
+    }
+  }
+}
+
+void EUTelThreadPool::setError( const std::string& message ) {
+  pthread_mutex_lock( &_mutex );
+  if( !_failed ) {
+    _failed = true;
+    _error = message;
+  }
+  pthread_mutex_unlock( &_mutex );
+}
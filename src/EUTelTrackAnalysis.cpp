@@ -76,7 +76,7 @@ void EUTelTrackAnalysis::plotIncidenceAngles(EUTelTrack track){
 	for(size_t i=0; i<states.size();++i){
 		EUTelState state  = states.at(i);
 		state.print();
-		TVectorD stateVec = state.getStateVec();
+		Vector5d stateVec = state.getStateVec();
 		float incidenceXZ = stateVec[1];
 		typedef std::map<int , AIDA::IHistogram1D * >::iterator it_type;
 		for(it_type iterator =_mapFromSensorIDToIncidenceXZ.begin(); iterator != _mapFromSensorIDToIncidenceXZ.end(); iterator++) {
@@ -90,7 +90,7 @@ void EUTelTrackAnalysis::plotIncidenceAngles(EUTelTrack track){
 	for(size_t i=0; i<states.size();++i){
 		EUTelState state  = states.at(i);
 		state.print();
-		TVectorD stateVec = state.getStateVec();
+		Vector5d stateVec = state.getStateVec();
 		float incidenceYZ = stateVec[2];
 		typedef std::map<int , AIDA::IHistogram1D * >::iterator it_type;
 		for(it_type iterator =_mapFromSensorIDToIncidenceYZ.begin(); iterator != _mapFromSensorIDToIncidenceYZ.end(); iterator++) {
@@ -110,7 +110,7 @@ void EUTelTrackAnalysis::plotPValueWithIncidenceAngles(EUTelTrack track){
 	for(size_t i=0; i<states.size();++i){
 		EUTelState state  = states.at(i);
 		state.print();
-		TVectorD stateVec = state.getStateVec();
+		Vector5d stateVec = state.getStateVec();
 		float incidenceXZ = stateVec[1];
 		typedef std::map<int , AIDA::IProfile1D * >::iterator it_type;
 		for(it_type iterator =_mapFromSensorIDToPValuesVsIncidenceXZ.begin(); iterator != _mapFromSensorIDToPValuesVsIncidenceXZ.end(); iterator++) {
@@ -124,7 +124,7 @@ void EUTelTrackAnalysis::plotPValueWithIncidenceAngles(EUTelTrack track){
 	for(size_t i=0; i<states.size();++i){
 		EUTelState state  = states.at(i);
 		state.print();
-		TVectorD stateVec = state.getStateVec();
+		Vector5d stateVec = state.getStateVec();
 		float incidenceYZ = stateVec[2];
 		typedef std::map<int , AIDA::IProfile1D * >::iterator it_type;
 		for(it_type iterator =_mapFromSensorIDToPValuesVsIncidenceYZ.begin(); iterator != _mapFromSensorIDToPValuesVsIncidenceYZ.end(); iterator++) {
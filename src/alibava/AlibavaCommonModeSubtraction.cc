@@ -60,7 +60,8 @@ AlibavaCommonModeSubtraction::AlibavaCommonModeSubtraction () :
 AlibavaBaseProcessor("AlibavaCommonModeSubtraction"),
 _commonmodeCollectionName(ALIBAVA::NOTSET),
 _commonmodeerrorCollectionName(ALIBAVA::NOTSET),
-_chanDataHistoName ("Common_and_Pedestal_subtracted_data_channel")
+_chanDataHistoName ("Common_and_Pedestal_subtracted_data_channel"),
+_chanDataHistos()
 {
 	
 	// modify processor description
@@ -250,20 +251,21 @@ void AlibavaCommonModeSubtraction::fillHistos(TrackerDataImpl * trkdata){
 
 	// Fill the histograms with the corrected data
 
-	FloatVec datavec;
-	datavec = trkdata->getChargeValues();
+	const FloatVec & datavec = trkdata->getChargeValues();
 	int chipnum = getChipNum(trkdata);
 
+	// the summary histogram is looked up once per chip, the channel
+	// histograms come from the table filled in bookHistos()
+	TH1D * histo1 = dynamic_cast<TH1D*> (_rootObjectMap[getSignalCorrectionName()]);
+
 	for ( size_t ichan = 0 ; ichan < datavec.size() ; ichan++ )
 	{
 		if ( isMasked(chipnum, ichan) ) continue;
 		
-		string tempHistoName = getChanDataHistoName(chipnum, ichan);
-		if ( TH1D * histo = dynamic_cast<TH1D*> (_rootObjectMap[tempHistoName]) )
+		if ( TH1D * histo = _chanDataHistos.get(chipnum, ichan) )
 			histo->Fill(datavec[ichan]);
 		
-		string tempHistoName1 = getSignalCorrectionName();
-		if ( TH1D * histo1 = dynamic_cast<TH1D*> (_rootObjectMap[tempHistoName1]) )
+		if ( histo1 )
 			histo1->Fill(datavec[ichan]);
 	}
 
@@ -302,6 +304,7 @@ void AlibavaCommonModeSubtraction::bookHistos(){
 	EVENT::IntVec chipVec = getChipSelection();
 	
 	// here are the histograms for each channel to show the corrected data
+	_chanDataHistos.reset(ALIBAVA::NOOFCHIPS, ALIBAVA::NOOFCHANNELS);
 	
 	for (unsigned int i=0; i<chipVec.size(); i++) {
 		int chipnum = chipVec[i];
@@ -317,6 +320,7 @@ void AlibavaCommonModeSubtraction::bookHistos(){
 			TH1D * chanDataHisto =
 			new TH1D (tempHistoName.c_str(),"",2000,-1000,1000);
 			_rootObjectMap.insert(make_pair(tempHistoName, chanDataHisto));
+			_chanDataHistos.set(chipnum, ichan, chanDataHisto);
 			string tmp_string = tempHistoTitle.str();
 			chanDataHisto->SetTitle(tmp_string.c_str());
 		}
@@ -0,0 +1,577 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// alibava includes ".h"
+#include "AlibavaFusedReconstruction.h"
+#include "AlibavaRunHeaderImpl.h"
+#include "AlibavaEventImpl.h"
+#include "ALIBAVA.h"
+
+
+// marlin includes ".h"
+#include "marlin/Processor.h"
+#include "marlin/Exceptions.h"
+#include "marlin/Global.h"
+
+#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+// aida includes <.h>
+#include <marlin/AIDAProcessor.h>
+#include <AIDA/ITree.h>
+#endif
+
+// lcio includes <.h>
+#include <lcio.h>
+#include <UTIL/CellIDEncoder.h>
+#include <IMPL/LCCollectionVec.h>
+#include <IMPL/TrackerDataImpl.h>
+
+
+// ROOT includes ".h"
+#include "TH1D.h"
+
+// system includes <>
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <cmath>
+#include <memory>
+
+using namespace std;
+using namespace lcio;
+using namespace marlin;
+using namespace alibava;
+
+
+AlibavaFusedReconstruction::AlibavaFusedReconstruction () :
+AlibavaBaseProcessor("AlibavaFusedReconstruction"),
+_recoDataCollectionName(""),
+_commonmodeCollectionName(""),
+_commonmodeerrorCollectionName(""),
+_correctedDataCollectionName(""),
+_clusterCollectionName("alibava_clusters"),
+_Niteration(3),
+_NoiseDeviation(2.5),
+_seedCut(3),
+_neighCut(2),
+_sensitiveAxisX(1),
+_signalPolarity(-1),
+_commonModeHistoName("hCommonMode"),
+_etaHistoName("hEta"),
+_clusterSizeHistoName("hClusterSize"),
+_chipHistos(),
+_isSensitiveAxisX(true)
+{
+
+	// modify processor description
+	_description =
+	"AlibavaFusedReconstruction subtracts the pedestal and the common mode of the raw data and finds clusters using seed and neighbour cuts, in a single pass over each chip";
+
+
+	// first of register the input /output collection
+	registerInputCollection (LCIO::TRACKERDATA, "InputCollectionName",
+									 "Input raw data collection name",
+									 _inputCollectionName, string("rawdata") );
+
+	registerOutputCollection (LCIO::TRACKERDATA, "ClusterCollectionName",
+									  "Output cluster collection name, leave empty to not write the clusters",
+									  _clusterCollectionName, string("alibava_clusters") );
+
+
+	registerProcessorParameter ("PedestalInputFile",
+										 "The filename where the pedestal and noise values stored",
+										 _pedestalFile , string("pedestal.slcio"));
+
+	registerProcessorParameter ("PedestalCollectionName",
+										 "Pedestal collection name, better not to change",
+										 _pedestalCollectionName, string ("pedestal"));
+
+	registerProcessorParameter ("NoiseCollectionName",
+										 "Noise collection name, better not to change",
+										 _noiseCollectionName, string ("noise"));
+
+	registerProcessorParameter ("SeedSNRCut",
+										 "The signal/noise ratio that channels have to pass to be considered as seed channel",
+										 _seedCut, float (3));
+
+	registerProcessorParameter ("NeighbourSNRCut",
+										 "The signal/noise ratio that neigbour channels have to pass to be added to the cluster",
+										 _neighCut, float (2));
+
+	registerProcessorParameter ("IsSensitiveAxisX",
+										 "The default sensitive axis of the strip sensor(s) according to telescope is X. If sensitive axis is Y then set this parameter to zero (0). Any other value will be disregarded and sensitive axis will assumed to be \"X\" ",
+										 _sensitiveAxisX, int(1));
+
+	registerProcessorParameter ("SignalPolarity",
+										 "Polarity of the signal. Set this parameter to -1 for negative signals, any other value will be disregarded and the signal will be assumed to be positive ",
+										 _signalPolarity, int (-1));
+
+	// now the optional parameters
+	registerOptionalParameter ("CommonModeCalculationIteration",
+										"The number of iteration that should be used in common mode calculation",
+										_Niteration, int(3) );
+
+	registerOptionalParameter ("NoiseDeviation",
+										"The limit to the deviation of noise. The data exceeds this deviation will be considered as signal and not be included in common mode calculation",
+										_NoiseDeviation, float(2.5) );
+
+	registerOptionalParameter ("RecoDataCollectionName",
+										"Pedestal subtracted data collection name, leave empty to not write it",
+										_recoDataCollectionName, string("") );
+
+	registerOptionalParameter ("CommonModeCollectionName",
+										"Common mode collection name, leave empty to not write it",
+										_commonmodeCollectionName, string("") );
+
+	registerOptionalParameter ("CommonModeErrorCollectionName",
+										"Common mode error collection name, leave empty to not write it",
+										_commonmodeerrorCollectionName, string("") );
+
+	registerOptionalParameter ("CorrectedDataCollectionName",
+										"Pedestal and common mode subtracted data collection name, leave empty to not write it",
+										_correctedDataCollectionName, string("") );
+
+}
+
+
+void AlibavaFusedReconstruction::init () {
+	streamlog_out ( MESSAGE4 ) << "Running init" << endl;
+
+	// this method is called only once even when the rewind is active
+
+	/* To set of channels to be used
+	 ex.The format should be like $ChipNumber:StartChannel-EndChannel$
+	 ex. $0:5-20$ $0:30-100$ $1:50-70$
+	 means from chip 0 channels between 5-20 and 30-100, from chip 1 channels between 50-70 will be used (all numbers included). the rest will be masked and not used
+	 Note that the numbers should be in ascending order and there should be no space between two $ character
+	 */
+	if (Global::parameters->isParameterSet(ALIBAVA::CHANNELSTOBEUSED))
+		Global::parameters->getStringVals(ALIBAVA::CHANNELSTOBEUSED,_channelsToBeUsed);
+	else {
+		streamlog_out ( MESSAGE4 ) << "The Global Parameter "<< ALIBAVA::CHANNELSTOBEUSED <<" is not set!" << endl;
+	}
+
+
+	/* To choose if processor should skip masked events
+	 ex. Set the value to 0 for false, to 1 for true
+	 */
+	if (Global::parameters->isParameterSet(ALIBAVA::SKIPMASKEDEVENTS))
+		_skipMaskedEvents = bool ( Global::parameters->getIntVal(ALIBAVA::SKIPMASKEDEVENTS) );
+	else {
+		streamlog_out ( MESSAGE4 ) << "The Global Parameter "<< ALIBAVA::SKIPMASKEDEVENTS <<" is not set! Masked events will be used!" << endl;
+	}
+
+	// check signal Polarity
+	if (_signalPolarity != -1)
+		_signalPolarity = 1;
+
+	// check sensitive axis
+	if (_sensitiveAxisX == 0)
+		_isSensitiveAxisX = false;
+	else
+		_isSensitiveAxisX = true;
+
+	if (_clusterCollectionName.empty() && _recoDataCollectionName.empty() && _commonmodeCollectionName.empty()
+		 && _commonmodeerrorCollectionName.empty() && _correctedDataCollectionName.empty())
+		streamlog_out ( WARNING5 ) << "No output collection name is set, only the histograms will be filled!" << endl;
+
+	// usually a good idea to
+	printParameters ();
+
+}
+
+void AlibavaFusedReconstruction::processRunHeader (LCRunHeader * rdr) {
+	streamlog_out ( MESSAGE4 ) << "Running processRunHeader" << endl;
+
+	// Add processor name to the runheader
+	auto_ptr<AlibavaRunHeaderImpl> arunHeader ( new AlibavaRunHeaderImpl(rdr)) ;
+	arunHeader->addProcessor(type());
+
+	// get and set selected chips
+	setChipSelection(arunHeader->getChipSelection());
+
+	// set channels to be used (if it is defined)
+	setChannelsToBeUsed();
+
+	// set pedestal and noise values
+	setPedestals();
+
+	// copy them, and the masks, in the per chip arrays used in processEvent
+	EVENT::IntVec chipSelection = getChipSelection();
+	for (unsigned int i=0; i<chipSelection.size(); i++) {
+		int chipnum = chipSelection[i];
+		if (!isChipValid(chipnum)) continue;
+
+		EVENT::FloatVec pedestalVec = getPedestalOfChip(chipnum);
+		EVENT::FloatVec noiseVec = getNoiseOfChip(chipnum);
+		if ( int(pedestalVec.size()) != ALIBAVA::NOOFCHANNELS || int(noiseVec.size()) != ALIBAVA::NOOFCHANNELS )
+			streamlog_out( ERROR5 ) << "Number of pedestal or noise values of chip "<< chipnum <<" is not equal to ALIBAVA::NOOFCHANNELS! "<< endl;
+
+		for (int ichan=0; ichan<ALIBAVA::NOOFCHANNELS; ichan++) {
+			_pedestal[chipnum][ichan] = ichan < int(pedestalVec.size()) ? pedestalVec[ichan] : 0;
+			_noise[chipnum][ichan] = ichan < int(noiseVec.size()) ? noiseVec[ichan] : 0;
+			_masked[chipnum][ichan] = isMasked(chipnum, ichan);
+		}
+	}
+
+	// if you want
+	bookHistos();
+
+	// set number of skipped events to zero (defined in AlibavaBaseProcessor)
+	_numberOfSkippedEvents = 0;
+
+}
+
+
+void AlibavaFusedReconstruction::processEvent (LCEvent * anEvent) {
+
+	AlibavaEventImpl * alibavaEvent = static_cast<AlibavaEventImpl*> (anEvent);
+
+	if (_skipMaskedEvents && (alibavaEvent->isEventMasked()) ) {
+		_numberOfSkippedEvents++;
+		return;
+	}
+
+	LCCollectionVec * inputColVec;
+	try
+	{
+		inputColVec = dynamic_cast< LCCollectionVec * > ( alibavaEvent->getCollection( getInputCollectionName() ) ) ;
+	} catch ( lcio::DataNotAvailableException ) {
+		// do nothing again
+		streamlog_out( ERROR5 ) << "Collection ("<<getInputCollectionName()<<") not found! " << endl;
+		return;
+	}
+
+	// only the requested collections are created
+	LCCollectionVec * recoColVec = _recoDataCollectionName.empty() ? NULL : new LCCollectionVec(LCIO::TRACKERDATA);
+	LCCollectionVec * commonColVec = _commonmodeCollectionName.empty() ? NULL : new LCCollectionVec(LCIO::TRACKERDATA);
+	LCCollectionVec * commerrColVec = _commonmodeerrorCollectionName.empty() ? NULL : new LCCollectionVec(LCIO::TRACKERDATA);
+	LCCollectionVec * correctedColVec = _correctedDataCollectionName.empty() ? NULL : new LCCollectionVec(LCIO::TRACKERDATA);
+	LCCollectionVec * clusterColVec = _clusterCollectionName.empty() ? NULL : new LCCollectionVec(LCIO::TRACKERDATA);
+
+	unsigned int noOfChip = inputColVec->getNumberOfElements();
+	for ( size_t i = 0; i < noOfChip; ++i ){
+
+		TrackerDataImpl * trkdata = dynamic_cast< TrackerDataImpl * > ( inputColVec->getElementAt( i ) ) ;
+		int chipnum = getChipNum(trkdata);
+		if (!isChipValid(chipnum)) {
+			streamlog_out( ERROR5 ) << "Chip "<< chipnum <<" is not in the chip selection, it is not reconstructed! " << endl;
+			continue;
+		}
+
+		// no copy of the charge values
+		const FloatVec & rawVec = trkdata->getChargeValues();
+		if ( int(rawVec.size()) != ALIBAVA::NOOFCHANNELS ) {
+			streamlog_out( ERROR5 ) << "Number of channels in input data is not equal to ALIBAVA::NOOFCHANNELS! Chip "<< chipnum <<" is not reconstructed! "<< endl;
+			continue;
+		}
+
+		reconstructChip(chipnum, rawVec, recoColVec, commonColVec, commerrColVec, correctedColVec, clusterColVec);
+	}
+
+	if (recoColVec) alibavaEvent->addCollection(recoColVec, _recoDataCollectionName);
+	if (commonColVec) alibavaEvent->addCollection(commonColVec, _commonmodeCollectionName);
+	if (commerrColVec) alibavaEvent->addCollection(commerrColVec, _commonmodeerrorCollectionName);
+	if (correctedColVec) alibavaEvent->addCollection(correctedColVec, _correctedDataCollectionName);
+	if (clusterColVec) alibavaEvent->addCollection(clusterColVec, _clusterCollectionName);
+
+}
+
+int AlibavaFusedReconstruction::reconstructChip(int chipnum, const EVENT::FloatVec & rawVec,
+																LCCollectionVec * recoColVec, LCCollectionVec * commonColVec,
+																LCCollectionVec * commerrColVec, LCCollectionVec * correctedColVec,
+																LCCollectionVec * clusterColVec){
+
+	const float * pedestal = _pedestal[chipnum];
+	const float * noise = _noise[chipnum];
+	const bool * masked = _masked[chipnum];
+
+	// pedestal subtraction, masked channels are set to zero
+	float recoSignal[ALIBAVA::NOOFCHANNELS];
+	for (int ichan=0; ichan<ALIBAVA::NOOFCHANNELS; ichan++)
+		recoSignal[ichan] = masked[ichan] ? 0 : rawVec[ichan] - pedestal[ichan];
+
+	// common mode
+	float commonmode = 0, commonmodeerror = 0;
+	calculateCommonMode(chipnum, recoSignal, commonmode, commonmodeerror);
+
+	if ( TH1D * histo = _chipHistos.get(chipnum, kCommonModeHisto) )
+		histo->Fill(commonmode);
+
+	// common mode subtraction, the signal to noise ratio and the channels
+	// that pass the neighbour cut, seed candidates are stored with their ratio
+	float signal[ALIBAVA::NOOFCHANNELS];
+	bool canBeUsed[ALIBAVA::NOOFCHANNELS];
+	int seedChan[ALIBAVA::NOOFCHANNELS];
+	float seedSNR[ALIBAVA::NOOFCHANNELS];
+	int noOfSeeds = 0;
+	for (int ichan=0; ichan<ALIBAVA::NOOFCHANNELS; ichan++) {
+		if (masked[ichan]) {
+			signal[ichan] = 0;
+			canBeUsed[ichan] = false;
+			continue;
+		}
+		signal[ichan] = recoSignal[ichan] - commonmode;
+
+		float snr = (_signalPolarity * signal[ichan])/noise[ichan];
+		canBeUsed[ichan] = !(snr < _neighCut);
+		if (canBeUsed[ichan] && snr > _seedCut) {
+			// insert keeping the candidates sorted by decreasing snr
+			int iseed = noOfSeeds;
+			while (iseed > 0 && seedSNR[iseed-1] < snr) {
+				seedChan[iseed] = seedChan[iseed-1];
+				seedSNR[iseed] = seedSNR[iseed-1];
+				iseed--;
+			}
+			seedChan[iseed] = ichan;
+			seedSNR[iseed] = snr;
+			noOfSeeds++;
+		}
+	}
+
+	addChipData(recoColVec, chipnum, recoSignal);
+	if (commonColVec || commerrColVec) {
+		float commonmodeVec[ALIBAVA::NOOFCHANNELS];
+		float commonmodeerrorVec[ALIBAVA::NOOFCHANNELS];
+		for (int ichan=0; ichan<ALIBAVA::NOOFCHANNELS; ichan++) {
+			commonmodeVec[ichan] = commonmode;
+			commonmodeerrorVec[ichan] = commonmodeerror;
+		}
+		addChipData(commonColVec, chipnum, commonmodeVec);
+		addChipData(commerrColVec, chipnum, commonmodeerrorVec);
+	}
+	addChipData(correctedColVec, chipnum, signal);
+
+	if (noOfSeeds == 0) return 0;
+
+	TH1D * hClusterSize = _chipHistos.get(chipnum, kClusterSizeHisto);
+	TH1D * hEta = _chipHistos.get(chipnum, kEtaHisto);
+
+	// the encoder is only needed if there is a seed
+	auto_ptr< CellIDEncoder<TrackerDataImpl> > clusterIDEncoder;
+	if (clusterColVec)
+		clusterIDEncoder.reset( new CellIDEncoder<TrackerDataImpl>(ALIBAVA::ALIBAVACLUSTER_ENCODE,clusterColVec) );
+
+	// now form clusters starting from the seed channel that has highest SNR
+	int clusterID = 0;
+	int noOfClusters = 0;
+	int members[ALIBAVA::NOOFCHANNELS];
+	for (int iseed=0; iseed<noOfSeeds; iseed++) {
+		// if this seed channel used in another cluster, skip it
+		int seed = seedChan[iseed];
+		if (!canBeUsed[seed]) continue;
+
+		// members are stored like AlibavaCluster::add does, seed first, then the
+		// channels on the left and then the ones on the right
+		int clusterSize = 0;
+		members[clusterSize++] = seed;
+		canBeUsed[seed] = false;
+
+		// a cluster next to a masked channel or to the edge of the chip is not used,
+		// its channels are still taken so that no other cluster uses them
+		bool thereIsNonBondedChan = false;
+
+		int ichan = seed-1;
+		for ( ; ichan >= 0 && !masked[ichan] && canBeUsed[ichan]; ichan--) {
+			members[clusterSize++] = ichan;
+			canBeUsed[ichan] = false;
+		}
+		if (ichan < 0 || masked[ichan]) thereIsNonBondedChan = true;
+
+		ichan = seed+1;
+		for ( ; ichan < ALIBAVA::NOOFCHANNELS && !masked[ichan] && canBeUsed[ichan]; ichan++) {
+			members[clusterSize++] = ichan;
+			canBeUsed[ichan] = false;
+		}
+		if (ichan >= ALIBAVA::NOOFCHANNELS || masked[ichan]) thereIsNonBondedChan = true;
+
+		int thisClusterID = clusterID;
+		clusterID++;
+		if (thereIsNonBondedChan) continue;
+
+		float eta = calculateEta(chipnum, signal, seed);
+		if (hEta) hEta->Fill(eta);
+		if (hClusterSize) hClusterSize->Fill(clusterSize);
+		noOfClusters++;
+
+		if (clusterColVec == NULL) continue;
+
+		// same content as AlibavaCluster::createTrackerData
+		TrackerDataImpl * alibavaCluster = new TrackerDataImpl();
+		FloatVec & dataToStore = alibavaCluster->chargeValues();
+		dataToStore.reserve(1 + 2*clusterSize);
+		dataToStore.push_back(eta);
+		for (int imember=0; imember<clusterSize; imember++) {
+			dataToStore.push_back( float(members[imember]) );
+			dataToStore.push_back( signal[members[imember]] );
+		}
+
+		CellIDEncoder<TrackerDataImpl> & encoder = *clusterIDEncoder;
+		encoder[ALIBAVA::ALIBAVACLUSTER_ENCODE_CLUSTERID] = thisClusterID;
+		encoder[ALIBAVA::ALIBAVACLUSTER_ENCODE_ISSENSITIVEAXISX] = _isSensitiveAxisX ? 1 : 0;
+		encoder[ALIBAVA::ALIBAVACLUSTER_ENCODE_ISSIGNALNEGATIVE] = (_signalPolarity == -1) ? 1 : 0;
+		encoder[ALIBAVA::ALIBAVACLUSTER_ENCODE_CHIPNUM] = chipnum;
+		encoder[ALIBAVA::ALIBAVACLUSTER_ENCODE_CLUSTERSIZE] = clusterSize;
+		encoder[ALIBAVA::ALIBAVACLUSTER_ENCODE_SEED] = seed;
+		encoder.setCellID(alibavaCluster);
+
+		clusterColVec->push_back(alibavaCluster);
+	}
+
+	return noOfClusters;
+}
+
+void AlibavaFusedReconstruction::calculateCommonMode(int chipnum, const float * recoSignal, float & commonmode, float & commonmodeerror){
+
+	const bool * masked = _masked[chipnum];
+
+	double sig=0, tmpdouble=0;
+	double mean_signal=0;
+	double sigma_mean_signal=0;
+
+	for (int i=0; i<_Niteration; i++) {
+		int nchan=0;
+		double total_signal=0;
+		double total_signal_square=0;
+
+		for ( int ichan=0; ichan<ALIBAVA::NOOFCHANNELS; ichan++ ){
+			if (masked[ichan]) continue;
+
+			sig = recoSignal[ichan];
+
+			// First iteration: take everything, then exclude outliers
+			if (i>0) {
+				tmpdouble = fabs((sig - mean_signal)/sigma_mean_signal);
+				if (!(tmpdouble<_NoiseDeviation)) continue;
+			}
+			total_signal += sig;
+			total_signal_square += sig*sig;
+			nchan++;
+		}
+		// standard deviation = SQRT( E[x^2] - E[x]^2 )
+		if (nchan>0) {
+			mean_signal=total_signal/nchan;
+			sigma_mean_signal=sqrt(total_signal_square/nchan - mean_signal*mean_signal);
+		}
+	}
+
+	streamlog_out( DEBUG0 ) << "Chip " << chipnum << " : CommonModeCorrection = " << mean_signal << ", CommonModeCorrectionError = " << sigma_mean_signal << endl;
+
+	// stored as float, like in the common mode collection
+	commonmode = mean_signal;
+	commonmodeerror = sigma_mean_signal;
+}
+
+float AlibavaFusedReconstruction::calculateEta(int chipnum, const float * signal, int seedChan){
+
+	const bool * masked = _masked[chipnum];
+
+	// we will multiply all signal values by _signalPolarity to work on positive signal always
+	float seedSignal = _signalPolarity * signal[seedChan];
+
+	// now we make an unrealistic signal
+	float unrealisticSignal = -10000; // you cannot get this signal from alibava
+
+	int leftChan = seedChan - 1;
+	float leftSignal = unrealisticSignal;
+	if ( leftChan >= 0 && !masked[leftChan] )
+		leftSignal = _signalPolarity * signal[leftChan];
+
+	int rightChan = seedChan + 1;
+	float rightSignal = unrealisticSignal;
+	if ( rightChan < ALIBAVA::NOOFCHANNELS && !masked[rightChan] )
+		rightSignal = _signalPolarity * signal[rightChan];
+
+	// if both right and left channel is masked. Simply return -1
+	if (rightSignal == unrealisticSignal && leftSignal == unrealisticSignal ) {
+		streamlog_out (DEBUG1) << "Both neighbours are masked!"<<endl;
+		return -1;
+	}
+
+	// Eta calculation: chargeOnLeftChannel / (chargeOnLeftChannel + chargeOnRightChannel)
+	if ( leftSignal > rightSignal)
+		return leftSignal / ( leftSignal + seedSignal );
+	else
+		return seedSignal / (seedSignal + rightSignal);
+}
+
+void AlibavaFusedReconstruction::addChipData(LCCollectionVec * colVec, int chipnum, const float * values){
+	if (colVec == NULL) return;
+
+	TrackerDataImpl * dataImpl = new TrackerDataImpl();
+	dataImpl->chargeValues().assign(values, values + ALIBAVA::NOOFCHANNELS);
+
+	CellIDEncoder<TrackerDataImpl> chipIDEncoder(ALIBAVA::ALIBAVADATA_ENCODE,colVec);
+	chipIDEncoder[ALIBAVA::ALIBAVADATA_ENCODE_CHIPNUM] = chipnum;
+	chipIDEncoder.setCellID(dataImpl);
+
+	colVec->push_back(dataImpl);
+}
+
+
+void AlibavaFusedReconstruction::check (LCEvent * /* evt */ ) {
+	// nothing to check here - could be used to fill check plots in reconstruction processor
+}
+
+
+void AlibavaFusedReconstruction::end() {
+
+	if (_numberOfSkippedEvents > 0)
+		streamlog_out ( MESSAGE5 ) << _numberOfSkippedEvents<<" events skipped since they are masked" << endl;
+	streamlog_out ( MESSAGE4 ) << "Successfully finished" << endl;
+
+}
+
+void AlibavaFusedReconstruction::bookHistos(){
+
+	AIDAProcessor::tree(this)->cd(this->name());
+
+	_chipHistos.reset(ALIBAVA::NOOFCHIPS, kNumberOfChipHistos);
+
+	EVENT::IntVec chipSelection = getChipSelection();
+	string histoName;
+	string title;
+	for ( unsigned int i=0; i<chipSelection.size(); i++) {
+		int ichip=chipSelection[i];
+		stringstream chipString;
+		chipString << ichip;
+
+		// Common mode histogram
+		histoName = getHistoNameForChip(_commonModeHistoName,ichip);
+		TH1D * hCommonMode = new TH1D (histoName.c_str(),"",1000, -500, 500);
+		title = string("Common Mode (chip ") +chipString.str()+string(");ADCs;Number of Entries");
+		hCommonMode->SetTitle(title.c_str());
+		_rootObjectMap.insert(make_pair(histoName, hCommonMode));
+		_chipHistos.set(ichip, kCommonModeHisto, hCommonMode);
+
+		// Clustersize histogram
+		histoName = getHistoNameForChip(_clusterSizeHistoName,ichip);
+		TH1D * hClusterSize = new TH1D (histoName.c_str(),"",10, 0, 10);
+		title = string("Cluster Size (chip ") +chipString.str()+string(");Number of Entries;Cluster Size");
+		hClusterSize->SetTitle(title.c_str());
+		_rootObjectMap.insert(make_pair(histoName, hClusterSize));
+		_chipHistos.set(ichip, kClusterSizeHisto, hClusterSize);
+
+		// Eta histogram ClusterSize > 1
+		histoName = getHistoNameForChip(_etaHistoName,ichip);
+		TH1D * hEta = new TH1D (histoName.c_str(),"",100, -0.1, 1.1);
+		title = string("Eta distribution ClusterSize > 1 (chip ") +chipString.str()+string(");Number of Entries;Eta");
+		hEta->SetTitle(title.c_str());
+		_rootObjectMap.insert(make_pair(histoName, hEta));
+		_chipHistos.set(ichip, kEtaHisto, hEta);
+
+	} // end of loop over selected chips
+
+	streamlog_out ( MESSAGE1 )  << "End of Booking histograms. " << endl;
+}
+
+string AlibavaFusedReconstruction::getHistoNameForChip(string histoName, int ichip){
+	stringstream s;
+	s<< histoName <<"_chip" << ichip;
+	return s.str();
+}
@@ -41,6 +41,7 @@
 #include "TSystem.h"
 
 // system includes <>
+#include <cmath>
 #include <string>
 #include <iostream>
 #include <sstream>
@@ -59,7 +60,13 @@ _pedestalHistoName ("hpedestal"),
 _noiseHistoName ("hnoise"),
 _temperatureHistoName("htemperature"),
 _chanDataHistoName ("Data_chan"),
-_chanDataFitName ("Fit_chan")
+_chanDataFitName ("Fit_chan"),
+_chanDataHistos(),
+_useStreamingStatistics(false),
+_clippingSigma(3.0),
+_clippingStartEvents(100),
+_validateWithFit(false),
+_chanStatistics()
 {
 	
 	// modify processor description
@@ -85,6 +92,22 @@ _chanDataFitName ("Fit_chan")
 										"Noise collection name, better not to change",
 										_noiseCollectionName, string ("noise"));
 
+	registerOptionalParameter ("UseStreamingStatistics",
+										"If true, pedestal and noise are the clipped running mean and sigma of each channel instead of the result of a Gaussian fit to its histogram",
+										_useStreamingStatistics, bool (false));
+
+	registerOptionalParameter ("ClippingSigma",
+										"In the streaming mode, values further than this number of noise from the pedestal are not used",
+										_clippingSigma, float (3.0));
+
+	registerOptionalParameter ("ClippingStartEvents",
+										"In the streaming mode, the number of events which are clipped iteratively to start the clipping",
+										_clippingStartEvents, int (100));
+
+	registerOptionalParameter ("ValidateWithFit",
+										"In the streaming mode, also fill and fit the channel histograms and report channels where the results differ",
+										_validateWithFit, bool (false));
+
 }
 
 
@@ -189,6 +212,7 @@ void AlibavaPedestalNoiseProcessor::end() {
 void AlibavaPedestalNoiseProcessor::calculatePedestalNoise(){
 	string tempHistoName,tempFitName;
 	TCanvas *cc = new TCanvas("cc","cc",800,600);
+	int noOfDisagreeingChannels = 0;
 	
 	EVENT::IntVec chipSelection = getChipSelection();
 	for (unsigned int i=0; i<chipSelection.size(); i++) {
@@ -205,6 +229,25 @@ void AlibavaPedestalNoiseProcessor::calculatePedestalNoise(){
 			if (isMasked(ichip,ichan)){
 				ped=0; noi=0;
 			}
+			else if (_useStreamingStatistics) {
+				AlibavaClippedStatistics & stat = _chanStatistics[ichip*ALIBAVA::NOOFCHANNELS+ichan];
+				stat.finish();
+				ped = stat.getMean();
+				noi = stat.getSigma();
+				if (_validateWithFit) {
+					TH1D * histo = _chanDataHistos.get(ichip, ichan);
+					TF1 * tempfit = dynamic_cast<TF1*> (_rootObjectMap[getChanDataFitName(ichip, ichan)]);
+					histo->Fit(tempfit,"Q");
+					// the fit and the clipped statistics should agree to a small fraction of the noise
+					if (fabs(tempfit->GetParameter(1) - ped) > 0.1 * noi || fabs(tempfit->GetParameter(2) - noi) > 0.1 * noi) {
+						noOfDisagreeingChannels++;
+						streamlog_out ( DEBUG5 ) << "Chip "<<ichip<<" channel "<<ichan<<": pedestal "<<ped<<" noise "<<noi
+						<<", fit gives pedestal "<<tempfit->GetParameter(1)<<" noise "<<tempfit->GetParameter(2) << endl;
+					}
+				}
+				hped->SetBinContent(ichan+1,ped);
+				hnoi->SetBinContent(ichan+1,noi);
+			}
 			else {
 				tempFitName = getChanDataFitName(ichip, ichan);
 				tempHistoName = getChanDataHistoName(ichip, ichan);
@@ -224,6 +267,8 @@ void AlibavaPedestalNoiseProcessor::calculatePedestalNoise(){
 		man.addToFile(_pedestalFile,_pedestalCollectionName, ichip, pedestalVec);
 		man.addToFile(_pedestalFile,_noiseCollectionName, ichip, noiseVec);
 	}
+	if (noOfDisagreeingChannels > 0)
+		streamlog_out ( WARNING5 ) << noOfDisagreeingChannels << " channels have a pedestal or noise from the running statistics which differs from the Gaussian fit by more than 10% of the noise" << endl;
 	delete cc;
 }
 
@@ -251,16 +296,21 @@ string AlibavaPedestalNoiseProcessor::getNoiseHistoName(unsigned int ichip){
 
 void AlibavaPedestalNoiseProcessor::fillHistos(TrackerDataImpl * trkdata){
 	
-	FloatVec datavec;
-	datavec = trkdata->getChargeValues();
+	const FloatVec & datavec = trkdata->getChargeValues();
 	
 	int chipnum = getChipNum(trkdata);
 	
+	if (_useStreamingStatistics && chipnum >= 0 && chipnum < ALIBAVA::NOOFCHIPS) {
+		for (size_t ichan=0; ichan<datavec.size() && ichan<size_t(ALIBAVA::NOOFCHANNELS);ichan++) {
+			if (isMasked(chipnum,ichan)) continue;
+			_chanStatistics[chipnum*ALIBAVA::NOOFCHANNELS+ichan].add(datavec[ichan]);
+		}
+	}
+
+	// masked channels have no histogram in the table,
+	// in the streaming mode there are none without the validation
 	for (size_t ichan=0; ichan<datavec.size();ichan++) {
-		if(isMasked(chipnum, ichan)) continue;
-		
-		string tempHistoName = getChanDataHistoName(chipnum, ichan);
-		if ( TH1D * histo = dynamic_cast<TH1D*> (_rootObjectMap[tempHistoName]) )
+		if ( TH1D * histo = _chanDataHistos.get(chipnum, ichan) )
 			histo->Fill(datavec[ichan]);
 	}
 
@@ -302,9 +352,17 @@ void AlibavaPedestalNoiseProcessor::bookHistos(){
 	AIDAProcessor::tree(this)->mkdir(getInputCollectionName().c_str());
 	AIDAProcessor::tree(this)->cd(getInputCollectionName().c_str());
 		
+	// the running statistics of the streaming mode
+	_chanStatistics.assign(ALIBAVA::NOOFCHIPS*ALIBAVA::NOOFCHANNELS, AlibavaClippedStatistics());
+	for (size_t i=0; i<_chanStatistics.size(); i++)
+		_chanStatistics[i].setClipping(_clippingSigma, _clippingStartEvents > 1 ? _clippingStartEvents : 2);
+
 	// here are the histograms used to calculate pedestal and noise for each channel
 	string tempHistoName,tempFitName;
-	for (unsigned int i=0; i<chipSelection.size(); i++) {
+	_chanDataHistos.reset(ALIBAVA::NOOFCHIPS, ALIBAVA::NOOFCHANNELS);
+	// in the streaming mode the channel histograms are only needed for the validation
+	const bool bookChannelHistos = !_useStreamingStatistics || _validateWithFit;
+	for (unsigned int i=0; bookChannelHistos && i<chipSelection.size(); i++) {
 		unsigned int ichip=chipSelection[i];
 
 		for ( int ichan=0; ichan<ALIBAVA::NOOFCHANNELS; ichan++) {
@@ -319,6 +377,7 @@ void AlibavaPedestalNoiseProcessor::bookHistos(){
 			TH1D * chanDataHisto =
 			new TH1D (tempHistoName.c_str(),"",1000,0,1000);
 			_rootObjectMap.insert(make_pair(tempHistoName, chanDataHisto));
+			_chanDataHistos.set(ichip, ichan, chanDataHisto);
 			string tmp_string = tempHistoTitle.str();
 			chanDataHisto->SetTitle(tmp_string.c_str());
 			